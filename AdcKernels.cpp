@@ -0,0 +1,301 @@
+#include "AdcKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RADAR_HAVE_SSE2 1
+#endif
+
+#ifdef RADAR_HAVE_SSE2
+namespace {
+
+// Multiply four real samples by scale * window and store them as
+// four complex values with zero imaginary part
+inline void storeReal4(float* out, __m128 values, __m128 gain, const float* window)
+{
+    if (window) {
+        gain = _mm_mul_ps(gain, _mm_loadu_ps(window));
+    }
+    values = _mm_mul_ps(values, gain);
+    const __m128 zero = _mm_setzero_ps();
+    _mm_storeu_ps(out,     _mm_unpacklo_ps(values, zero));
+    _mm_storeu_ps(out + 4, _mm_unpackhi_ps(values, zero));
+}
+
+// Multiply two I/Q pairs by scale * window (one coefficient per pair) and store
+inline void storeComplex2(float* out, __m128 iq, __m128 gain, const float* window)
+{
+    if (window) {
+        __m128 w = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(window)));
+        gain = _mm_mul_ps(gain, _mm_unpacklo_ps(w, w));
+    }
+    _mm_storeu_ps(out, _mm_mul_ps(iq, gain));
+}
+
+// Sign-extend the four low / high int16 lanes to float
+inline __m128 int16LoToFloat(__m128i v)
+{
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline __m128 int16HiToFloat(__m128i v)
+{
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+inline __m128i loadu128(const void* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+} // namespace
+#endif
+
+float adcScaleForResolution(uint8_t adcResolution)
+{
+    if (adcResolution == 0 || adcResolution > 16) {
+        adcResolution = 16;
+    }
+    return 1.0f / static_cast<float>(1u << (adcResolution - 1));
+}
+
+void makeHannWindow(std::vector<float>& window, size_t n)
+{
+    window.resize(n);
+    if (n == 1) {
+        window[0] = 1.0f;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        window[i] = 0.5f - 0.5f * std::cos(2.0f * float(M_PI) * i / (n - 1));
+    }
+}
+
+// The strided SIMD loops below load whole groups of samples, including the
+// other channels that sit between them. They stop one group early so those
+// loads never run past the last sample of the requested channel.
+
+void packRealInt16(const int16_t* src, size_t count, size_t stride, float scale,
+                   const float* window, std::complex<float>* dst, size_t dstSize)
+{
+    count = std::min(count, dstSize);
+    size_t i = 0;
+
+#ifdef RADAR_HAVE_SSE2
+    float* out = reinterpret_cast<float*>(dst);
+    const __m128 vscale = _mm_set1_ps(scale);
+    if (stride == 1) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i raw = loadu128(src + i);
+            storeReal4(out + 2 * i,     int16LoToFloat(raw), vscale, window ? window + i : nullptr);
+            storeReal4(out + 2 * i + 8, int16HiToFloat(raw), vscale, window ? window + i + 4 : nullptr);
+        }
+    } else if (stride == 2) {
+        // Even int16 lanes belong to this channel: shift left/right to sign-extend them
+        for (; i + 4 < count; i += 4) {
+            __m128i raw = loadu128(src + 2 * i);
+            __m128 values = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(raw, 16), 16));
+            storeReal4(out + 2 * i, values, vscale, window ? window + i : nullptr);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float gain = window ? scale * window[i] : scale;
+        dst[i] = std::complex<float>(src[i * stride] * gain, 0.0f);
+    }
+    std::fill(dst + count, dst + dstSize, std::complex<float>(0.0f, 0.0f));
+}
+
+void packRealFloat(const float* src, size_t count, size_t stride,
+                   const float* window, std::complex<float>* dst, size_t dstSize)
+{
+    count = std::min(count, dstSize);
+    size_t i = 0;
+
+#ifdef RADAR_HAVE_SSE2
+    float* out = reinterpret_cast<float*>(dst);
+    const __m128 one = _mm_set1_ps(1.0f);
+    if (stride == 1) {
+        for (; i + 4 <= count; i += 4) {
+            storeReal4(out + 2 * i, _mm_loadu_ps(src + i), one, window ? window + i : nullptr);
+        }
+    } else if (stride == 2) {
+        for (; i + 4 < count; i += 4) {
+            __m128 a = _mm_loadu_ps(src + 2 * i);
+            __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+            storeReal4(out + 2 * i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), one,
+                       window ? window + i : nullptr);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float value = window ? src[i * stride] * window[i] : src[i * stride];
+        dst[i] = std::complex<float>(value, 0.0f);
+    }
+    std::fill(dst + count, dst + dstSize, std::complex<float>(0.0f, 0.0f));
+}
+
+void packComplexInt16(const int16_t* iq, size_t count, size_t stride, float scale,
+                      const float* window, std::complex<float>* dst, size_t dstSize)
+{
+    count = std::min(count, dstSize);
+    size_t i = 0;
+
+#ifdef RADAR_HAVE_SSE2
+    float* out = reinterpret_cast<float*>(dst);
+    const __m128 vscale = _mm_set1_ps(scale);
+    if (stride == 1) {
+        for (; i + 4 <= count; i += 4) {
+            __m128i raw = loadu128(iq + 2 * i);
+            storeComplex2(out + 2 * i,     int16LoToFloat(raw), vscale, window ? window + i : nullptr);
+            storeComplex2(out + 2 * i + 4, int16HiToFloat(raw), vscale, window ? window + i + 2 : nullptr);
+        }
+    } else if (stride == 2) {
+        // Each 32-bit lane holds one I/Q pair; keep lanes 0 and 2 of two loads
+        for (; i + 4 < count; i += 4) {
+            __m128 a = _mm_castsi128_ps(loadu128(iq + 4 * i));
+            __m128 b = _mm_castsi128_ps(loadu128(iq + 4 * i + 8));
+            __m128i pairs = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            storeComplex2(out + 2 * i,     int16LoToFloat(pairs), vscale, window ? window + i : nullptr);
+            storeComplex2(out + 2 * i + 4, int16HiToFloat(pairs), vscale, window ? window + i + 2 : nullptr);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float gain = window ? scale * window[i] : scale;
+        const int16_t* sample = iq + 2 * i * stride;
+        dst[i] = std::complex<float>(sample[0] * gain, sample[1] * gain);
+    }
+    std::fill(dst + count, dst + dstSize, std::complex<float>(0.0f, 0.0f));
+}
+
+void packComplexFloat(const float* iq, size_t count, size_t stride,
+                      const float* window, std::complex<float>* dst, size_t dstSize)
+{
+    count = std::min(count, dstSize);
+    size_t i = 0;
+
+#ifdef RADAR_HAVE_SSE2
+    float* out = reinterpret_cast<float*>(dst);
+    const __m128 one = _mm_set1_ps(1.0f);
+    if (stride == 1) {
+        for (; i + 2 <= count; i += 2) {
+            storeComplex2(out + 2 * i, _mm_loadu_ps(iq + 2 * i), one, window ? window + i : nullptr);
+        }
+    } else if (stride == 2) {
+        // Keep the first I/Q pair of each (this channel, other channel) group
+        for (; i + 2 < count; i += 2) {
+            __m128 a = _mm_loadu_ps(iq + 4 * i);
+            __m128 b = _mm_loadu_ps(iq + 4 * i + 4);
+            storeComplex2(out + 2 * i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 1, 0)), one,
+                          window ? window + i : nullptr);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float gain = window ? window[i] : 1.0f;
+        const float* sample = iq + 2 * i * stride;
+        dst[i] = std::complex<float>(sample[0] * gain, sample[1] * gain);
+    }
+    std::fill(dst + count, dst + dstSize, std::complex<float>(0.0f, 0.0f));
+}
+
+int firstEnabledChannel(const RawADCFrame& frame)
+{
+    for (int channel = 0; channel < frame.num_rx_antennas && channel < 8; ++channel) {
+        if (frame.rx_mask & (1u << channel)) {
+            return channel;
+        }
+    }
+    return -1;
+}
+
+ADCChannelView adcChannelView(const RawADCFrame& frame, uint32_t chirp, uint32_t channel)
+{
+    const size_t valuesPerSample = isComplexFormat(frame.data_format) ? 2 : 1;
+    const size_t available = frame.valueCount() / valuesPerSample;
+    const size_t numRx = std::max<size_t>(1, frame.num_rx_antennas);
+    const size_t samplesPerChirp = frame.num_samples_per_chirp;
+    const size_t chirpBase = size_t(chirp) * numRx * samplesPerChirp;
+
+    ADCChannelView view;
+    if (frame.interleaved_rx) {
+        view.offset = chirpBase + channel;
+        view.stride = numRx;
+    } else {
+        view.offset = chirpBase + size_t(channel) * samplesPerChirp;
+        view.stride = 1;
+    }
+
+    if (view.offset >= available) {
+        view.count = 0;
+    } else {
+        view.count = std::min(samplesPerChirp, (available - view.offset - 1) / view.stride + 1);
+    }
+    return view;
+}
+
+size_t adcChirpsPresent(const RawADCFrame& frame)
+{
+    const size_t valuesPerSample = isComplexFormat(frame.data_format) ? 2 : 1;
+    const size_t samplesPerChirp = std::max<size_t>(1, frame.num_rx_antennas) * frame.num_samples_per_chirp;
+    if (samplesPerChirp == 0) {
+        return 0;
+    }
+    const size_t available = frame.valueCount() / valuesPerSample;
+    return std::min<size_t>(std::max<uint32_t>(1, frame.num_chirps), available / samplesPerChirp);
+}
+
+void packChannel(const RawADCFrame& frame, const ADCChannelView& view,
+                 const float* window, std::complex<float>* dst, size_t dstSize)
+{
+    const float scale = adcScaleForResolution(frame.adc_resolution);
+    switch (frame.data_format) {
+    case Rx_Data_Format_t::REAL_INT16:
+        packRealInt16(frame.sample_data_i16.data() + view.offset, view.count, view.stride,
+                      scale, window, dst, dstSize);
+        break;
+    case Rx_Data_Format_t::REAL_FLOAT:
+        packRealFloat(frame.sample_data.data() + view.offset, view.count, view.stride,
+                      window, dst, dstSize);
+        break;
+    case Rx_Data_Format_t::COMPLEX_INT16:
+        packComplexInt16(frame.sample_data_i16.data() + 2 * view.offset, view.count, view.stride,
+                         scale, window, dst, dstSize);
+        break;
+    case Rx_Data_Format_t::COMPLEX_FLOAT:
+        packComplexFloat(frame.sample_data.data() + 2 * view.offset, view.count, view.stride,
+                         window, dst, dstSize);
+        break;
+    }
+}
+
+bool copyInt16Payload(const char* payload, size_t size, std::vector<int16_t>& out)
+{
+    if (size % sizeof(int16_t) != 0) {
+        return false;
+    }
+    out.resize(size / sizeof(int16_t));
+    if (size > 0) {
+        std::memcpy(out.data(), payload, size);
+    }
+    return true;
+}
+
+bool copyFloatPayload(const char* payload, size_t size, std::vector<float>& out)
+{
+    if (size % sizeof(float) != 0) {
+        return false;
+    }
+    out.resize(size / sizeof(float));
+    if (size > 0) {
+        std::memcpy(out.data(), payload, size);
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DataStructures.h"
+
+// Scale factor mapping a signed ADC code of the given resolution to [-1, 1)
+float adcScaleForResolution(uint8_t adcResolution);
+
+// Hann window coefficients of length n
+void makeHannWindow(std::vector<float>& window, size_t n);
+
+// Fused int16 -> float scale + window + FFT-input packing kernels.
+// `src` may point straight into a receive buffer (no alignment required).
+// `count` samples are read `stride` samples apart (stride > 1 selects one
+// channel out of RX-interleaved data) and written contiguously to `dst`,
+// which is then zero-padded up to `dstSize`. `window` may be null for a
+// rectangular window. Complex variants read I/Q pairs.
+void packRealInt16(const int16_t* src, size_t count, size_t stride, float scale,
+                   const float* window, std::complex<float>* dst, size_t dstSize);
+void packRealFloat(const float* src, size_t count, size_t stride,
+                   const float* window, std::complex<float>* dst, size_t dstSize);
+void packComplexInt16(const int16_t* iq, size_t count, size_t stride, float scale,
+                      const float* window, std::complex<float>* dst, size_t dstSize);
+void packComplexFloat(const float* iq, size_t count, size_t stride,
+                      const float* window, std::complex<float>* dst, size_t dstSize);
+
+// Location of one chirp of one RX channel inside RawADCFrame storage,
+// in samples (an I/Q pair counts as one sample for complex formats)
+struct ADCChannelView {
+    size_t offset;
+    size_t stride;
+    size_t count;
+};
+
+// Lowest RX channel enabled in rx_mask, or -1 if none is present
+int firstEnabledChannel(const RawADCFrame& frame);
+
+// Resolve a chirp/channel to its samples. Layout is [chirp][rx][sample]
+// when interleaved_rx is 0 and [chirp][sample][rx] otherwise. `count` is
+// clamped to the samples actually present in the frame.
+ADCChannelView adcChannelView(const RawADCFrame& frame, uint32_t chirp, uint32_t channel);
+
+// Chirps (at least 1 declared) whose samples for every RX channel are all
+// present in the frame's storage; trailing partial chirps are not counted
+size_t adcChirpsPresent(const RawADCFrame& frame);
+
+// Pack one channel view of a frame into FFT input, dispatching on data_format
+void packChannel(const RawADCFrame& frame, const ADCChannelView& view,
+                 const float* window, std::complex<float>* dst, size_t dstSize);
+
+// Copy a little-endian int16 payload into `out` without widening it.
+// Returns false if the payload size is not a whole number of samples.
+bool copyInt16Payload(const char* payload, size_t size, std::vector<int16_t>& out);
+
+// Copy a little-endian float payload into `out`
+bool copyFloatPayload(const char* payload, size_t size, std::vector<float>& out);
@@ -0,0 +1,80 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef RADAR_COUNT_ALLOCATIONS
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+thread_local uint64_t t_allocations = 0;
+
+void count()
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    ++t_allocations;
+}
+
+void* countedAllocate(std::size_t size)
+{
+    count();
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    count();
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align;
+#ifdef _WIN32
+    void* p = _aligned_malloc(rounded ? rounded : align, align);
+#else
+    void* p = std::aligned_alloc(align, rounded ? rounded : align);
+#endif
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void countedFreeAligned(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFreeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFreeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFreeAligned(p); }
+
+namespace AllocationCounter {
+bool enabled() { return true; }
+uint64_t allocationCount() { return g_allocations.load(std::memory_order_relaxed); }
+uint64_t threadAllocationCount() { return t_allocations; }
+}
+
+#else
+
+namespace AllocationCounter {
+bool enabled() { return false; }
+uint64_t allocationCount() { return 0; }
+uint64_t threadAllocationCount() { return 0; }
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Test hook counting heap allocations made through global operator new.
+// Counting is only active when AllocationCounter.cpp is linked into the
+// target with RADAR_COUNT_ALLOCATIONS defined (see the CMake option of the
+// same name; radar_bench and radar_cli always define it); otherwise both
+// counts always return 0.
+namespace AllocationCounter {
+
+bool enabled();
+// All threads
+uint64_t allocationCount();
+// The calling thread only
+uint64_t threadAllocationCount();
+
+// Allocations performed by any thread since construction
+class Scope
+{
+public:
+    Scope() : m_start(allocationCount()) {}
+    uint64_t allocations() const { return allocationCount() - m_start; }
+
+private:
+    uint64_t m_start;
+};
+
+// Allocations performed by the constructing thread since construction;
+// not affected by other threads working at the same time
+class ThreadScope
+{
+public:
+    ThreadScope() : m_start(threadAllocationCount()) {}
+    uint64_t allocations() const { return threadAllocationCount() - m_start; }
+
+private:
+    uint64_t m_start;
+};
+
+} // namespace AllocationCounter
@@ -0,0 +1,89 @@
+#include "BinaryProtocol.h"
+#include "AdcKernels.h"
+#include <cstring>
+
+bool parseBinaryADCMessage(const char* data, size_t size, RawADCFrame& frame)
+{
+    const size_t headerSize = sizeof(MessageHeader) + sizeof(ADCFrameHeader);
+    if (size < headerSize) {
+        return false;
+    }
+
+    MessageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.type != MessageType::RAW_ADC_DATA ||
+        header.data_size != size - sizeof(MessageHeader)) {
+        return false;
+    }
+
+    ADCFrameHeader adcHeader;
+    std::memcpy(&adcHeader, data + sizeof(MessageHeader), sizeof(adcHeader));
+    if (adcHeader.data_format > static_cast<uint8_t>(Rx_Data_Format_t::REAL_INT16)) {
+        return false;
+    }
+    if (adcHeader.num_chirps == 0 || adcHeader.num_chirps > MAX_ADC_CHIRPS ||
+        adcHeader.num_rx_antennas == 0 ||
+        adcHeader.num_samples_per_chirp == 0 || adcHeader.num_samples_per_chirp > MAX_ADC_SAMPLES_PER_CHIRP) {
+        return false;
+    }
+
+    frame.frame_number = adcHeader.frame_number;
+    frame.num_chirps = adcHeader.num_chirps;
+    frame.num_rx_antennas = adcHeader.num_rx_antennas;
+    frame.num_samples_per_chirp = adcHeader.num_samples_per_chirp;
+    frame.rx_mask = adcHeader.rx_mask;
+    frame.adc_resolution = adcHeader.adc_resolution;
+    frame.interleaved_rx = adcHeader.interleaved_rx;
+    frame.data_format = static_cast<Rx_Data_Format_t>(adcHeader.data_format);
+    frame.timestamp_us = header.timestamp;
+
+    // int16 samples are kept as int16; they are widened only inside the FFT packing kernel
+    const char* payload = data + headerSize;
+    const size_t payloadSize = size - headerSize;
+    // Consumers size their buffers from the dimensions, so they must match the payload
+    const Rx_Data_Format_t format = frame.data_format;
+    const uint64_t values = uint64_t(frame.num_chirps) * frame.num_rx_antennas *
+                            frame.num_samples_per_chirp * (isComplexFormat(format) ? 2 : 1);
+    if (values * (isInt16Format(format) ? sizeof(int16_t) : sizeof(float)) != payloadSize) {
+        return false;
+    }
+    if (isInt16Format(frame.data_format)) {
+        frame.sample_data.clear();
+        return copyInt16Payload(payload, payloadSize, frame.sample_data_i16);
+    }
+    frame.sample_data_i16.clear();
+    return copyFloatPayload(payload, payloadSize, frame.sample_data);
+}
+
+void encodeBinaryADCMessage(const RawADCFrame& frame, std::vector<char>& out)
+{
+    const bool int16 = isInt16Format(frame.data_format);
+    const size_t payloadSize = int16 ? frame.sample_data_i16.size() * sizeof(int16_t)
+                                     : frame.sample_data.size() * sizeof(float);
+
+    MessageHeader header;
+    header.type = MessageType::RAW_ADC_DATA;
+    header.data_size = static_cast<uint32_t>(sizeof(ADCFrameHeader) + payloadSize);
+    header.timestamp = frame.timestamp_us;
+
+    ADCFrameHeader adcHeader;
+    adcHeader.frame_number = frame.frame_number;
+    adcHeader.num_chirps = frame.num_chirps;
+    adcHeader.num_rx_antennas = frame.num_rx_antennas;
+    adcHeader.num_samples_per_chirp = frame.num_samples_per_chirp;
+    adcHeader.rx_mask = frame.rx_mask;
+    adcHeader.adc_resolution = frame.adc_resolution;
+    adcHeader.interleaved_rx = frame.interleaved_rx;
+    adcHeader.data_format = static_cast<uint8_t>(frame.data_format);
+
+    // Host byte order is little-endian on every supported target
+    out.resize(sizeof(header) + sizeof(adcHeader) + payloadSize);
+    char* dst = out.data();
+    std::memcpy(dst, &header, sizeof(header));
+    std::memcpy(dst + sizeof(header), &adcHeader, sizeof(adcHeader));
+    if (payloadSize > 0) {
+        const void* samples = int16 ? static_cast<const void*>(frame.sample_data_i16.data())
+                                    : static_cast<const void*>(frame.sample_data.data());
+        std::memcpy(dst + sizeof(header) + sizeof(adcHeader), samples, payloadSize);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DataStructures.h"
+
+// Binary RAW_ADC_DATA datagrams: MessageHeader, ADCFrameHeader, then the
+// sample payload (see DataStructures.h).
+
+// Largest frame dimensions a RAW_ADC_DATA header may declare
+constexpr uint32_t MAX_ADC_CHIRPS = 65536;
+constexpr uint32_t MAX_ADC_SAMPLES_PER_CHIRP = 65536;
+
+// Decodes a RAW_ADC_DATA datagram into `frame`, reusing its sample storage.
+// Returns false, leaving the frame in an unspecified state, if the datagram
+// is not a well-formed RAW_ADC_DATA message: the dimensions must be non-zero,
+// within the limits above, and describe exactly the payload that follows
+// (num_chirps * num_rx_antennas * num_samples_per_chirp samples, two values
+// each for complex formats). frame.timestamp_us is set from
+// the message header (0 if the sender has no clock).
+bool parseBinaryADCMessage(const char* data, size_t size, RawADCFrame& frame);
+
+// Encodes `frame` as a RAW_ADC_DATA datagram into `out` (replacing its contents)
+void encodeBinaryADCMessage(const RawADCFrame& frame, std::vector<char>& out);
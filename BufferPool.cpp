@@ -0,0 +1,56 @@
+#include "BufferPool.h"
+
+BufferPool::~BufferPool()
+{
+    for (size_t c = 0; c < NUM_SIZE_CLASSES; ++c) {
+        for (void* block : m_classes[c].free) {
+            ::operator delete(block, std::align_val_t(ALIGNMENT));
+        }
+    }
+}
+
+BufferPool& BufferPool::instance()
+{
+    static BufferPool pool;
+    return pool;
+}
+
+size_t BufferPool::sizeClass(size_t bytes)
+{
+    size_t c = 0;
+    size_t classBytes = MIN_BLOCK_BYTES;
+    while (classBytes < bytes && c + 1 < NUM_SIZE_CLASSES) {
+        classBytes <<= 1;
+        ++c;
+    }
+    return c;
+}
+
+void* BufferPool::acquire(size_t bytes, size_t& capacity)
+{
+    const size_t c = sizeClass(bytes);
+    capacity = MIN_BLOCK_BYTES << c;
+    if (capacity < bytes) {
+        throw std::bad_alloc();
+    }
+
+    SizeClass& sizeClass = m_classes[c];
+    {
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if (!sizeClass.free.empty()) {
+            void* block = sizeClass.free.back();
+            sizeClass.free.pop_back();
+            return block;
+        }
+    }
+
+    m_systemAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(capacity, std::align_val_t(ALIGNMENT));
+}
+
+void BufferPool::release(void* block, size_t capacity)
+{
+    SizeClass& sizeClass = m_classes[this->sizeClass(capacity)];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    sizeClass.free.push_back(block);
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Thread-safe pool of raw memory blocks in power-of-two size classes.
+// Released blocks are kept on a per-class free list and handed out again,
+// so buffers of recurring sizes stop hitting the system allocator.
+class BufferPool
+{
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t MIN_BLOCK_BYTES = 256;
+    static constexpr size_t NUM_SIZE_CLASSES = 28;  // 256 B .. 32 GB
+
+    BufferPool() = default;
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns a block of at least `bytes`; its real size is written to `capacity`
+    void* acquire(size_t bytes, size_t& capacity);
+    // Return a block obtained from acquire() together with its capacity
+    void release(void* block, size_t capacity);
+
+    // Blocks obtained from the system allocator so far
+    size_t systemAllocations() const { return m_systemAllocations.load(std::memory_order_relaxed); }
+
+    static BufferPool& instance();
+
+private:
+    static size_t sizeClass(size_t bytes);
+
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<void*> free;
+    };
+
+    SizeClass m_classes[NUM_SIZE_CLASSES];
+    std::atomic<size_t> m_systemAllocations{0};
+};
+
+// Reference-counted array of trivially copyable elements backed by a
+// BufferPool block. Copies share the block; it returns to the pool when
+// the last reader releases it.
+template <typename T>
+class PooledBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "PooledBuffer holds plain data only");
+
+    struct Header {
+        std::atomic<uint32_t> refs;
+        size_t capacityBytes;
+        size_t size;
+        BufferPool* pool;
+    };
+    static constexpr size_t HEADER_BYTES =
+        (sizeof(Header) + BufferPool::ALIGNMENT - 1) / BufferPool::ALIGNMENT * BufferPool::ALIGNMENT;
+
+public:
+    PooledBuffer() : m_header(nullptr) {}
+    explicit PooledBuffer(size_t count, BufferPool& pool = BufferPool::instance())
+        : m_header(nullptr)
+    {
+        allocate(count, pool);
+    }
+
+    PooledBuffer(const PooledBuffer& other) : m_header(other.m_header) { retain(); }
+    PooledBuffer(PooledBuffer&& other) noexcept : m_header(other.m_header) { other.m_header = nullptr; }
+    ~PooledBuffer() { reset(); }
+
+    PooledBuffer& operator=(const PooledBuffer& other)
+    {
+        if (m_header != other.m_header) {
+            reset();
+            m_header = other.m_header;
+            retain();
+        }
+        return *this;
+    }
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_header = other.m_header;
+            other.m_header = nullptr;
+        }
+        return *this;
+    }
+
+    // Set the element count. Keeps the current block when it is large enough
+    // and not shared; otherwise moves to a pooled block (contents preserved).
+    void resize(size_t count, BufferPool& pool = BufferPool::instance())
+    {
+        if (m_header && m_header->refs.load(std::memory_order_acquire) == 1 &&
+            count * sizeof(T) <= m_header->capacityBytes - HEADER_BYTES) {
+            m_header->size = count;
+            return;
+        }
+        PooledBuffer grown(count, pool);
+        if (m_header) {
+            std::memcpy(grown.data(), data(), std::min(count, size()) * sizeof(T));
+        }
+        *this = std::move(grown);
+    }
+
+    void reset()
+    {
+        if (m_header && m_header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BufferPool* pool = m_header->pool;
+            const size_t capacityBytes = m_header->capacityBytes;
+            m_header->~Header();
+            pool->release(m_header, capacityBytes);
+        }
+        m_header = nullptr;
+    }
+
+    T* data() { return m_header ? reinterpret_cast<T*>(reinterpret_cast<char*>(m_header) + HEADER_BYTES) : nullptr; }
+    const T* data() const { return const_cast<PooledBuffer*>(this)->data(); }
+    size_t size() const { return m_header ? m_header->size : 0; }
+    bool empty() const { return size() == 0; }
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+private:
+    void allocate(size_t count, BufferPool& pool)
+    {
+        size_t capacity = 0;
+        void* block = pool.acquire(HEADER_BYTES + count * sizeof(T), capacity);
+        m_header = new (block) Header{{1}, capacity, count, &pool};
+    }
+
+    void retain()
+    {
+        if (m_header) {
+            m_header->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Header* m_header;
+};
+
+// Pool of reusable frame objects. A Ref keeps its frame alive; when the last
+// Ref is dropped the frame returns to the free list with the capacity of its
+// containers intact, so decoding into a recycled frame does not allocate.
+// The pool must outlive every Ref it hands out.
+template <typename Frame>
+class FramePool
+{
+    struct Node {
+        Frame frame;
+        std::atomic<uint32_t> refs{0};
+        FramePool* pool = nullptr;
+    };
+
+public:
+    class Ref
+    {
+    public:
+        Ref() : m_node(nullptr) {}
+        Ref(const Ref& other) : m_node(other.m_node) { retain(); }
+        Ref(Ref&& other) noexcept : m_node(other.m_node) { other.m_node = nullptr; }
+        ~Ref() { reset(); }
+
+        Ref& operator=(const Ref& other)
+        {
+            if (m_node != other.m_node) {
+                reset();
+                m_node = other.m_node;
+                retain();
+            }
+            return *this;
+        }
+
+        Ref& operator=(Ref&& other) noexcept
+        {
+            if (this != &other) {
+                reset();
+                m_node = other.m_node;
+                other.m_node = nullptr;
+            }
+            return *this;
+        }
+
+        void reset()
+        {
+            if (m_node && m_node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                m_node->pool->recycle(m_node);
+            }
+            m_node = nullptr;
+        }
+
+        Frame* get() const { return m_node ? &m_node->frame : nullptr; }
+        Frame& operator*() const { return m_node->frame; }
+        Frame* operator->() const { return &m_node->frame; }
+        explicit operator bool() const { return m_node != nullptr; }
+
+    private:
+        friend class FramePool;
+        explicit Ref(Node* node) : m_node(node) { retain(); }
+
+        void retain()
+        {
+            if (m_node) {
+                m_node->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Node* m_node;
+    };
+
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    ~FramePool()
+    {
+        for (Node* node : m_nodes) {
+            delete node;
+        }
+    }
+
+    // A free frame (contents left over from its previous use) or a new one
+    Ref acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) {
+            Node* node = new Node;
+            node->pool = this;
+            m_nodes.push_back(node);
+            // Room for every node on the free list, so recycle() never allocates
+            m_free.reserve(m_nodes.size());
+            return Ref(node);
+        }
+        Node* node = m_free.back();
+        m_free.pop_back();
+        return Ref(node);
+    }
+
+    size_t totalFrames() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nodes.size();
+    }
+
+private:
+    void recycle(Node* node)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(node);
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<Node*> m_nodes;
+    std::vector<Node*> m_free;
+};
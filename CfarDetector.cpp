@@ -0,0 +1,53 @@
+#include "CfarDetector.h"
+#include <algorithm>
+#include <cmath>
+
+void CfarDetector::detect(const std::vector<float>& spectrumDb, std::vector<Detection>& detections)
+{
+    detections.clear();
+    const size_t n = spectrumDb.size();
+    if (n == 0) {
+        return;
+    }
+
+    // Prefix sums of linear power make every window sum O(1)
+    m_prefixPower.resize(n + 1);
+    m_prefixPower[0] = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        m_prefixPower[i + 1] = m_prefixPower[i] + std::pow(10.0, spectrumDb[i] / 10.0);
+    }
+
+    const size_t guard = m_config.guardCells;
+    const size_t training = m_config.trainingCells;
+    for (size_t i = 0; i < n; ++i) {
+        // Only report peaks, not every cell of a wide return
+        if ((i > 0 && spectrumDb[i - 1] > spectrumDb[i]) ||
+            (i + 1 < n && spectrumDb[i + 1] >= spectrumDb[i])) {
+            continue;
+        }
+
+        double noise = 0.0;
+        size_t cells = 0;
+        if (i >= guard + 1) {
+            const size_t end = i - guard;
+            const size_t begin = end > training ? end - training : 0;
+            noise += m_prefixPower[end] - m_prefixPower[begin];
+            cells += end - begin;
+        }
+        if (i + guard + 1 < n) {
+            const size_t begin = i + guard + 1;
+            const size_t end = std::min(n, begin + training);
+            noise += m_prefixPower[end] - m_prefixPower[begin];
+            cells += end - begin;
+        }
+        if (cells == 0) {
+            continue;
+        }
+
+        const float noiseDb = static_cast<float>(10.0 * std::log10(noise / cells + 1e-30));
+        const float snrDb = spectrumDb[i] - noiseDb;
+        if (snrDb >= m_config.thresholdDb) {
+            detections.push_back(Detection{i, spectrumDb[i], snrDb});
+        }
+    }
+}
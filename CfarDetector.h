@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Cell-averaging CFAR over a power spectrum in dB (SpectrumProcessor::magnitude()).
+// Each cell under test is compared with the mean power of the training cells
+// on both sides, skipping the guard cells next to it.
+class CfarDetector
+{
+public:
+    struct Config {
+        size_t guardCells = 2;     // per side
+        size_t trainingCells = 8;  // per side
+        float thresholdDb = 12.0f; // required margin above the noise estimate
+    };
+
+    struct Detection {
+        size_t bin;       // index into the spectrum
+        float powerDb;
+        float snrDb;      // power above the local noise estimate
+    };
+
+    CfarDetector() = default;
+    explicit CfarDetector(const Config& config) : m_config(config) {}
+
+    void setConfig(const Config& config) { m_config = config; }
+    const Config& config() const { return m_config; }
+
+    // Replaces `detections` with the local maxima that cross the threshold.
+    // Near the edges only the side with training cells contributes.
+    void detect(const std::vector<float>& spectrumDb, std::vector<Detection>& detections);
+
+private:
+    Config m_config;
+    std::vector<double> m_prefixPower;  // running sum of linear power, reused per call
+};
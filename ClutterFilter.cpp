@@ -0,0 +1,123 @@
+#include "ClutterFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RADAR_HAVE_SSE2 1
+#endif
+
+namespace clutter {
+
+size_t mtiTaps(MtiMode mode)
+{
+    switch (mode) {
+    case MtiMode::TwoPulse: return 2;
+    case MtiMode::ThreePulse: return 3;
+    case MtiMode::Off: break;
+    }
+    return 1;
+}
+
+namespace {
+
+// out[i] = a[i] - b[i] over `count` floats; out may alias a
+void cancel2(float* out, const float* b, size_t count)
+{
+    size_t i = 0;
+#ifdef RADAR_HAVE_SSE2
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(b + i)));
+        _mm_storeu_ps(out + i + 4, _mm_sub_ps(_mm_loadu_ps(out + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] -= b[i];
+    }
+}
+
+// out[i] = a[i] - 2 b[i] + c[i] over `count` floats; out may alias a
+void cancel3(float* out, const float* b, const float* c, size_t count)
+{
+    size_t i = 0;
+#ifdef RADAR_HAVE_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128 bb = _mm_loadu_ps(b + i);
+        const __m128 a = _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(c + i));
+        _mm_storeu_ps(out + i, _mm_sub_ps(a, _mm_add_ps(bb, bb)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = out[i] - 2.0f * b[i] + c[i];
+    }
+}
+
+} // namespace
+
+void cancelChirps(std::complex<float>* rows, size_t chirps, size_t n, MtiMode mode)
+{
+    const size_t taps = mtiTaps(mode);
+    if (taps < 2 || chirps < taps || n == 0) {
+        return;
+    }
+    // Last chirp first, so every output still reads unmodified inputs
+    float* data = reinterpret_cast<float*>(rows);
+    const size_t stride = 2 * n;
+    for (size_t c = chirps; c-- > taps - 1;) {
+        float* out = data + c * stride;
+        if (taps == 2) {
+            cancel2(out, out - stride, stride);
+        } else {
+            cancel3(out, out - stride, out - 2 * stride, stride);
+        }
+    }
+}
+
+} // namespace clutter
+
+ClutterMap::ClutterMap()
+    : m_alpha(DEFAULT_ALPHA)
+{
+}
+
+void ClutterMap::setAlpha(float alpha)
+{
+    m_alpha = std::min(1.0f, std::max(1e-4f, alpha));
+}
+
+void ClutterMap::apply(float* power, size_t bins)
+{
+    if (bins == 0) {
+        return;
+    }
+    if (m_background.size() != bins) {
+        // First frame of a layout: it is all background so far
+        m_background.resize(bins);
+        std::memcpy(m_background.data(), power, bins * sizeof(float));
+    }
+
+    // Residual against the estimate from the previous frames, so a target
+    // that just appeared is not partly subtracted from itself
+    const float floorRatio = std::pow(10.0f, -MAX_SUPPRESSION_DB / 10.0f);
+    const float alpha = m_alpha;
+    float* background = m_background.data();
+    size_t i = 0;
+#ifdef RADAR_HAVE_SSE2
+    const __m128 floor = _mm_set1_ps(floorRatio);
+    const __m128 weight = _mm_set1_ps(alpha);
+    for (; i + 4 <= bins; i += 4) {
+        const __m128 p = _mm_loadu_ps(power + i);
+        const __m128 bg = _mm_load_ps(background + i);
+        const __m128 diff = _mm_sub_ps(p, bg);
+        _mm_storeu_ps(power + i, _mm_max_ps(diff, _mm_mul_ps(p, floor)));
+        _mm_store_ps(background + i, _mm_add_ps(bg, _mm_mul_ps(weight, diff)));
+    }
+#endif
+    for (; i < bins; ++i) {
+        const float p = power[i];
+        const float diff = p - background[i];
+        power[i] = std::max(diff, p * floorRatio);
+        background[i] += alpha * diff;
+    }
+}
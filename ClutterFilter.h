@@ -0,0 +1,60 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include "BufferPool.h"
+
+// Stationary clutter suppression for range spectra.
+//
+// The MTI canceller works across the chirps of one frame: a two-pulse
+// canceller keeps x[c] - x[c-1], a three-pulse one x[c] - 2x[c-1] + x[c-2],
+// so returns whose phase does not change from chirp to chirp (zero Doppler)
+// cancel out. It is linear, so it can run on samples or range FFT bins.
+//
+// The clutter map works across frames: a recursive (exponentially weighted)
+// background power estimate per range bin, subtracted from each new frame.
+// It also removes slowly moving clutter the MTI notch is too narrow for.
+namespace clutter {
+
+enum class MtiMode {
+    Off,
+    TwoPulse,
+    ThreePulse
+};
+
+// Chirps combined into one output chirp (1 when off)
+size_t mtiTaps(MtiMode mode);
+
+// Replaces chirps [taps - 1, chirps) of `rows` (chirps x n complex values,
+// row-major) with the canceller output, in place; the first taps - 1 rows
+// are left as they are. Does nothing when there are fewer than taps chirps.
+void cancelChirps(std::complex<float>* rows, size_t chirps, size_t n, MtiMode mode);
+
+} // namespace clutter
+
+class ClutterMap
+{
+public:
+    static constexpr float DEFAULT_ALPHA = 0.05f;
+    // Floor of the residual, relative to the input power: a bin is never
+    // pushed more than this far down
+    static constexpr float MAX_SUPPRESSION_DB = 40.0f;
+
+    ClutterMap();
+
+    // Weight of the newest frame in the background estimate, (0, 1]
+    void setAlpha(float alpha);
+    float alpha() const { return m_alpha; }
+    // Forget the background; the next frame starts a new estimate
+    void reset() { m_background.reset(); }
+
+    // Subtracts the background from `power` (linear, one value per bin) in
+    // place and then folds the input into the background. A change of the
+    // bin count restarts the estimate from this frame.
+    void apply(float* power, size_t bins);
+    const float* background() const { return m_background.data(); }
+
+private:
+    PooledBuffer<float> m_background;  // 64-byte aligned, one value per bin
+    float m_alpha;
+};
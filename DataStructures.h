@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -28,8 +29,10 @@ struct TargetTrack {
 struct TargetTrackData {
     uint32_t numTracks;
     std::vector<TargetTrack> targets;
+    uint64_t timestamp_us;  // source time (us since epoch), receive time if unstamped
+    uint64_t received_us;   // local receive time, set by SourceReceiver
     
-    TargetTrackData() : numTracks(0) {}
+    TargetTrackData() : numTracks(0), timestamp_us(0), received_us(0) {}
     
     void resize(uint32_t size) {
         numTracks = size;
@@ -37,9 +40,18 @@ struct TargetTrackData {
     }
 };
 
+inline bool isInt16Format(Rx_Data_Format_t format) {
+    return format == Rx_Data_Format_t::COMPLEX_INT16 || format == Rx_Data_Format_t::REAL_INT16;
+}
+
+inline bool isComplexFormat(Rx_Data_Format_t format) {
+    return format == Rx_Data_Format_t::COMPLEX_FLOAT || format == Rx_Data_Format_t::COMPLEX_INT16;
+}
+
 // Raw ADC Frame structure
 struct RawADCFrame {
-    std::vector<float> sample_data;
+    std::vector<float> sample_data;      // REAL_FLOAT / COMPLEX_FLOAT
+    std::vector<int16_t> sample_data_i16; // REAL_INT16 / COMPLEX_INT16, stored as received
     uint32_t frame_number;
     uint32_t num_chirps;
     uint8_t num_rx_antennas;
@@ -48,10 +60,17 @@ struct RawADCFrame {
     uint8_t adc_resolution;
     uint8_t interleaved_rx;
     Rx_Data_Format_t data_format;
+    uint64_t timestamp_us;  // MessageHeader::timestamp, receive time if zero
     
     RawADCFrame() : frame_number(0), num_chirps(1), num_rx_antennas(1), 
                    num_samples_per_chirp(256), rx_mask(0x1), adc_resolution(16),
-                   interleaved_rx(0), data_format(Rx_Data_Format_t::REAL_FLOAT) {}
+                   interleaved_rx(0), data_format(Rx_Data_Format_t::REAL_FLOAT),
+                   timestamp_us(0) {}
+
+    // Number of scalar values held by the active storage (I and Q count separately)
+    size_t valueCount() const {
+        return isInt16Format(data_format) ? sample_data_i16.size() : sample_data.size();
+    }
 };
 
 // Raw ADC Frame structure
@@ -59,19 +78,34 @@ struct RawADCFrameTest {
     uint32_t msgId;
     uint32_t num_samples_per_chirp;
     std::vector<float> sample_data;
+    uint64_t timestamp_us = 0;  // receive time (us since epoch)
 };
 
 // UDP Message types
 enum class MessageType : uint8_t {
     TARGET_TRACK_DATA = 1,
-    RAW_ADC_DATA = 2
+    RAW_ADC_DATA = 2,
+    TRACK_DELTA_DATA = 3  // compact tracks, see TrackCodec.h
 };
 
 // UDP Message header
 struct MessageHeader {
     MessageType type;
     uint32_t data_size;
-    uint64_t timestamp;
+    uint64_t timestamp;  // microseconds since the Unix epoch, 0 if the sender has no clock
+};
+
+// Binary RAW_ADC_DATA payload: this header followed by the sample values
+// (int16 or float, little-endian, I/Q pairs for complex formats)
+struct ADCFrameHeader {
+    uint32_t frame_number;
+    uint32_t num_chirps;
+    uint8_t num_rx_antennas;
+    uint32_t num_samples_per_chirp;
+    uint8_t rx_mask;
+    uint8_t adc_resolution;
+    uint8_t interleaved_rx;
+    uint8_t data_format;  // Rx_Data_Format_t
 };
 
 #pragma pack(pop)
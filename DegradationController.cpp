@@ -0,0 +1,123 @@
+#include "DegradationController.h"
+#include <algorithm>
+
+namespace {
+
+const DegradationController::Settings LEVEL_SETTINGS[DegradationController::NUM_LEVELS] = {
+    // labels, table, spectrum, average, chirps, input
+    {true, 1, 1, true, 0, 1},
+    {false, 4, 1, true, 0, 1},
+    {false, 8, 2, false, 8, 1},
+    {false, 16, 4, false, 2, 2},
+};
+
+} // namespace
+
+DegradationController::DegradationController()
+    : m_enabled(false)
+    , m_budgetMs(DEFAULT_BUDGET_MS)
+    , m_level(Level::Full)
+    , m_pendingNs{}
+    , m_stageCostMs{}
+    , m_costMs(0.0)
+    , m_overBudget(0)
+    , m_underBudget(0)
+    , m_refreshesAtLevel(0)
+    , m_recoverAfter(RECOVER_AFTER)
+    , m_recovered(false)
+{
+}
+
+void DegradationController::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    m_recoverAfter = RECOVER_AFTER;
+    setLevel(Level::Full, false);
+}
+
+void DegradationController::setBudgetMs(double ms)
+{
+    m_budgetMs = std::max(0.1, ms);
+    m_overBudget = 0;
+    m_underBudget = 0;
+}
+
+const DegradationController::Settings& DegradationController::settingsFor(Level level)
+{
+    return LEVEL_SETTINGS[static_cast<int>(level)];
+}
+
+const char* DegradationController::levelName(Level level)
+{
+    switch (level) {
+    case Level::Full: return "Full";
+    case Level::Reduced: return "Reduced";
+    case Level::Low: return "Low";
+    case Level::Minimal: return "Minimal";
+    }
+    return "?";
+}
+
+Stage DegradationController::costliestStage() const
+{
+    size_t costliest = 0;
+    for (size_t i = 1; i < NUM_STAGES; ++i) {
+        if (m_stageCostMs[i] > m_stageCostMs[costliest]) {
+            costliest = i;
+        }
+    }
+    return static_cast<Stage>(costliest);
+}
+
+void DegradationController::setLevel(Level level, bool recovery)
+{
+    m_level = level;
+    m_recovered = recovery;
+    m_refreshesAtLevel = 0;
+    m_overBudget = 0;
+    m_underBudget = 0;
+}
+
+bool DegradationController::endRefresh()
+{
+    double totalMs = 0.0;
+    for (size_t i = 0; i < NUM_STAGES; ++i) {
+        const double ms = m_pendingNs[i] / 1e6;
+        m_pendingNs[i] = 0;
+        m_stageCostMs[i] += SMOOTHING * (ms - m_stageCostMs[i]);
+        totalMs += ms;
+    }
+    m_costMs += SMOOTHING * (totalMs - m_costMs);
+
+    ++m_refreshesAtLevel;
+    if (!m_enabled || m_refreshesAtLevel <= SETTLE_REFRESHES) {
+        // The smoothed cost still reflects the previous level
+        return false;
+    }
+    // A recovery that held as long as it had to wait counts as a success
+    if (m_recovered && m_refreshesAtLevel == m_recoverAfter) {
+        m_recoverAfter = RECOVER_AFTER;
+    }
+
+    const int level = static_cast<int>(m_level);
+    if (m_costMs > m_budgetMs) {
+        m_underBudget = 0;
+        if (++m_overBudget >= DEGRADE_AFTER && level + 1 < NUM_LEVELS) {
+            if (m_recovered && m_refreshesAtLevel < m_recoverAfter) {
+                m_recoverAfter = std::min(MAX_RECOVER_AFTER, 2 * m_recoverAfter);
+            }
+            setLevel(static_cast<Level>(level + 1), false);
+            return true;
+        }
+    } else if (m_costMs < RECOVER_FRACTION * m_budgetMs) {
+        m_overBudget = 0;
+        if (++m_underBudget >= m_recoverAfter && level > 0) {
+            setLevel(static_cast<Level>(level - 1), true);
+            return true;
+        }
+    } else {
+        m_overBudget = 0;
+        m_underBudget = 0;
+    }
+    return false;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Instrumentation.h"
+
+// Load shedding for the display path. The GUI thread reports what each
+// stage cost since the previous refresh; the smoothed total per refresh is
+// compared with a frame-time budget. Staying over it for DEGRADE_AFTER
+// refreshes drops one level of detail, staying under RECOVER_FRACTION of it
+// for the recovery wait restores one. A recovery that is undone right away
+// doubles the wait before the next attempt, so a load just above what the
+// full level can handle does not make the display flip back and forth.
+// Costs are measured here rather than taken from Instrumentation, which
+// only records while the stats overlay is on.
+class DegradationController
+{
+public:
+    enum class Level {
+        Full,
+        Reduced,   // no target labels, track table every few refreshes
+        Low,       // also latest spectrum only, every other refresh, fewer chirps
+        Minimal    // also every other input frame shown
+    };
+    static constexpr int NUM_LEVELS = 4;
+
+    // What the display does at a level
+    struct Settings {
+        bool targetLabels;           // PPI ID labels
+        unsigned tableInterval;      // track table refreshed every N refreshes
+        unsigned spectrumInterval;   // spectrum computed every N refreshes
+        bool spectrumAverage;        // power-average pending frames, else the latest only
+        size_t maxChirps;            // chirps per channel spectrum, 0 = all
+        unsigned inputDecimation;    // every Nth received frame reaches the display
+    };
+
+    static constexpr double DEFAULT_BUDGET_MS = 8.0;
+    static constexpr unsigned DEGRADE_AFTER = 5;            // refreshes
+    static constexpr unsigned RECOVER_AFTER = 60;
+    static constexpr unsigned MAX_RECOVER_AFTER = 60 * 32;
+    static constexpr unsigned SETTLE_REFRESHES = 10;        // after a change, before deciding again
+    static constexpr double RECOVER_FRACTION = 0.6;
+    static constexpr double SMOOTHING = 0.2;
+
+    DegradationController();
+
+    // Disabled: always Full, costs are still tracked
+    void setEnabled(bool enabled);
+    bool enabled() const { return m_enabled; }
+    void setBudgetMs(double ms);
+    double budgetMs() const { return m_budgetMs; }
+
+    // Adds to a stage's cost in the current refresh
+    void record(Stage stage, uint64_t ns) { m_pendingNs[static_cast<size_t>(stage)] += ns; }
+    // Closes a refresh; true when the level changed
+    bool endRefresh();
+
+    Level level() const { return m_level; }
+    const Settings& settings() const { return settingsFor(m_level); }
+    static const Settings& settingsFor(Level level);
+    static const char* levelName(Level level);
+
+    // Smoothed cost per refresh, in total and of one stage
+    double costMs() const { return m_costMs; }
+    double stageCostMs(Stage stage) const { return m_stageCostMs[static_cast<size_t>(stage)]; }
+    Stage costliestStage() const;
+    // Refreshes to stay under budget before the next recovery step
+    unsigned recoverAfter() const { return m_recoverAfter; }
+
+private:
+    void setLevel(Level level, bool recovery);
+
+    static constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::Count);
+
+    bool m_enabled;
+    double m_budgetMs;
+    Level m_level;
+    uint64_t m_pendingNs[NUM_STAGES];
+    double m_stageCostMs[NUM_STAGES];
+    double m_costMs;
+    unsigned m_overBudget;       // consecutive refreshes
+    unsigned m_underBudget;
+    unsigned m_refreshesAtLevel;
+    unsigned m_recoverAfter;
+    bool m_recovered;            // the last change was a recovery step
+};
@@ -1,4 +1,5 @@
 #include "FFTWidget.h"
+#include "Instrumentation.h"
 #include <QPaintEvent>
 #include <QResizeEvent>
 #include <QFont>
@@ -8,7 +9,11 @@
 
 FFTWidget::FFTWidget(QWidget *parent)
     : QWidget(parent)
-    , m_maxMagnitude(0.0f)
+    , m_channelDisplay(ChannelDisplay::Single)
+    , m_frameNumber(0)
+    , m_frameTimestamp(0)
+    , m_paintedTimestamp(0)
+    , m_paintTimeNs(0)
     , m_margin(50)
 {
     setMinimumSize(400, 300);
@@ -18,106 +23,140 @@ FFTWidget::FFTWidget(QWidget *parent)
 
 void FFTWidget::updateData(const RawADCFrameTest& adcFrame)
 {
-    m_currentFrame = adcFrame;
-    if (!adcFrame.sample_data.empty()) {
-        performFFT(adcFrame.sample_data);
+    m_frameNumber = adcFrame.msgId;
+    m_frameTimestamp = adcFrame.timestamp_us;
+    {
+        ScopedStageTimer timer(Stage::FFT);
+        m_spectrum.process(adcFrame.sample_data);
     }
     update();
 }
 
-void FFTWidget::resizeEvent(QResizeEvent *event)
+void FFTWidget::updateData(const RawADCFrame& adcFrame)
 {
-    QWidget::resizeEvent(event);
+    ScopedStageTimer timer(Stage::FFT);
+    // Single view: first chirp of the first enabled RX channel
+    bool ok = m_channelDisplay == ChannelDisplay::Single ? m_spectrum.process(adcFrame)
+                                                          : m_spectrum.processChannels(adcFrame);
+    if (!ok) {
+        return;
+    }
 
-    m_plotRect = QRect(
-        m_margin,
-        m_margin,
-        width() - 2 * m_margin,
-        height() - 2 * m_margin
-    );
+    m_frameNumber = adcFrame.frame_number;
+    m_frameTimestamp = adcFrame.timestamp_us;
+    update();
 }
 
-void FFTWidget::paintEvent(QPaintEvent *event)
+void FFTWidget::updateData(const std::vector<const RawADCFrameTest*>& adcFrames)
 {
-    Q_UNUSED(event)
-
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    drawBackground(painter);
-    drawGrid(painter);
-    drawSpectrum(painter);
-    drawLabels(painter);
+    if (adcFrames.empty()) {
+        return;
+    }
+    {
+        ScopedStageTimer timer(Stage::FFT);
+        m_spectrum.processAverage(adcFrames);
+    }
+    m_frameNumber = adcFrames.back()->msgId;
+    m_frameTimestamp = adcFrames.back()->timestamp_us;
+    update();
 }
 
-void FFTWidget::performFFT(const std::vector<float>& input)
+void FFTWidget::updateData(const std::vector<const RawADCFrame*>& adcFrames)
 {
-    if (input.empty()) return;
-
-    size_t n = 1;
-    while (n < input.size()) {
-        n *= 2;
+    if (adcFrames.empty()) {
+        return;
     }
-
-    std::vector<std::complex<float>> complexData(n);
-    for (size_t i = 0; i < input.size() && i < n; ++i) {
-        complexData[i] = std::complex<float>(input[i], 0.0f);
+    if (m_channelDisplay != ChannelDisplay::Single) {
+        updateData(*adcFrames.back());
+        return;
+    }
+    {
+        ScopedStageTimer timer(Stage::FFT);
+        if (!m_spectrum.processAverage(adcFrames)) {
+            return;
+        }
     }
+    m_frameNumber = adcFrames.back()->frame_number;
+    m_frameTimestamp = adcFrames.back()->timestamp_us;
+    update();
+}
 
-    fft(complexData);
+void FFTWidget::showSpectrum(const float* magnitude, size_t bins, bool twoSided,
+                             uint32_t frameNumber, uint64_t timestampUs)
+{
+    m_spectrum.setSpectrum(magnitude, bins, twoSided);
+    m_frameNumber = frameNumber;
+    m_frameTimestamp = timestampUs;
+    // Recorded frames stay out of the end-to-end latency histogram
+    m_paintedTimestamp = timestampUs;
+    update();
+}
 
-    m_magnitudeSpectrum.resize(n / 2);
-    m_frequencyAxis.resize(n / 2);
+void FFTWidget::setWindowFunction(WindowFunction window)
+{
+    m_spectrum.setWindowFunction(window);
+}
 
-    m_maxMagnitude = 0.0f;
-    for (size_t i = 0; i < n / 2; ++i) {
-        float magnitude = std::abs(complexData[i]);
-        m_magnitudeSpectrum[i] = 20.0f * std::log10(magnitude + 1e-10f);
-        m_frequencyAxis[i] = static_cast<float>(i);
+void FFTWidget::setMtiMode(SpectrumProcessor::MtiMode mode)
+{
+    m_spectrum.setMtiMode(mode);
+}
 
-        if (m_magnitudeSpectrum[i] > m_maxMagnitude) {
-            m_maxMagnitude = m_magnitudeSpectrum[i];
-        }
-    }
+void FFTWidget::setClutterMapEnabled(bool enabled)
+{
+    m_spectrum.setClutterMapEnabled(enabled);
 }
 
-void FFTWidget::fft(std::vector<std::complex<float>>& data)
+void FFTWidget::setMaxChirps(size_t chirps)
 {
-    size_t n = data.size();
-    if (n <= 1) return;
+    m_spectrum.setMaxChirps(chirps);
+}
 
-    bit_reverse(data);
+uint64_t FFTWidget::takePaintTimeNs()
+{
+    const uint64_t ns = m_paintTimeNs;
+    m_paintTimeNs = 0;
+    return ns;
+}
 
-    for (size_t len = 2; len <= n; len <<= 1) {
-        float angle = -2.0f * M_PI / len;
-        std::complex<float> wlen(std::cos(angle), std::sin(angle));
+void FFTWidget::setChannelDisplay(ChannelDisplay display)
+{
+    m_channelDisplay = display;
+    update();
+}
 
-        for (size_t i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            for (size_t j = 0; j < len / 2; ++j) {
-                std::complex<float> u = data[i + j];
-                std::complex<float> v = data[i + j + len / 2] * w;
-                data[i + j] = u + v;
-                data[i + j + len / 2] = u - v;
-                w *= wlen;
-            }
-        }
-    }
+void FFTWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    m_plotRect = QRect(
+        m_margin,
+        m_margin,
+        width() - 2 * m_margin,
+        height() - 2 * m_margin
+    );
 }
 
-void FFTWidget::bit_reverse(std::vector<std::complex<float>>& data)
+void FFTWidget::paintEvent(QPaintEvent *event)
 {
-    size_t n = data.size();
-    for (size_t i = 1, j = 0; i < n; ++i) {
-        size_t bit = n >> 1;
-        for (; j & bit; bit >>= 1) {
-            j ^= bit;
-        }
-        j ^= bit;
+    Q_UNUSED(event)
 
-        if (i < j) {
-            std::swap(data[i], data[j]);
-        }
+    const uint64_t paintStart = Instrumentation::nowNs();
+    {
+        ScopedStageTimer timer(Stage::PaintFFT);
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        drawBackground(painter);
+        drawGrid(painter);
+        drawSpectrum(painter);
+        drawLabels(painter);
+    }
+    m_paintTimeNs += Instrumentation::nowNs() - paintStart;
+
+    if (m_frameTimestamp != m_paintedTimestamp) {
+        m_paintedTimestamp = m_frameTimestamp;
+        Instrumentation::instance().recordEndToEnd(m_paintedTimestamp);
     }
 }
 
@@ -142,24 +181,82 @@ void FFTWidget::drawGrid(QPainter& painter)
         int y = m_plotRect.top() + (i * m_plotRect.height()) / GRID_LINES_Y;
         painter.drawLine(m_plotRect.left(), y, m_plotRect.right(), y);
     }
+
+    if (m_spectrum.twoSided()) {
+        // Zero-frequency marker between negative and positive bins
+        painter.setPen(QPen(QColor(120, 120, 60), 1, Qt::DashLine));
+        int x = m_plotRect.left() + m_plotRect.width() / 2;
+        painter.drawLine(x, m_plotRect.top(), x, m_plotRect.bottom());
+    }
+}
+
+bool FFTWidget::showingChannels() const
+{
+    return m_spectrum.hasChannelSpectra() && m_channelDisplay != ChannelDisplay::Single;
 }
 
 void FFTWidget::drawSpectrum(QPainter& painter)
 {
-    if (m_magnitudeSpectrum.empty()) return;
+    if (m_spectrum.magnitude().empty()) return;
 
-    painter.setPen(QPen(QColor(0, 255, 255), 2));
     painter.setBrush(Qt::NoBrush);
 
+    if (!showingChannels()) {
+        painter.setPen(QPen(QColor(0, 255, 255), 2));
+        drawTrace(painter, m_spectrum.magnitude(), m_plotRect, MIN_MAG_DB, MAX_MAG_DB);
+        return;
+    }
+
+    const std::vector<int>& channels = m_spectrum.channels();
+    const int numChannels = static_cast<int>(channels.size());
+    for (int c = 0; c < numChannels; ++c) {
+        painter.setPen(QPen(channelColor(channels[c]), 1));
+
+        switch (m_channelDisplay) {
+        case ChannelDisplay::Overlay:
+            drawTrace(painter, m_spectrum.channelMagnitudes()[c], m_plotRect, MIN_MAG_DB, MAX_MAG_DB);
+            break;
+        case ChannelDisplay::Tiled: {
+            int tileHeight = m_plotRect.height() / numChannels;
+            QRect tile(m_plotRect.left(), m_plotRect.top() + c * tileHeight,
+                       m_plotRect.width(), tileHeight);
+            drawTrace(painter, m_spectrum.channelMagnitudes()[c], tile, MIN_MAG_DB, MAX_MAG_DB);
+            painter.drawText(tile.left() + 5, tile.top() + 12, QString("RX%1").arg(channels[c]));
+            break;
+        }
+        case ChannelDisplay::Phase:
+            // The reference channel is flat at zero; show the others against it
+            if (c > 0) {
+                drawTrace(painter, m_spectrum.channelPhase()[c], m_plotRect, -180.0f, 180.0f);
+            }
+            break;
+        case ChannelDisplay::Coherence:
+            if (c > 0) {
+                drawTrace(painter, m_spectrum.channelCoherence()[c], m_plotRect, 0.0f, 1.0f);
+            }
+            break;
+        case ChannelDisplay::Single:
+            break;
+        }
+    }
+}
+
+void FFTWidget::drawTrace(QPainter& painter, const std::vector<float>& values, const QRect& rect,
+                          float minValue, float maxValue)
+{
     QPolygonF spectrum;
 
-    for (size_t i = 0; i < m_magnitudeSpectrum.size(); ++i) {
-        float index = m_frequencyAxis[i];
-        float x = m_plotRect.left() + (index / m_magnitudeSpectrum.size()) * m_plotRect.width();
+    // Frequency axis starts at -n/2 for a two-sided spectrum
+    const std::vector<float>& frequencyAxis = m_spectrum.frequencyAxis();
+    float axisStart = frequencyAxis.front();
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        float index = frequencyAxis[i] - axisStart;
+        float x = rect.left() + (index / values.size()) * rect.width();
 
-        float magDb = m_magnitudeSpectrum[i];
-        float y = m_plotRect.bottom() - ((magDb - MIN_MAG_DB) / (MAX_MAG_DB - MIN_MAG_DB)) * m_plotRect.height();
-        y = std::max(float(m_plotRect.top()), std::min(float(m_plotRect.bottom()), y));
+        float value = values[i];
+        float y = rect.bottom() - ((value - minValue) / (maxValue - minValue)) * rect.height();
+        y = std::max(float(rect.top()), std::min(float(rect.bottom()), y));
 
         spectrum << QPointF(x, y);
     }
@@ -169,16 +266,26 @@ void FFTWidget::drawSpectrum(QPainter& painter)
     }
 }
 
+QColor FFTWidget::channelColor(int channel)
+{
+    static const QColor colors[8] = {
+        QColor(0, 255, 255), QColor(255, 200, 0), QColor(255, 80, 160), QColor(120, 255, 80),
+        QColor(160, 120, 255), QColor(255, 120, 60), QColor(80, 160, 255), QColor(220, 220, 220)
+    };
+    return colors[channel & 7];
+}
+
 void FFTWidget::drawLabels(QPainter& painter)
 {
     painter.setPen(QPen(Qt::white, 1));
     painter.setFont(QFont("Arial", 10));
 
-    if (!m_magnitudeSpectrum.empty()) {
-        int numBins = static_cast<int>(m_magnitudeSpectrum.size());
+    if (!m_spectrum.magnitude().empty()) {
+        int numBins = static_cast<int>(m_spectrum.magnitude().size());
+        int firstBin = static_cast<int>(m_spectrum.frequencyAxis().front());
 
         for (int i = 0; i <= GRID_LINES_X; ++i) {
-            int bin = (i * numBins) / GRID_LINES_X;
+            int bin = firstBin + (i * numBins) / GRID_LINES_X;
             int x = m_plotRect.left() + (i * m_plotRect.width()) / GRID_LINES_X;
 
             QString label = QString::number(bin);
@@ -188,18 +295,35 @@ void FFTWidget::drawLabels(QPainter& painter)
         }
     }
 
-    for (int i = 0; i <= GRID_LINES_Y; ++i) {
-        float mag = MIN_MAG_DB + (float(i) / GRID_LINES_Y) * (MAX_MAG_DB - MIN_MAG_DB);
-        int y = m_plotRect.bottom() - (i * m_plotRect.height()) / GRID_LINES_Y;
+    float minY = MIN_MAG_DB;
+    float maxY = MAX_MAG_DB;
+    QString unit = "dB";
+    int decimals = 0;
+    if (showingChannels() && m_channelDisplay == ChannelDisplay::Phase) {
+        minY = -180.0f;
+        maxY = 180.0f;
+        unit = "°";
+    } else if (showingChannels() && m_channelDisplay == ChannelDisplay::Coherence) {
+        minY = 0.0f;
+        maxY = 1.0f;
+        unit = "";
+        decimals = 1;
+    }
+
+    if (!showingChannels() || m_channelDisplay != ChannelDisplay::Tiled) {
+        for (int i = 0; i <= GRID_LINES_Y; ++i) {
+            float mag = minY + (float(i) / GRID_LINES_Y) * (maxY - minY);
+            int y = m_plotRect.bottom() - (i * m_plotRect.height()) / GRID_LINES_Y;
 
-        QString magText = QString("%1dB").arg(mag, 0, 'f', 0);
-        painter.drawText(m_plotRect.left() - 35, y + 5, magText);
+            QString magText = QString("%1").arg(mag, 0, 'f', decimals) + unit;
+            painter.drawText(m_plotRect.left() - 35, y + 5, magText);
+        }
     }
 
     painter.setFont(QFont("Arial", 12, QFont::Bold));
 
     QFontMetrics fm(painter.font());
-    QString xLabel = "Sample Index";
+    QString xLabel = m_spectrum.twoSided() ? "Frequency Bin (I/Q, two-sided)" : "Sample Index";
     QRect xLabelRect = fm.boundingRect(xLabel);
     painter.drawText(
         m_plotRect.center().x() - xLabelRect.width() / 2,
@@ -211,6 +335,11 @@ void FFTWidget::drawLabels(QPainter& painter)
     painter.translate(15, m_plotRect.center().y());
     painter.rotate(-90);
     QString yLabel = "Magnitude (dB)";
+    if (showingChannels() && m_channelDisplay == ChannelDisplay::Phase) {
+        yLabel = "Phase vs. reference (°)";
+    } else if (showingChannels() && m_channelDisplay == ChannelDisplay::Coherence) {
+        yLabel = "Coherence";
+    }
     QRect yLabelRect = fm.boundingRect(yLabel);
     painter.drawText(-yLabelRect.width() / 2, 0, yLabel);
     painter.restore();
@@ -220,7 +349,7 @@ void FFTWidget::drawLabels(QPainter& painter)
 
     painter.setFont(QFont("Arial", 10));
     QString frameInfo = QString("Frame: %1, Samples: %2")
-                       .arg(1)
-                       .arg(m_currentFrame.sample_data.size());
+                       .arg(m_frameNumber)
+                       .arg(m_spectrum.sampleCount());
     painter.drawText(QPointF(10, height() - 10), frameInfo);
 }
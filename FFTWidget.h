@@ -3,41 +3,73 @@
 #include <QWidget>
 #include <QPainter>
 #include <vector>
-#include <complex>
 #include "DataStructures.h"
+#include "SpectrumProcessor.h"
 
 class FFTWidget : public QWidget
 {
     Q_OBJECT
 
 public:
+    using WindowFunction = SpectrumProcessor::WindowFunction;
+
+    // How multi-channel frames are shown
+    enum class ChannelDisplay {
+        Single,     // first enabled channel, first chirp
+        Overlay,    // all enabled channels in one plot
+        Tiled,      // one plot row per channel
+        Phase,      // cross-spectrum phase vs. the first enabled channel
+        Coherence   // magnitude-squared coherence vs. the first enabled channel
+    };
+
     explicit FFTWidget(QWidget *parent = nullptr);
     
     void updateData(const RawADCFrameTest& adcFrame);
+    void updateData(const RawADCFrame& adcFrame);
+    // Power-averaged spectrum of all frames since the last refresh; the
+    // multi-channel views use the most recent frame
+    void updateData(const std::vector<const RawADCFrameTest*>& adcFrames);
+    void updateData(const std::vector<const RawADCFrame*>& adcFrames);
+    // Shows a recorded magnitude spectrum instead of computing one
+    void showSpectrum(const float* magnitude, size_t bins, bool twoSided,
+                      uint32_t frameNumber, uint64_t timestampUs);
+    // Last computed spectrum, for recording what is displayed
+    const SpectrumProcessor& spectrum() const { return m_spectrum; }
+    uint32_t frameNumber() const { return m_frameNumber; }
+    uint64_t frameTimestamp() const { return m_frameTimestamp; }
     void setFrequencyRange(float minFreq, float maxFreq);
+    void setWindowFunction(WindowFunction window);
+    void setChannelDisplay(ChannelDisplay display);
+    void setMtiMode(SpectrumProcessor::MtiMode mode);
+    void setClutterMapEnabled(bool enabled);
+    // Chirps per frame in the multi-channel views, 0 = all
+    void setMaxChirps(size_t chirps);
+    // Paint time since the last call (measured with instrumentation off too)
+    uint64_t takePaintTimeNs();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private:
-    void performFFT(const std::vector<float>& input);
     void drawBackground(QPainter& painter);
     void drawGrid(QPainter& painter);
     void drawSpectrum(QPainter& painter);
     void drawLabels(QPainter& painter);
+    void drawTrace(QPainter& painter, const std::vector<float>& values, const QRect& rect,
+                   float minValue, float maxValue);
+    bool showingChannels() const;
+    static QColor channelColor(int channel);
     
-    // Simple FFT implementation
-    void fft(std::vector<std::complex<float>>& data);
-    void bit_reverse(std::vector<std::complex<float>>& data);
-    
-    std::vector<float> m_magnitudeSpectrum;
-    std::vector<float> m_frequencyAxis;
+    SpectrumProcessor m_spectrum;
+    ChannelDisplay m_channelDisplay;
     
-    RawADCFrameTest m_currentFrame;
+    uint32_t m_frameNumber;
+    uint64_t m_frameTimestamp;
+    uint64_t m_paintedTimestamp;
+    uint64_t m_paintTimeNs;
     float m_minFrequency;
     float m_maxFrequency;
-    float m_maxMagnitude;
     
     QRect m_plotRect;
     int m_margin;
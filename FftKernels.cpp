@@ -0,0 +1,29 @@
+#include "FftKernels.h"
+
+// Comma-separated list set by the build (CMake cache RADAR_FIXED_FFT_SIZES)
+#ifndef RADAR_FIXED_FFT_SIZES
+#define RADAR_FIXED_FFT_SIZES 256, 512, 1024
+#endif
+
+namespace {
+
+template <size_t... Sizes>
+bool dispatch(std::complex<float>* data, size_t n)
+{
+    return ((n == Sizes ? (FixedFFT<Sizes>::transform(data), true) : false) || ...);
+}
+
+const size_t SIZES[] = {RADAR_FIXED_FFT_SIZES, 0};
+
+} // namespace
+
+bool fixedSizeFFT(std::complex<float>* data, size_t n)
+{
+    return dispatch<RADAR_FIXED_FFT_SIZES>(data, n);
+}
+
+const size_t* fixedFFTSizes(size_t& count)
+{
+    count = sizeof(SIZES) / sizeof(SIZES[0]) - 1;
+    return SIZES;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Radix-2 FFT kernels specialised for one size at compile time. Twiddles
+// and the bit-reverse swap list are constexpr tables, the first two stages
+// are a multiply-free radix-4 pass and every later stage is instantiated
+// separately with constant trip counts, so the compiler unrolls and
+// vectorises each butterfly loop. Same sign convention and scaling as
+// SpectrumProcessor::fft (forward, unnormalised).
+namespace fftkernels {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series, accurate to double precision on [-pi, pi]
+constexpr double constexprSin(double x)
+{
+    double term = x;
+    double sum = x;
+    for (int k = 1; k < 24; ++k) {
+        term *= -x * x / ((2.0 * k) * (2.0 * k + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x)
+{
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 24; ++k) {
+        term *= -x * x / ((2.0 * k - 1.0) * (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr size_t log2(size_t n)
+{
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+constexpr size_t reverseBits(size_t value, size_t bits)
+{
+    size_t reversed = 0;
+    for (size_t b = 0; b < bits; ++b) {
+        reversed = (reversed << 1) | ((value >> b) & 1);
+    }
+    return reversed;
+}
+
+} // namespace fftkernels
+
+template <size_t N>
+class FixedFFT
+{
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "FixedFFT needs a power of two >= 4");
+    static_assert(N <= 65536, "swap table uses 16-bit indices");
+
+public:
+    static void transform(std::complex<float>* data)
+    {
+        for (const auto& swap : SWAPS) {
+            std::swap(data[swap.first], data[swap.second]);
+        }
+        // std::complex<float> is layout-compatible with float[2]
+        float* values = reinterpret_cast<float*>(data);
+        radix4(values);
+        stage<8>(values);
+    }
+
+private:
+    // Stage with butterfly span `half` uses exp(-2 pi i j / (2 half)),
+    // j < half, stored at [half, 2 half)
+    struct Twiddles {
+        float re[N];
+        float im[N];
+    };
+
+    static constexpr Twiddles makeTwiddles()
+    {
+        Twiddles twiddles{};
+        for (size_t half = 1; half < N; half <<= 1) {
+            for (size_t j = 0; j < half; ++j) {
+                const double angle = -fftkernels::PI * static_cast<double>(j) / static_cast<double>(half);
+                twiddles.re[half + j] = static_cast<float>(fftkernels::constexprCos(angle));
+                twiddles.im[half + j] = static_cast<float>(fftkernels::constexprSin(angle));
+            }
+        }
+        return twiddles;
+    }
+
+    static constexpr size_t swapCount()
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < N; ++i) {
+            if (i < fftkernels::reverseBits(i, fftkernels::log2(N))) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    using SwapList = std::array<std::pair<uint16_t, uint16_t>, swapCount()>;
+
+    static constexpr SwapList makeSwaps()
+    {
+        SwapList swaps{};
+        size_t next = 0;
+        for (size_t i = 0; i < N; ++i) {
+            const size_t j = fftkernels::reverseBits(i, fftkernels::log2(N));
+            if (i < j) {
+                swaps[next].first = static_cast<uint16_t>(i);
+                swaps[next].second = static_cast<uint16_t>(j);
+                ++next;
+            }
+        }
+        return swaps;
+    }
+
+    static constexpr Twiddles TWIDDLES = makeTwiddles();
+    static constexpr SwapList SWAPS = makeSwaps();
+
+    // Stages of length 2 and 4: twiddles are 1 and -i
+    static void radix4(float* d)
+    {
+        for (size_t i = 0; i < 2 * N; i += 8) {
+            const float a0r = d[i] + d[i + 2], a0i = d[i + 1] + d[i + 3];
+            const float a1r = d[i] - d[i + 2], a1i = d[i + 1] - d[i + 3];
+            const float a2r = d[i + 4] + d[i + 6], a2i = d[i + 5] + d[i + 7];
+            const float a3r = d[i + 4] - d[i + 6], a3i = d[i + 5] - d[i + 7];
+            d[i] = a0r + a2r;
+            d[i + 1] = a0i + a2i;
+            d[i + 4] = a0r - a2r;
+            d[i + 5] = a0i - a2i;
+            // -i * a3 = (a3i, -a3r)
+            d[i + 2] = a1r + a3i;
+            d[i + 3] = a1i - a3r;
+            d[i + 6] = a1r - a3i;
+            d[i + 7] = a1i + a3r;
+        }
+    }
+
+    template <size_t Len>
+    static void stage(float* d)
+    {
+        if constexpr (Len <= N) {
+            constexpr size_t half = Len / 2;
+            const float* wr = TWIDDLES.re + half;
+            const float* wi = TWIDDLES.im + half;
+            for (size_t i = 0; i < N; i += Len) {
+                float* a = d + 2 * i;
+                float* b = a + 2 * half;
+                for (size_t j = 0; j < half; ++j) {
+                    const float br = b[2 * j] * wr[j] - b[2 * j + 1] * wi[j];
+                    const float bi = b[2 * j] * wi[j] + b[2 * j + 1] * wr[j];
+                    const float ar = a[2 * j];
+                    const float ai = a[2 * j + 1];
+                    a[2 * j] = ar + br;
+                    a[2 * j + 1] = ai + bi;
+                    b[2 * j] = ar - br;
+                    b[2 * j + 1] = ai - bi;
+                }
+            }
+            stage<Len * 2>(d);
+        }
+    }
+};
+
+// Runs the specialised kernel when n is one of the sizes configured with
+// RADAR_FIXED_FFT_SIZES; false (data untouched) otherwise
+bool fixedSizeFFT(std::complex<float>* data, size_t n);
+// The configured sizes
+const size_t* fixedFFTSizes(size_t& count);
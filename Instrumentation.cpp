@@ -0,0 +1,186 @@
+#include "Instrumentation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+std::atomic<bool> Instrumentation::s_enabled{false};
+
+namespace {
+
+int floorLog2(uint64_t value)
+{
+    int log = 0;
+    while (value >>= 1) {
+        ++log;
+    }
+    return log;
+}
+
+} // namespace
+
+const char* stageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::Receive:     return "receive";
+    case Stage::Parse:       return "parse";
+    case Stage::Playout:     return "playout";
+    case Stage::FFT:         return "fft";
+    case Stage::Detect:      return "detect";
+    case Stage::PaintPPI:    return "paint_ppi";
+    case Stage::PaintFFT:    return "paint_fft";
+    case Stage::TableUpdate: return "table_update";
+    case Stage::EndToEnd:    return "end_to_end";
+    case Stage::Count:       break;
+    }
+    return "unknown";
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS) {
+        return static_cast<size_t>(ns);
+    }
+    const int log = floorLog2(ns);  // >= 3
+    const size_t sub = static_cast<size_t>(ns >> (log - 3)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + static_cast<size_t>(log - 3) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(size_t index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const int shift = static_cast<int>((index - SUB_BUCKETS) / SUB_BUCKETS);
+    const uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    const uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + ((uint64_t(1) << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t ns)
+{
+    m_buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t currentMax = m_max.load(std::memory_order_relaxed);
+    while (ns > currentMax &&
+           !m_max.compare_exchange_weak(currentMax, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<uint64_t>& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    return n ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    const uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    const uint64_t rank = static_cast<uint64_t>(fraction * (n - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketMidpoint(i), max());
+        }
+    }
+    return max();
+}
+
+Instrumentation& Instrumentation::instance()
+{
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+uint64_t Instrumentation::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t Instrumentation::wallClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Instrumentation::record(Stage stage, uint64_t ns)
+{
+    m_histograms[static_cast<size_t>(stage)].record(ns);
+}
+
+void Instrumentation::recordEndToEnd(uint64_t sourceTimestampUs)
+{
+    if (!enabled() || sourceTimestampUs == 0) {
+        return;
+    }
+    const uint64_t now = wallClockUs();
+    // Sender clocks can run ahead of ours; clamp instead of wrapping
+    record(Stage::EndToEnd, now > sourceTimestampUs ? (now - sourceTimestampUs) * 1000 : 0);
+}
+
+void Instrumentation::countDatagram(size_t bytes)
+{
+    if (enabled()) {
+        m_datagrams.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void Instrumentation::countFrame()
+{
+    if (enabled()) {
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Instrumentation::reset()
+{
+    for (LatencyHistogram& histogram : m_histograms) {
+        histogram.reset();
+    }
+    m_datagrams.store(0, std::memory_order_relaxed);
+    m_bytes.store(0, std::memory_order_relaxed);
+    m_frames.store(0, std::memory_order_relaxed);
+}
+
+bool Instrumentation::writeCsv(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    std::fprintf(file, "stage,count,mean_us,p50_us,p99_us,max_us\n");
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+        const LatencyHistogram& h = m_histograms[i];
+        std::fprintf(file, "%s,%llu,%.3f,%.3f,%.3f,%.3f\n", stageName(static_cast<Stage>(i)),
+                     static_cast<unsigned long long>(h.count()), h.mean() / 1e3,
+                     h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3, h.max() / 1e3);
+    }
+    std::fprintf(file, "datagrams,%llu\nbytes,%llu\nframes,%llu\n",
+                 static_cast<unsigned long long>(datagrams()),
+                 static_cast<unsigned long long>(bytes()),
+                 static_cast<unsigned long long>(frames()));
+    return std::fclose(file) == 0;
+}
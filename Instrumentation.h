@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pipeline stages with their own latency histogram
+enum class Stage {
+    Receive,      // reading one datagram from the socket
+    Parse,        // decoding one datagram
+    Playout,      // time a frame waited in the jitter buffer
+    FFT,          // spectrum computation for one frame
+    Detect,       // CFAR detection on one spectrum
+    PaintPPI,     // PPIWidget::paintEvent
+    PaintFFT,     // FFTWidget::paintEvent
+    TableUpdate,  // track table refresh
+    EndToEnd,     // source timestamp -> frame painted
+    Count
+};
+
+const char* stageName(Stage stage);
+
+// Lock-free latency histogram in nanoseconds. Buckets are log-linear
+// (8 linear steps per power of two, ~12% resolution), so recording is a
+// few relaxed atomic increments and percentiles need no stored samples.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t NUM_BUCKETS = SUB_BUCKETS + (64 - 3) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+    double mean() const;
+    // Approximate value below which `fraction` (0..1) of the samples fall
+    uint64_t percentile(double fraction) const;
+
+private:
+    static size_t bucketIndex(uint64_t ns);
+    static uint64_t bucketMidpoint(size_t index);
+
+    std::atomic<uint64_t> m_buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+// Process-wide stage histograms and throughput counters. Everything is
+// gated on enabled(), a single relaxed load, so disabled timers cost a
+// branch and nothing else.
+class Instrumentation
+{
+public:
+    static Instrumentation& instance();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    // Monotonic clock for stage durations
+    static uint64_t nowNs();
+    // Wall clock in microseconds since the Unix epoch, the unit of MessageHeader::timestamp
+    static uint64_t wallClockUs();
+
+    void record(Stage stage, uint64_t ns);
+    // End-to-end latency of a frame stamped with `sourceTimestampUs`; no-op for unstamped frames
+    void recordEndToEnd(uint64_t sourceTimestampUs);
+    void countDatagram(size_t bytes);
+    void countFrame();
+
+    const LatencyHistogram& histogram(Stage stage) const { return m_histograms[static_cast<size_t>(stage)]; }
+    uint64_t datagrams() const { return m_datagrams.load(std::memory_order_relaxed); }
+    uint64_t bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+    uint64_t frames() const { return m_frames.load(std::memory_order_relaxed); }
+
+    void reset();
+    // One row per stage: count, mean, p50, p99, max (microseconds)
+    bool writeCsv(const std::string& path) const;
+
+private:
+    Instrumentation() = default;
+
+    static std::atomic<bool> s_enabled;
+
+    LatencyHistogram m_histograms[static_cast<size_t>(Stage::Count)];
+    std::atomic<uint64_t> m_datagrams{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_frames{0};
+};
+
+// Records the lifetime of the scope into a stage histogram when enabled
+class ScopedStageTimer
+{
+public:
+    explicit ScopedStageTimer(Stage stage)
+        : m_stage(stage)
+        , m_start(Instrumentation::enabled() ? Instrumentation::nowNs() : 0)
+    {
+    }
+
+    ~ScopedStageTimer()
+    {
+        if (m_start) {
+            Instrumentation::instance().record(m_stage, Instrumentation::nowNs() - m_start);
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    Stage m_stage;
+    uint64_t m_start;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "BufferPool.h"
+
+// Clock offset of one sender: the smallest (arrival - timestamp) seen
+// recently, i.e. the transit time of the fastest frame plus any difference
+// between the sender and receiver clocks. The minimum is taken over the
+// current and previous window, so the estimate follows clock drift and
+// route changes.
+class TransitOffset
+{
+public:
+    static constexpr uint32_t WINDOW = 256;
+
+    void clear()
+    {
+        m_offsetUs = NONE;
+        m_windowMinUs = NONE;
+        m_windowCount = 0;
+    }
+
+    void update(int64_t transitUs)
+    {
+        m_windowMinUs = std::min(m_windowMinUs, transitUs);
+        m_offsetUs = std::min(m_offsetUs, transitUs);
+        if (++m_windowCount >= WINDOW) {
+            m_offsetUs = m_windowMinUs;
+            m_windowMinUs = NONE;
+            m_windowCount = 0;
+        }
+    }
+
+    bool valid() const { return m_offsetUs != NONE; }
+    // Local time of a sender timestamp; only meaningful once valid()
+    int64_t offsetUs() const { return m_offsetUs; }
+    int64_t localUs(uint64_t timestamp) const { return static_cast<int64_t>(timestamp) + m_offsetUs; }
+
+private:
+    static constexpr int64_t NONE = std::numeric_limits<int64_t>::max();
+
+    int64_t m_offsetUs = NONE;
+    int64_t m_windowMinUs = NONE;
+    uint32_t m_windowCount = 0;
+};
+
+// Time-ordered playout buffer between decode and display. Frames are kept
+// in a min-heap on their source timestamp and released at
+//     timestamp + clockOffset + delay
+// in local time, where clockOffset is the sender's TransitOffset. Frames that arrive after a newer frame has
+// been released are dropped as late; a full buffer releases its oldest
+// frame early. All times are microseconds on the same clock as the
+// timestamps (Instrumentation::wallClockUs()).
+template <typename Frame>
+class JitterBuffer
+{
+public:
+    using Ref = typename FramePool<Frame>::Ref;
+
+    struct Stats {
+        uint64_t pushed = 0;
+        uint64_t released = 0;
+        uint64_t late = 0;        // dropped: older than a frame already released
+        uint64_t reordered = 0;   // arrived after a newer frame, but in time
+        uint64_t overflowed = 0;  // released early because the buffer was full
+        size_t maxDepth = 0;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit JitterBuffer(size_t capacity = DEFAULT_CAPACITY)
+        : m_capacity(std::max<size_t>(1, capacity))
+    {
+        m_heap.reserve(m_capacity + 1);
+        clear();
+    }
+
+    void setDelayUs(int64_t delayUs) { m_delayUs = std::max<int64_t>(0, delayUs); }
+    int64_t delayUs() const { return m_delayUs; }
+
+    void clear()
+    {
+        m_heap.clear();
+        m_lastReleased = 0;
+        m_newestPushed = 0;
+        m_haveReleased = false;
+        m_offset.clear();
+    }
+
+    void push(Ref frame, int64_t nowUs)
+    {
+        const uint64_t timestamp = frame->timestamp_us;
+        ++m_stats.pushed;
+        if (m_haveReleased && timestamp < m_lastReleased) {
+            ++m_stats.late;
+            return;
+        }
+        if (timestamp < m_newestPushed) {
+            ++m_stats.reordered;
+        }
+        m_newestPushed = std::max(m_newestPushed, timestamp);
+        m_offset.update(nowUs - static_cast<int64_t>(timestamp));
+
+        m_heap.push_back(Entry{timestamp, nowUs, std::move(frame)});
+        std::push_heap(m_heap.begin(), m_heap.end(), Later());
+        m_stats.maxDepth = std::max(m_stats.maxDepth, m_heap.size());
+    }
+
+    // Calls out(Ref&&, int64_t heldUs) for every frame due at nowUs, oldest
+    // first. Frames beyond the capacity are released regardless of time.
+    template <typename Out>
+    void release(int64_t nowUs, Out&& out) { releaseUntil(nowUs, false, out); }
+
+    // Releases everything in timestamp order, e.g. when playout is turned off
+    template <typename Out>
+    void flush(int64_t nowUs, Out&& out) { releaseUntil(nowUs, true, out); }
+
+    // Local time the oldest frame is due, or INT64_MAX when empty
+    int64_t nextReleaseUs() const
+    {
+        if (m_heap.empty()) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        return m_heap.size() > m_capacity ? 0 : playoutTime(m_heap.front().timestamp);
+    }
+
+    size_t depth() const { return m_heap.size(); }
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    struct Entry {
+        uint64_t timestamp;
+        int64_t arrivalUs;
+        Ref frame;
+    };
+
+    // Heap comparator: the smallest timestamp is on top
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const { return a.timestamp > b.timestamp; }
+    };
+
+    template <typename Out>
+    void releaseUntil(int64_t nowUs, bool all, Out& out)
+    {
+        while (!m_heap.empty()) {
+            const bool overflow = m_heap.size() > m_capacity;
+            if (!all && !overflow && playoutTime(m_heap.front().timestamp) > nowUs) {
+                break;
+            }
+            std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+            Entry entry = std::move(m_heap.back());
+            m_heap.pop_back();
+            if (overflow) {
+                ++m_stats.overflowed;
+            }
+            ++m_stats.released;
+            m_lastReleased = entry.timestamp;
+            m_haveReleased = true;
+            out(std::move(entry.frame), std::max<int64_t>(0, nowUs - entry.arrivalUs));
+        }
+    }
+
+    int64_t playoutTime(uint64_t timestamp) const
+    {
+        return m_offset.localUs(timestamp) + m_delayUs;
+    }
+
+    size_t m_capacity;
+    std::vector<Entry> m_heap;
+    int64_t m_delayUs = 0;
+    uint64_t m_lastReleased = 0;
+    uint64_t m_newestPushed = 0;
+    bool m_haveReleased = false;
+    TransitOffset m_offset;
+    Stats m_stats;
+};
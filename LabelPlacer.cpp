@@ -0,0 +1,179 @@
+#include "LabelPlacer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Word mask covering bits [lo, hi] of one 64-cell word
+inline uint64_t spanMask(int lo, int hi)
+{
+    return (~uint64_t(0) << lo) & (~uint64_t(0) >> (63 - hi));
+}
+
+} // namespace
+
+void LabelPlacer::setViewport(int width, int height)
+{
+    m_width = std::max(0, width);
+    m_height = std::max(0, height);
+    m_columns = (m_width + CELL_SIZE - 1) / CELL_SIZE;
+    m_rows = (m_height + CELL_SIZE - 1) / CELL_SIZE;
+    m_wordsPerRow = (static_cast<size_t>(m_columns) + 63) / 64;
+    m_grid.assign(m_wordsPerRow * static_cast<size_t>(m_rows), 0);
+}
+
+void LabelPlacer::setMarker(float radius, float gap)
+{
+    m_markerRadius = std::max(0.0f, radius);
+    m_gap = std::max(0.0f, gap);
+}
+
+bool LabelPlacer::isFree(int x0, int y0, int x1, int y1) const
+{
+    const int w0 = x0 >> 6;
+    const int w1 = x1 >> 6;
+    for (int y = y0; y <= y1; ++y) {
+        const uint64_t* row = m_grid.data() + static_cast<size_t>(y) * m_wordsPerRow;
+        for (int w = w0; w <= w1; ++w) {
+            const int lo = w == w0 ? (x0 & 63) : 0;
+            const int hi = w == w1 ? (x1 & 63) : 63;
+            if (row[w] & spanMask(lo, hi)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool LabelPlacer::isTaken(float x, float y) const
+{
+    if (!(x >= 0.0f && y >= 0.0f && x < m_width && y < m_height)) {
+        return true;
+    }
+    const int column = static_cast<int>(x) / CELL_SIZE;
+    const int row = static_cast<int>(y) / CELL_SIZE;
+    return (m_grid[static_cast<size_t>(row) * m_wordsPerRow + (column >> 6)] >> (column & 63)) & 1;
+}
+
+void LabelPlacer::occupy(int x0, int y0, int x1, int y1)
+{
+    const int w0 = x0 >> 6;
+    const int w1 = x1 >> 6;
+    for (int y = y0; y <= y1; ++y) {
+        uint64_t* row = m_grid.data() + static_cast<size_t>(y) * m_wordsPerRow;
+        for (int w = w0; w <= w1; ++w) {
+            const int lo = w == w0 ? (x0 & 63) : 0;
+            const int hi = w == w1 ? (x1 & 63) : 63;
+            row[w] |= spanMask(lo, hi);
+        }
+    }
+}
+
+void LabelPlacer::place(const std::vector<Label>& labels, std::vector<Placement>& out)
+{
+    out.clear();
+    m_stats = Stats();
+    if (m_columns == 0 || m_rows == 0 || labels.empty()) {
+        m_stats.dropped = labels.size();
+        return;
+    }
+    std::fill(m_grid.begin(), m_grid.end(), 0);
+
+    // Markers only claim cells they cover completely, so a label right next
+    // to its own marker is not rejected by the coarse rounding. Integer
+    // truncation stands in for floor/ceil (a libm call per bound otherwise);
+    // it can only make the reserved area smaller.
+    float minPriority = labels[0].priority;
+    float maxPriority = labels[0].priority;
+    for (const Label& label : labels) {
+        if (label.x < m_markerRadius || label.y < m_markerRadius ||
+            !(label.x < m_width) || !(label.y < m_height)) {
+            minPriority = std::min(minPriority, label.priority);
+            maxPriority = std::max(maxPriority, label.priority);
+            continue;
+        }
+        const int x0 = (static_cast<int>(label.x - m_markerRadius) + CELL_SIZE - 1) / CELL_SIZE;
+        const int y0 = (static_cast<int>(label.y - m_markerRadius) + CELL_SIZE - 1) / CELL_SIZE;
+        const int x1 = std::min(m_columns, static_cast<int>(label.x + m_markerRadius) / CELL_SIZE) - 1;
+        const int y1 = std::min(m_rows, static_cast<int>(label.y + m_markerRadius) / CELL_SIZE) - 1;
+        if (x0 <= x1 && y0 <= y1) {
+            occupy(x0, y0, x1, y1);
+        }
+        minPriority = std::min(minPriority, label.priority);
+        maxPriority = std::max(maxPriority, label.priority);
+    }
+
+    // Counting sort into priority buckets, highest first; input order is
+    // kept within a bucket
+    const float scale = maxPriority > minPriority
+        ? static_cast<float>(PRIORITY_BUCKETS - 1) / (maxPriority - minPriority) : 0.0f;
+    m_buckets.resize(labels.size());
+    m_bucketStart.assign(PRIORITY_BUCKETS + 1, 0);
+    for (size_t i = 0; i < labels.size(); ++i) {
+        const float offset = (labels[i].priority - minPriority) * scale;
+        const int level = offset > 0.0f ? std::min(static_cast<int>(offset), int(PRIORITY_BUCKETS) - 1) : 0;
+        m_buckets[i] = static_cast<uint8_t>(PRIORITY_BUCKETS - 1 - level);
+        ++m_bucketStart[m_buckets[i] + 1];
+    }
+    for (size_t b = 1; b <= PRIORITY_BUCKETS; ++b) {
+        m_bucketStart[b] += m_bucketStart[b - 1];
+    }
+    m_order.resize(labels.size());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        m_order[m_bucketStart[m_buckets[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    // Above right first (the classic position), then the other corners and
+    // finally the sides
+    const float d = m_markerRadius + m_gap;
+    for (uint32_t index : m_order) {
+        const Label& label = labels[index];
+        // Every candidate box touches one of the cells d pixels from the
+        // marker, so when all of them are taken (a saturated area) there is
+        // no need to test the boxes
+        if (isTaken(label.x + d, label.y - d) && isTaken(label.x - d, label.y - d) &&
+            isTaken(label.x + d, label.y + d) && isTaken(label.x - d, label.y + d) &&
+            isTaken(label.x + d, label.y) && isTaken(label.x - d, label.y) &&
+            isTaken(label.x, label.y - d) && isTaken(label.x, label.y + d)) {
+            ++m_stats.dropped;
+            continue;
+        }
+        const float w = label.width;
+        const float h = label.height;
+        const float candidates[8][2] = {
+            {label.x + d, label.y - d - h},
+            {label.x - d - w, label.y - d - h},
+            {label.x + d, label.y + d},
+            {label.x - d - w, label.y + d},
+            {label.x + d, label.y - h / 2},
+            {label.x - d - w, label.y - h / 2},
+            {label.x - w / 2, label.y - d - h},
+            {label.x - w / 2, label.y + d},
+        };
+        bool placed = false;
+        for (const auto& candidate : candidates) {
+            const float left = candidate[0];
+            const float top = candidate[1];
+            // Written so that NaN positions are rejected too
+            if (!(left >= 0.0f && top >= 0.0f && left + w <= m_width && top + h <= m_height)) {
+                continue;
+            }
+            // Every cell the box touches, rounded outwards
+            const int x0 = static_cast<int>(left) / CELL_SIZE;
+            const int y0 = static_cast<int>(top) / CELL_SIZE;
+            const int x1 = std::min(m_columns - 1, static_cast<int>(left + w) / CELL_SIZE);
+            const int y1 = std::min(m_rows - 1, static_cast<int>(top + h) / CELL_SIZE);
+            if (isFree(x0, y0, x1, y1)) {
+                occupy(x0, y0, x1, y1);
+                out.push_back(Placement{left, top, index});
+                placed = true;
+                break;
+            }
+        }
+        if (placed) {
+            ++m_stats.placed;
+        } else {
+            ++m_stats.dropped;
+        }
+    }
+}
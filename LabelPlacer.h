@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Greedy label placement on a coarse screen-space occupancy grid (one bit
+// per CELL_SIZE x CELL_SIZE pixels). Markers are reserved first, then
+// labels are taken in priority order and each gets the first of a few
+// candidate positions around its marker whose cells are still free;
+// labels that fit nowhere are dropped. Priorities are bucketed instead of
+// sorted, so a pass is O(N) in the number of labels.
+class LabelPlacer
+{
+public:
+    static constexpr int CELL_SIZE = 4;
+    static constexpr size_t PRIORITY_BUCKETS = 64;
+
+    struct Label {
+        float x;          // marker centre in pixels
+        float y;
+        float width;      // text box in pixels
+        float height;
+        float priority;   // higher is placed first
+    };
+
+    struct Placement {
+        float left;       // text box top-left in pixels
+        float top;
+        uint32_t label;   // index into the labels passed to place()
+    };
+
+    struct Stats {
+        size_t placed = 0;
+        size_t dropped = 0;
+    };
+
+    // Labels must lie inside [0, width) x [0, height)
+    void setViewport(int width, int height);
+    // Pixels from the marker centre to the edge of its reserved area;
+    // labels keep `gap` pixels beyond that
+    void setMarker(float radius, float gap);
+
+    void place(const std::vector<Label>& labels, std::vector<Placement>& out);
+    const Stats& stats() const { return m_stats; }
+
+private:
+    bool isFree(int x0, int y0, int x1, int y1) const;
+    bool isTaken(float x, float y) const;  // pixel outside the viewport or its cell occupied
+    void occupy(int x0, int y0, int x1, int y1);
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_columns = 0;          // grid size in cells
+    int m_rows = 0;
+    size_t m_wordsPerRow = 0;
+    float m_markerRadius = 5.0f;
+    float m_gap = 3.0f;
+    std::vector<uint64_t> m_grid;      // row-major occupancy bits
+    std::vector<uint32_t> m_order;     // label indices, highest bucket first
+    std::vector<uint32_t> m_bucketStart;
+    std::vector<uint8_t> m_buckets;    // bucket per label
+    Stats m_stats;
+};
@@ -1,31 +1,47 @@
 #include "MainWindow.h"
 #include <QApplication>
 #include <QNetworkDatagram>
-#include <QHeaderView>
 #include <QMessageBox>
 #include <QGridLayout>
-#include <cmath>
+#include <QFileDialog>
+#include <QGuiApplication>
+#include <QRegularExpression>
+#include <QScreen>
+#include <QDateTime>
+#include <algorithm>
+#include <limits>
+#include "AllocationCounter.h"
+#include "Instrumentation.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_ppiWidget(nullptr)
     , m_fftWidget(nullptr)
     , m_trackTable(nullptr)
-    , m_udpSocket(nullptr)
-    , m_updateTimer(nullptr)
+    , m_statsOverlay(nullptr)
+    , m_adcSource(0)
+    , m_refreshScheduler(nullptr)
+    , m_tableRefreshes(0)
+    , m_spectrumRefreshes(0)
+    , m_tableStale(false)
+    , m_adcDecimation(0)
+    , m_rawFrameReceived(false)
+    , m_tracksUpdated(false)
+    , m_jitterDelayUs(0)
+    , m_playoutTimer(nullptr)
+    , m_playback(false)
+    , m_archivePositionUs(0)
     , m_simulationEnabled(true)
-    , m_randomEngine(std::random_device{}())
-    , m_rangeDist(100.0f, 500.0f)  // 1-15 km
-    , m_azimuthDist(-90.0f, 90.0f)    // -90 to +90 degrees
-    , m_speedDist(-50.0f, 50.0f)      // -50 to +50 m/s
-    , m_levelDist(10.0f, 100.0f)      // 10-100 dB
-    , m_numTargetsDist(3, 8)          // 3-8 targets
     , m_frameCount(0)
-    , m_targetCount(0)
+    , m_refreshCount(0)
+    , m_sourceStatsTimer(nullptr)
 {
+    m_currentADCFrame = m_framePools.adcFrames.acquire();
+    m_currentRawFrame = m_framePools.rawFrames.acquire();
+
     setupUI();
+    setupRefresh();
     setupNetworking();
-    setupTimer();
     
     // Initialize with simulated data
     //generateSimulatedTargetData();
@@ -34,9 +50,8 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    if (m_updateTimer) {
-        m_updateTimer->stop();
-    }
+    // Receiver threads use m_framePools, which is destroyed with this window
+    stopSources();
 }
 
 void MainWindow::setupUI()
@@ -58,6 +73,11 @@ void MainWindow::setupUI()
     m_ppiWidget = new PPIWidget();
     ppiLayout->addWidget(m_ppiWidget);
     
+    // Stats overlay floats in the top-left corner of the PPI
+    m_statsOverlay = new StatsOverlay(m_ppiWidget);
+    m_statsOverlay->move(8, 8);
+    m_statsOverlay->hide();
+    
     // PPI controls
     QHBoxLayout* ppiControlsLayout = new QHBoxLayout();
     ppiControlsLayout->addWidget(new QLabel("Max Range (m):"));
@@ -69,6 +89,57 @@ void MainWindow::setupUI()
             this, &MainWindow::onRangeChanged);
     ppiControlsLayout->addWidget(m_rangeSpinBox);
     
+    m_trailsCheckBox = new QCheckBox("Trails");
+    m_trailsCheckBox->setChecked(true);
+    connect(m_trailsCheckBox, &QCheckBox::toggled,
+            this, &MainWindow::onTrailsToggled);
+    ppiControlsLayout->addWidget(m_trailsCheckBox);
+    
+    m_trailLengthSpinBox = new QSpinBox();
+    m_trailLengthSpinBox->setRange(2, 128);
+    m_trailLengthSpinBox->setValue(static_cast<int>(TrackHistory::DEFAULT_TRAIL_LENGTH));
+    m_trailLengthSpinBox->setSuffix(" pts");
+    connect(m_trailLengthSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onTrailLengthChanged);
+    ppiControlsLayout->addWidget(m_trailLengthSpinBox);
+    
+    m_persistenceCheckBox = new QCheckBox("Persistence");
+    connect(m_persistenceCheckBox, &QCheckBox::toggled,
+            this, &MainWindow::onPersistenceToggled);
+    ppiControlsLayout->addWidget(m_persistenceCheckBox);
+    
+    m_halfLifeSpinBox = new QSpinBox();
+    m_halfLifeSpinBox->setRange(1, 100);
+    m_halfLifeSpinBox->setValue(8);
+    m_halfLifeSpinBox->setPrefix("half-life ");
+    m_halfLifeSpinBox->setSuffix(" frames");
+    m_halfLifeSpinBox->setEnabled(false);
+    connect(m_halfLifeSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onPersistenceHalfLifeChanged);
+    ppiControlsLayout->addWidget(m_halfLifeSpinBox);
+    
+    m_heatmapCheckBox = new QCheckBox("Heatmap");
+    m_heatmapCheckBox->setToolTip("Range-azimuth power of binary ADC frames");
+    connect(m_heatmapCheckBox, &QCheckBox::toggled,
+            this, &MainWindow::onHeatmapToggled);
+    ppiControlsLayout->addWidget(m_heatmapCheckBox);
+    
+    ppiControlsLayout->addWidget(new QLabel("Labels:"));
+    m_labelModeCombo = new QComboBox();
+    m_labelModeCombo->addItem("By level", static_cast<int>(PPIWidget::LabelMode::ByLevel));
+    m_labelModeCombo->addItem("By speed", static_cast<int>(PPIWidget::LabelMode::BySpeed));
+    m_labelModeCombo->addItem("All", static_cast<int>(PPIWidget::LabelMode::All));
+    m_labelModeCombo->addItem("Off", static_cast<int>(PPIWidget::LabelMode::Off));
+    m_labelModeCombo->setToolTip("Which target IDs get a label when they would overlap");
+    connect(m_labelModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onLabelModeChanged);
+    ppiControlsLayout->addWidget(m_labelModeCombo);
+    
+    QPushButton* resetViewButton = new QPushButton("Reset view");
+    resetViewButton->setToolTip("Wheel zooms, drag pans, double-click resets");
+    connect(resetViewButton, &QPushButton::clicked, m_ppiWidget, &PPIWidget::resetView);
+    ppiControlsLayout->addWidget(resetViewButton);
+    
     ppiControlsLayout->addStretch();
     ppiLayout->addLayout(ppiControlsLayout);
     
@@ -84,21 +155,43 @@ void MainWindow::setupUI()
     m_fftWidget = new FFTWidget();
     fftLayout->addWidget(m_fftWidget);
     
+    // FFT controls
+    QHBoxLayout* fftControlsLayout = new QHBoxLayout();
+    fftControlsLayout->addWidget(new QLabel("RX Channels:"));
+    m_channelDisplayCombo = new QComboBox();
+    m_channelDisplayCombo->addItem("Single", static_cast<int>(FFTWidget::ChannelDisplay::Single));
+    m_channelDisplayCombo->addItem("Overlay", static_cast<int>(FFTWidget::ChannelDisplay::Overlay));
+    m_channelDisplayCombo->addItem("Tiled", static_cast<int>(FFTWidget::ChannelDisplay::Tiled));
+    m_channelDisplayCombo->addItem("Phase", static_cast<int>(FFTWidget::ChannelDisplay::Phase));
+    m_channelDisplayCombo->addItem("Coherence", static_cast<int>(FFTWidget::ChannelDisplay::Coherence));
+    connect(m_channelDisplayCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onChannelDisplayChanged);
+    fftControlsLayout->addWidget(m_channelDisplayCombo);
+
+    fftControlsLayout->addWidget(new QLabel("MTI:"));
+    m_mtiCombo = new QComboBox();
+    m_mtiCombo->addItem("Off", static_cast<int>(SpectrumProcessor::MtiMode::Off));
+    m_mtiCombo->addItem("2-pulse", static_cast<int>(SpectrumProcessor::MtiMode::TwoPulse));
+    m_mtiCombo->addItem("3-pulse", static_cast<int>(SpectrumProcessor::MtiMode::ThreePulse));
+    connect(m_mtiCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onMtiModeChanged);
+    fftControlsLayout->addWidget(m_mtiCombo);
+
+    m_clutterMapCheckBox = new QCheckBox("Clutter map");
+    m_clutterMapCheckBox->setToolTip("Subtract a running per-bin background estimate");
+    connect(m_clutterMapCheckBox, &QCheckBox::toggled, this, &MainWindow::onClutterMapToggled);
+    fftControlsLayout->addWidget(m_clutterMapCheckBox);
+    
+    fftControlsLayout->addStretch();
+    fftLayout->addLayout(fftControlsLayout);
+    
     m_rightSplitter->addWidget(fftGroup);
     
     // Track Table
     QGroupBox* tableGroup = new QGroupBox("Target Track Table");
     QVBoxLayout* tableLayout = new QVBoxLayout(tableGroup);
     
-    m_trackTable = new QTableWidget();
-    m_trackTable->setColumnCount(4);
-    QStringList headers;
-    headers << "ID" << "Range (m)" << "Azimuth (°)"
-            << "Radial Speed (m/s)";
-    m_trackTable->setHorizontalHeaderLabels(headers);
-    m_trackTable->horizontalHeader()->setStretchLastSection(true);
-    m_trackTable->setAlternatingRowColors(true);
-    m_trackTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_trackTable = new TrackTableWidget();
     
     tableLayout->addWidget(m_trackTable);
     m_rightSplitter->addWidget(tableGroup);
@@ -122,6 +215,62 @@ void MainWindow::setupUI()
             this, &MainWindow::onSimulateDataToggled);
     controlLayout->addWidget(m_simulateButton);
     
+    m_statsCheckBox = new QCheckBox("Show Stats");
+    connect(m_statsCheckBox, &QCheckBox::toggled,
+            this, &MainWindow::onStatsOverlayToggled);
+    controlLayout->addWidget(m_statsCheckBox);
+    
+    m_exportStatsButton = new QPushButton("Export Stats...");
+    m_exportStatsButton->setEnabled(false);
+    connect(m_exportStatsButton, &QPushButton::clicked,
+            this, &MainWindow::onExportStats);
+    controlLayout->addWidget(m_exportStatsButton);
+    
+    controlLayout->addWidget(new QLabel("Max FPS:"));
+    m_maxFpsSpinBox = new QSpinBox();
+    m_maxFpsSpinBox->setRange(0, 240);
+    m_maxFpsSpinBox->setSpecialValueText("Display");
+    m_maxFpsSpinBox->setValue(0);
+    connect(m_maxFpsSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onMaxFpsChanged);
+    controlLayout->addWidget(m_maxFpsSpinBox);
+    
+    m_autoDegradeCheckBox = new QCheckBox("Auto degrade");
+    m_autoDegradeCheckBox->setToolTip("Shed display detail while refreshes cost more than the budget, "
+                                      "restore it when the load drops");
+    connect(m_autoDegradeCheckBox, &QCheckBox::toggled, this, &MainWindow::onAutoDegradeToggled);
+    controlLayout->addWidget(m_autoDegradeCheckBox);
+    
+    m_frameBudgetSpinBox = new QSpinBox();
+    m_frameBudgetSpinBox->setRange(1, 100);
+    m_frameBudgetSpinBox->setSuffix(" ms");
+    m_frameBudgetSpinBox->setValue(static_cast<int>(DegradationController::DEFAULT_BUDGET_MS));
+    m_frameBudgetSpinBox->setToolTip("GUI thread time per refresh the display may use");
+    connect(m_frameBudgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onFrameBudgetChanged);
+    controlLayout->addWidget(m_frameBudgetSpinBox);
+    
+    controlLayout->addWidget(new QLabel("Between refreshes:"));
+    m_framePolicyCombo = new QComboBox();
+    m_framePolicyCombo->addItem("Show latest", static_cast<int>(RefreshScheduler::FramePolicy::Latest));
+    m_framePolicyCombo->addItem("Aggregate", static_cast<int>(RefreshScheduler::FramePolicy::Aggregate));
+    connect(m_framePolicyCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onFramePolicyChanged);
+    controlLayout->addWidget(m_framePolicyCombo);
+    
+    controlLayout->addWidget(new QLabel("Jitter buffer:"));
+    m_jitterDelaySpinBox = new QSpinBox();
+    m_jitterDelaySpinBox->setRange(0, 500);
+    m_jitterDelaySpinBox->setSingleStep(10);
+    m_jitterDelaySpinBox->setSuffix(" ms");
+    m_jitterDelaySpinBox->setSpecialValueText("Off");
+    m_jitterDelaySpinBox->setValue(0);
+    m_jitterDelaySpinBox->setToolTip("Playout delay on top of the fastest observed transit time; "
+                                     "frames are shown in source-timestamp order");
+    connect(m_jitterDelaySpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onJitterDelayChanged);
+    controlLayout->addWidget(m_jitterDelaySpinBox);
+    
     controlLayout->addStretch();
     
     m_frameCountLabel = new QLabel("Frames: 0");
@@ -131,34 +280,159 @@ void MainWindow::setupUI()
     controlLayout->addWidget(m_statusLabel);
     
     mainLayout->addLayout(controlLayout);
+    
+    // Sources: one UDP port per radar
+    QHBoxLayout* sourcesLayout = new QHBoxLayout();
+    sourcesLayout->addWidget(new QLabel("UDP ports:"));
+    m_portsEdit = new QLineEdit(QString::number(DEFAULT_UDP_PORT));
+    m_portsEdit->setToolTip("Comma-separated list, one receive thread per port");
+    connect(m_portsEdit, &QLineEdit::returnPressed, this, &MainWindow::onApplyPorts);
+    sourcesLayout->addWidget(m_portsEdit);
+    
+    QPushButton* applyPortsButton = new QPushButton("Apply");
+    connect(applyPortsButton, &QPushButton::clicked, this, &MainWindow::onApplyPorts);
+    sourcesLayout->addWidget(applyPortsButton);
+    
+    sourcesLayout->addWidget(new QLabel("ADC source:"));
+    m_adcSourceCombo = new QComboBox();
+    connect(m_adcSourceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onADCSourceChanged);
+    sourcesLayout->addWidget(m_adcSourceCombo);
+    
+    sourcesLayout->addStretch();
+    m_sourceStatsLabel = new QLabel();
+    sourcesLayout->addWidget(m_sourceStatsLabel);
+    mainLayout->addLayout(sourcesLayout);
+    
+    // Archive: record to disk and scrub back through it
+    QHBoxLayout* archiveLayout = new QHBoxLayout();
+    m_recordButton = new QPushButton("Record...");
+    m_recordButton->setCheckable(true);
+    connect(m_recordButton, &QPushButton::toggled, this, &MainWindow::onRecordToggled);
+    archiveLayout->addWidget(m_recordButton);
+    
+    QPushButton* openArchiveButton = new QPushButton("Open Archive...");
+    connect(openArchiveButton, &QPushButton::clicked, this, &MainWindow::onOpenArchive);
+    archiveLayout->addWidget(openArchiveButton);
+    
+    m_timelineSlider = new QSlider(Qt::Horizontal);
+    m_timelineSlider->setRange(0, 0);
+    m_timelineSlider->setEnabled(false);
+    connect(m_timelineSlider, &QSlider::valueChanged, this, &MainWindow::onTimelineMoved);
+    archiveLayout->addWidget(m_timelineSlider, 1);
+    
+    m_timelineLabel = new QLabel("No archive");
+    archiveLayout->addWidget(m_timelineLabel);
+    
+    m_liveButton = new QPushButton("Live");
+    m_liveButton->setEnabled(false);
+    connect(m_liveButton, &QPushButton::clicked, this, &MainWindow::onGoLive);
+    archiveLayout->addWidget(m_liveButton);
+    
+    m_publishCheckBox = new QCheckBox("Publish to shm");
+    m_publishCheckBox->setToolTip(QString("Share decoded tracks and spectra with local processes "
+                                          "through the shared-memory ring \"%1\"").arg(SHARED_RING_NAME));
+    connect(m_publishCheckBox, &QCheckBox::toggled, this, &MainWindow::onPublishToggled);
+    archiveLayout->addWidget(m_publishCheckBox);
+    mainLayout->addLayout(archiveLayout);
+    
     mainLayout->addWidget(m_mainSplitter);
     
     // Status bar
-    statusBar()->showMessage("Radar Visualization Ready - Listening on UDP port 5000");
+    m_degradationLabel = new QLabel();
+    statusBar()->addPermanentWidget(m_degradationLabel);
+    updateDegradationLabel();
+    statusBar()->showMessage("Radar Visualization Ready");
 }
 
 void MainWindow::setupNetworking()
 {
-    m_udpSocket = new QUdpSocket(this);
+    m_sourceStatsTimer = new QTimer(this);
+    connect(m_sourceStatsTimer, &QTimer::timeout, this, &MainWindow::updateSourceStatsLabel);
+    connect(m_sourceStatsTimer, &QTimer::timeout, this, &MainWindow::updateTimeline);
+    connect(m_sourceStatsTimer, &QTimer::timeout, this, &MainWindow::updateDegradationLabel);
+    m_sourceStatsTimer->start(1000);
     
-    if (!m_udpSocket->bind(QHostAddress::Any, UDP_PORT)) {
-        QMessageBox::warning(this, "Network Error",
-                           QString("Failed to bind to UDP port %1. "
-                                  "Real data reception disabled.").arg(UDP_PORT));
-        m_statusLabel->setText("Status: Network Error - Simulation Only");
-    } else {
-        connect(m_udpSocket, &QUdpSocket::readyRead,
-                this, &MainWindow::readPendingDatagrams);
-        m_statusLabel->setText("Status: UDP Listening");
+    m_playoutTimer = new QTimer(this);
+    m_playoutTimer->setSingleShot(true);
+    m_playoutTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_playoutTimer, &QTimer::timeout, this, &MainWindow::releasePlayout);
+    
+    onApplyPorts();
+}
+
+void MainWindow::startSources(const std::vector<quint16>& ports)
+{
+    m_trackMerger.setSourceCount(ports.size());
+    m_sourceFramesAtLastStats.assign(ports.size(), 0);
+    m_sourceBytesAtLastStats.assign(ports.size(), 0);
+    m_trackDecimation.assign(ports.size(), 0);
+    m_sourceStatsClock.start();
+    m_playout.resize(ports.size());
+    for (SourcePlayout& playout : m_playout) {
+        playout.tracks.setDelayUs(m_jitterDelayUs);
+        playout.adcFrames.setDelayUs(m_jitterDelayUs);
+        playout.rawFrames.setDelayUs(m_jitterDelayUs);
+    }
+    
+    m_adcSourceCombo->blockSignals(true);
+    m_adcSourceCombo->clear();
+    for (quint16 port : ports) {
+        m_adcSourceCombo->addItem(QString::number(port));
+    }
+    m_adcSourceCombo->blockSignals(false);
+    m_adcSource = 0;
+    
+    // Each receiver lives on its own thread, so decode throughput scales
+    // with cores as sources are added
+    for (size_t i = 0; i < ports.size(); ++i) {
+        QThread* thread = new QThread(this);
+        thread->setObjectName(QString("udp-%1").arg(ports[i]));
+        SourceReceiver* receiver = new SourceReceiver(static_cast<int>(i), ports[i], m_framePools);
+        receiver->moveToThread(thread);
+        connect(thread, &QThread::started, receiver, &SourceReceiver::start);
+        connect(thread, &QThread::finished, receiver, &QObject::deleteLater);
+        connect(receiver, &SourceReceiver::framesReady, this, &MainWindow::onFramesReady);
+        connect(receiver, &SourceReceiver::bindFailed, this, &MainWindow::onSourceBindFailed);
+        m_sources.push_back(receiver);
+        m_sourceThreads.push_back(thread);
+        thread->start();
+    }
+    
+    QStringList portList;
+    for (quint16 port : ports) {
+        portList << QString::number(port);
+    }
+    m_statusLabel->setText(QString("Status: UDP Listening (%1)").arg(portList.join(", ")));
+    statusBar()->showMessage(QString("Listening on UDP port(s) %1").arg(portList.join(", ")));
+}
+
+void MainWindow::stopSources()
+{
+    for (QThread* thread : m_sourceThreads) {
+        thread->quit();
+    }
+    for (QThread* thread : m_sourceThreads) {
+        thread->wait();
+        delete thread;
+    }
+    m_sourceThreads.clear();
+    m_sources.clear();
+    m_collectedFrames.clear();
+    m_playout.clear();
+    if (m_playoutTimer) {
+        m_playoutTimer->stop();
     }
 }
 
-void MainWindow::setupTimer()
+void MainWindow::setupRefresh()
 {
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout,
+    m_refreshScheduler = new RefreshScheduler(this);
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        m_refreshScheduler->setDisplayRefreshRate(screen->refreshRate());
+    }
+    connect(m_refreshScheduler, &RefreshScheduler::refresh,
             this, &MainWindow::updateDisplay);
-    m_updateTimer->start(UPDATE_INTERVAL_MS);
 }
 
 void MainWindow::updateDisplay()
@@ -168,14 +442,102 @@ void MainWindow::updateDisplay()
         //generateSimulatedADCData();
     }
     
-    // Update widgets
-    m_ppiWidget->updateTargets(m_currentTargets);
-    m_fftWidget->updateData(m_currentADCFrame);
-    updateTrackTable();
+    // While scrubbing the widgets show the archive; live frames are only recorded
+    if (m_playback) {
+        if (m_archiveWriter.isOpen() || m_publisher.isOpen()) {
+            if (!m_pendingRawFrames.empty()) {
+                const RawADCFrame& frame = *m_pendingRawFrames.back();
+                if (m_exportSpectrum.process(frame)) {
+                    exportSpectrum(m_exportSpectrum, frame.frame_number, frame.timestamp_us);
+                }
+            } else if (!m_pendingADCFrames.empty()) {
+                const RawADCFrameTest& frame = *m_pendingADCFrames.back();
+                m_exportSpectrum.process(frame.sample_data);
+                exportSpectrum(m_exportSpectrum, frame.msgId, frame.timestamp_us);
+            }
+        }
+        m_pendingRawFrames.clear();
+        m_pendingADCFrames.clear();
+        m_tracksUpdated = false;
+        return;
+    }
+    
+    // The previous refresh is complete once the paints it caused are in
+    m_degradation.record(Stage::PaintPPI, m_ppiWidget->takePaintTimeNs());
+    m_degradation.record(Stage::PaintFFT, m_fftWidget->takePaintTimeNs());
+    if (m_degradation.endRefresh()) {
+        applyDegradation();
+    }
+    const DegradationController::Settings& detail = m_degradation.settings();
+    
+    // Only widgets with new data are touched
+    if (m_tracksUpdated) {
+        const uint64_t start = Instrumentation::nowNs();
+        const bool aggregate =
+            m_refreshScheduler->framePolicy() == RefreshScheduler::FramePolicy::Aggregate;
+        m_trackMerger.merge(Instrumentation::wallClockUs(), m_currentTargets, aggregate);
+        m_ppiWidget->updateTargets(m_currentTargets);
+        m_degradation.record(Stage::PaintPPI, Instrumentation::nowNs() - start);
+        m_tracksUpdated = false;
+        m_tableStale = true;
+    }
+    
+    // Skipped work stays pending; another refresh is asked for so it is
+    // not held back until more data arrives
+    if (m_tableStale) {
+        if (++m_tableRefreshes >= detail.tableInterval) {
+            const uint64_t start = Instrumentation::nowNs();
+            updateTrackTable();
+            m_degradation.record(Stage::TableUpdate, Instrumentation::nowNs() - start);
+            m_tableRefreshes = 0;
+            m_tableStale = false;
+        } else {
+            m_refreshScheduler->markDirty();
+        }
+    }
+    
+    const bool spectrumPending = !m_pendingRawFrames.empty() || !m_pendingADCFrames.empty();
+    if (spectrumPending && ++m_spectrumRefreshes < detail.spectrumInterval) {
+        m_refreshScheduler->markDirty();
+    } else if (!m_pendingRawFrames.empty()) {
+        m_spectrumRefreshes = 0;
+        const uint64_t start = Instrumentation::nowNs();
+        if (detail.spectrumAverage) {
+            m_pendingRawPointers.clear();
+            for (const FramePool<RawADCFrame>::Ref& frame : m_pendingRawFrames) {
+                m_pendingRawPointers.push_back(frame.get());
+            }
+            m_fftWidget->updateData(m_pendingRawPointers);
+        } else {
+            m_fftWidget->updateData(*m_pendingRawFrames.back());
+        }
+        m_ppiWidget->updateRawFrame(*m_pendingRawFrames.back());
+        m_degradation.record(Stage::FFT, Instrumentation::nowNs() - start);
+        m_currentRawFrame = std::move(m_pendingRawFrames.back());
+        m_pendingRawFrames.clear();
+        m_rawFrameReceived = true;
+        exportSpectrum(m_fftWidget->spectrum(), m_fftWidget->frameNumber(), m_fftWidget->frameTimestamp());
+    } else if (!m_pendingADCFrames.empty()) {
+        m_spectrumRefreshes = 0;
+        const uint64_t start = Instrumentation::nowNs();
+        if (detail.spectrumAverage) {
+            m_pendingADCPointers.clear();
+            for (const FramePool<RawADCFrameTest>::Ref& frame : m_pendingADCFrames) {
+                m_pendingADCPointers.push_back(frame.get());
+            }
+            m_fftWidget->updateData(m_pendingADCPointers);
+        } else {
+            m_fftWidget->updateData(*m_pendingADCFrames.back());
+        }
+        m_degradation.record(Stage::FFT, Instrumentation::nowNs() - start);
+        m_currentADCFrame = std::move(m_pendingADCFrames.back());
+        m_pendingADCFrames.clear();
+        m_rawFrameReceived = false;
+        exportSpectrum(m_fftWidget->spectrum(), m_fftWidget->frameNumber(), m_fftWidget->frameTimestamp());
+    }
     
-    // Update statistics
-    m_frameCount++;
-    m_frameCountLabel->setText(QString("Frames: %1").arg(m_frameCount));
+    ++m_refreshCount;
+    updateFrameCountLabel();
     
     if (m_simulationEnabled) {
         m_statusLabel->setText(QString("Status: Simulation Active - %1 targets")
@@ -183,96 +545,187 @@ void MainWindow::updateDisplay()
     }
 }
 
-void MainWindow::readPendingDatagrams() {
-    while (m_udpSocket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(m_udpSocket->pendingDatagramSize());
-        m_udpSocket->readDatagram(datagram.data(), datagram.size());
-        qDebug()<<"r";
-        QString msg = QString::fromUtf8(datagram);
-        if (msg.contains("NumTargets:")) {
-            parseTrackMessage(msg);  // Track data if present
-        }else
-        {
-            qDebug()<<"No track";
+void MainWindow::updateFrameCountLabel()
+{
+    QString text = QString("Frames: %1 | Refreshes: %2").arg(m_frameCount).arg(m_refreshCount);
+    if (AllocationCounter::enabled() && m_adcSource < static_cast<int>(m_sources.size())) {
+        text += QString(" | Decode allocs: %1")
+                    .arg(m_sources[m_adcSource]->stats().lastDecodeAllocations.load());
+    }
+    m_frameCountLabel->setText(text);
+}
+
+void MainWindow::updateSourceStatsLabel()
+{
+    const double seconds = m_sourceStatsClock.isValid() ? m_sourceStatsClock.restart() / 1000.0 : 0.0;
+    QStringList parts;
+    for (size_t i = 0; i < m_sources.size(); ++i) {
+        const SourceReceiver::Stats& stats = m_sources[i]->stats();
+        const uint64_t frames = stats.frames.load();
+        const uint64_t bytes = stats.bytes.load();
+        const double fps = seconds > 0 ? (frames - m_sourceFramesAtLastStats[i]) / seconds : 0.0;
+        const double kbps = seconds > 0 ? (bytes - m_sourceBytesAtLastStats[i]) / 1024.0 / seconds : 0.0;
+        m_sourceFramesAtLastStats[i] = frames;
+        m_sourceBytesAtLastStats[i] = bytes;
+        
+        QString part = QString("%1: %2 fps, %3 kB/s")
+                           .arg(m_sources[i]->port())
+                           .arg(fps, 0, 'f', 1)
+                           .arg(kbps, 0, 'f', 0);
+        const uint64_t errors = stats.decodeErrors.load();
+        const uint64_t dropped = stats.droppedFrames.load();
+        if (errors || dropped) {
+            part += QString(" (%1 bad, %2 dropped)").arg(errors).arg(dropped);
         }
-        if (msg.contains("ADC:")) {
-            parseADCMessage(msg);  // Raw FFT data
+        if (const uint64_t truncated = m_trackMerger.truncatedIds(i)) {
+            part += QString(" (%1 ids truncated)").arg(truncated);
         }
+        if (m_jitterDelayUs > 0 && i < m_playout.size()) {
+            const SourcePlayout& playout = m_playout[i];
+            const auto& t = playout.tracks.stats();
+            const auto& a = playout.adcFrames.stats();
+            const auto& r = playout.rawFrames.stats();
+            part += QString(" [buffered %1, reordered %2, late %3]")
+                        .arg(playout.tracks.depth() + playout.adcFrames.depth() + playout.rawFrames.depth())
+                        .arg(t.reordered + a.reordered + r.reordered)
+                        .arg(t.late + a.late + r.late);
+        }
+        parts << part;
+    }
+    if (m_sources.size() > 1) {
+        parts << QString("skew %1 ms").arg(m_trackMerger.skewUs() / 1000.0, 0, 'f', 1);
     }
+    m_sourceStatsLabel->setText(parts.join(" | "));
 }
 
-void MainWindow::parseTrackMessage(const QString& message) {
-                qDebug()<<"track";
-                QStringList tokens = message.split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
-                m_currentTargets.targets.clear();
-                m_currentTargets.numTracks = 0;
-
-                TargetTrack target;
-                int numTargets = 0;
-                int parsedTargets = 0;
-
-                for (int i = 0; i < tokens.size(); ++i) {
-                    const QString& token = tokens[i];
-
-                    if (token == "NumTargets:" && i + 1 < tokens.size()) {
-                        numTargets = tokens[++i].toInt();
-                    } else if (token == "TgtId:" && i + 1 < tokens.size()) {
-                        if (parsedTargets > 0) {
-                            m_currentTargets.targets.push_back(target);
-                            target = TargetTrack(); // Reset
-                        }
-                        target.target_id = tokens[++i].toInt();
-                        ++parsedTargets;
-                    } else if (token == "Level:" && i + 1 < tokens.size()) {
-                        target.level = tokens[++i].toFloat();
-                    } else if (token == "Range:" && i + 1 < tokens.size()) {
-                        target.radius = tokens[++i].toFloat();
-                    } else if (token == "Azimuth:" && i + 1 < tokens.size()) {
-                        target.azimuth = tokens[++i].toFloat();
-                    } else if (token == "Elevation:" && i + 1 < tokens.size()) {
-                        target.elevation = tokens[++i].toFloat();
-                    } else if (token == "RadialSpeed:" && i + 1 < tokens.size()) {
-                        target.radial_speed = tokens[++i].toFloat();
-                    } else if (token == "AzimuthSpeed:" && i + 1 < tokens.size()) {
-                        target.azimuth_speed = tokens[++i].toFloat();
-                    } else if (token == "ElevationSpeed:" && i + 1 < tokens.size()) {
-                        target.elevation_speed = tokens[++i].toFloat();
-                    }
-                }
-
-                // Append final target if one exists
-                if (parsedTargets > 0) {
-                    m_currentTargets.targets.push_back(target);
-                }
-
-                m_currentTargets.numTracks = m_currentTargets.targets.size();
-
+void MainWindow::onFramesReady(int source)
+{
+    // Notifications queued by receivers of a previous port list are stale
+    if (source < 0 || source >= static_cast<int>(m_sources.size())) {
+        return;
+    }
+    m_sources[source]->takeFrames(m_collectedFrames);
+    m_frameCount += m_collectedFrames.tracks.size() + m_collectedFrames.adcFrames.size() +
+                    m_collectedFrames.rawFrames.size();
+    
+    // Recorded in arrival order, ahead of any playout delay
+    if (m_archiveWriter.isOpen()) {
+        for (const FramePool<TargetTrackData>::Ref& tracks : m_collectedFrames.tracks) {
+            m_archiveWriter.writeTracks(source, *tracks, tracks->received_us);
+        }
+    }
+    
+    if (m_jitterDelayUs == 0) {
+        deliverFrames(source, m_collectedFrames);
+        return;
+    }
+    
+    const int64_t now = static_cast<int64_t>(Instrumentation::wallClockUs());
+    SourcePlayout& playout = m_playout[source];
+    for (FramePool<TargetTrackData>::Ref& tracks : m_collectedFrames.tracks) {
+        playout.tracks.push(std::move(tracks), now);
+    }
+    for (FramePool<RawADCFrameTest>::Ref& frame : m_collectedFrames.adcFrames) {
+        playout.adcFrames.push(std::move(frame), now);
+    }
+    for (FramePool<RawADCFrame>::Ref& frame : m_collectedFrames.rawFrames) {
+        playout.rawFrames.push(std::move(frame), now);
+    }
+    m_collectedFrames.clear();
+    releasePlayout();
 }
 
-void MainWindow::parseADCMessage(const QString& message) {
-    QStringList tokens = message.split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
-    qDebug()<<"parseADCMessage";
-    RawADCFrameTest frame;
-    frame.sample_data.clear();
-
-    for (int i = 0; i < tokens.size(); ++i) {
-        const QString& token = tokens[i];
-
-        if (token == "MsgId:" && i + 1 < tokens.size()) {
-            frame.msgId = tokens[++i].toUInt();
-        } else if (token == "NumSamples:" && i + 1 < tokens.size()) {
-            frame.num_samples_per_chirp = tokens[++i].toUInt();
-        } else if (token == "ADC:" && i + 1 < tokens.size()) {
-            frame.sample_data.push_back(tokens[++i].toFloat());
+void MainWindow::releasePlayout()
+{
+    const int64_t now = static_cast<int64_t>(Instrumentation::wallClockUs());
+    const bool record = Instrumentation::enabled();
+    auto collect = [&](auto& queue) {
+        return [&queue, record](auto&& frame, int64_t heldUs) {
+            if (record) {
+                Instrumentation::instance().record(Stage::Playout, static_cast<uint64_t>(heldUs) * 1000);
+            }
+            queue.push_back(std::move(frame));
+        };
+    };
+    
+    int64_t nextRelease = std::numeric_limits<int64_t>::max();
+    for (size_t source = 0; source < m_playout.size(); ++source) {
+        SourcePlayout& playout = m_playout[source];
+        playout.tracks.release(now, collect(m_collectedFrames.tracks));
+        playout.adcFrames.release(now, collect(m_collectedFrames.adcFrames));
+        playout.rawFrames.release(now, collect(m_collectedFrames.rawFrames));
+        if (!m_collectedFrames.empty()) {
+            deliverFrames(static_cast<int>(source), m_collectedFrames);
         }
+        nextRelease = std::min({nextRelease, playout.tracks.nextReleaseUs(),
+                                playout.adcFrames.nextReleaseUs(), playout.rawFrames.nextReleaseUs()});
+    }
+    
+    if (nextRelease == std::numeric_limits<int64_t>::max()) {
+        m_playoutTimer->stop();
+    } else {
+        // Round up so the frame is due when the timer fires
+        const int64_t waitMs = std::max<int64_t>(0, (nextRelease - now + 999) / 1000);
+        m_playoutTimer->start(static_cast<int>(std::min<int64_t>(waitMs, 1000)));
     }
+}
 
-    // Now assign to your current frame and update plot
-    m_currentADCFrame = frame;
-    //updateADCPlot();  // call your FFT or frequency domain plot update method
+void MainWindow::deliverFrames(int source, SourceFrames& frames)
+{
+    const unsigned decimation = m_degradation.settings().inputDecimation;
+    for (const FramePool<TargetTrackData>::Ref& tracks : frames.tracks) {
+        m_publisher.publishTracks(static_cast<size_t>(source), *tracks);
+        // Publishing sees every released frame, the display may not
+        if (decimation > 1 && m_trackDecimation[source]++ % decimation != 0) {
+            continue;
+        }
+        m_trackMerger.add(source, *tracks, tracks->received_us);
+        m_tracksUpdated = true;
+    }
+    
+    if (source == m_adcSource) {
+        queueADCFrames(frames);
+    }
+    frames.clear();
+    m_refreshScheduler->markDirty();
 }
 
+void MainWindow::queueADCFrames(SourceFrames& frames)
+{
+    // Latest keeps one frame per refresh, Aggregate up to MAX_AGGREGATE_FRAMES.
+    // A switch between text and binary ADC drops the other queue.
+    const bool latest =
+        m_refreshScheduler->framePolicy() == RefreshScheduler::FramePolicy::Latest;
+    const unsigned decimation = m_degradation.settings().inputDecimation;
+    if (!frames.rawFrames.empty()) {
+        m_pendingADCFrames.clear();
+    }
+    for (FramePool<RawADCFrame>::Ref& frame : frames.rawFrames) {
+        if (decimation > 1 && m_adcDecimation++ % decimation != 0) {
+            continue;
+        }
+        if (latest) {
+            m_pendingRawFrames.clear();
+        } else if (m_pendingRawFrames.size() >= MAX_AGGREGATE_FRAMES) {
+            m_pendingRawFrames.erase(m_pendingRawFrames.begin());
+        }
+        m_pendingRawFrames.push_back(std::move(frame));
+    }
+    if (!frames.adcFrames.empty()) {
+        m_pendingRawFrames.clear();
+    }
+    for (FramePool<RawADCFrameTest>::Ref& frame : frames.adcFrames) {
+        if (decimation > 1 && m_adcDecimation++ % decimation != 0) {
+            continue;
+        }
+        if (latest) {
+            m_pendingADCFrames.clear();
+        } else if (m_pendingADCFrames.size() >= MAX_AGGREGATE_FRAMES) {
+            m_pendingADCFrames.erase(m_pendingADCFrames.begin());
+        }
+        m_pendingADCFrames.push_back(std::move(frame));
+    }
+}
 
 //void MainWindow::readPendingDatagrams1()
 //{
@@ -370,74 +823,394 @@ void MainWindow::onRangeChanged(int range)
     m_ppiWidget->setMaxRange(rangeMeters);
 }
 
-void MainWindow::updateTrackTable()
+void MainWindow::onTrailsToggled(bool enabled)
+{
+    m_ppiWidget->setShowTrails(enabled);
+    m_trailLengthSpinBox->setEnabled(enabled);
+}
+
+void MainWindow::onTrailLengthChanged(int length)
+{
+    m_ppiWidget->setTrailLength(length);
+}
+
+void MainWindow::onPersistenceToggled(bool enabled)
+{
+    m_ppiWidget->setPersistence(enabled);
+    m_halfLifeSpinBox->setEnabled(enabled);
+}
+
+void MainWindow::onPersistenceHalfLifeChanged(int frames)
+{
+    m_ppiWidget->setPersistenceHalfLife(frames);
+}
+
+void MainWindow::onHeatmapToggled(bool enabled)
 {
-    m_trackTable->setRowCount(m_currentTargets.numTracks);
-    //qDebug()<<"In Table "<<m_currentTargets.numTracks<<"\n";
-    for (uint32_t i = 0; i < m_currentTargets.numTracks; ++i) {
-        const TargetTrack& target = m_currentTargets.targets[i];
-        qDebug()<<target.target_id<<target.radius<<target.azimuth<<target.radial_speed<<"\n";
-        m_trackTable->setItem(i, 0, new QTableWidgetItem(QString::number(target.target_id)));
-        m_trackTable->setItem(i, 1, new QTableWidgetItem(QString::number(target.radius, 'f', 0)));
-        m_trackTable->setItem(i, 2, new QTableWidgetItem(QString::number(target.azimuth, 'f', 1)));
-        m_trackTable->setItem(i, 3, new QTableWidgetItem(QString::number(target.radial_speed, 'f', 1)));
+    m_ppiWidget->setShowHeatmap(enabled);
+    if (enabled && m_rawFrameReceived) {
+        m_ppiWidget->updateRawFrame(*m_currentRawFrame);
+    }
+}
+
+void MainWindow::onLabelModeChanged(int index)
+{
+    Q_UNUSED(index)
+    m_ppiWidget->setLabelMode(
+        static_cast<PPIWidget::LabelMode>(m_labelModeCombo->currentData().toInt()));
+}
+
+void MainWindow::onApplyPorts()
+{
+    std::vector<quint16> ports;
+    const QStringList fields = m_portsEdit->text().split(QRegularExpression("[,;\\s]+"));
+    for (const QString& field : fields) {
+        if (field.isEmpty()) {
+            continue;
+        }
+        bool ok = false;
+        const uint port = field.toUInt(&ok);
+        if (ok && port > 0 && port <= 65535 &&
+            std::find(ports.begin(), ports.end(), static_cast<quint16>(port)) == ports.end()) {
+            ports.push_back(static_cast<quint16>(port));
+        }
+    }
+    if (ports.empty()) {
+        m_statusLabel->setText("Status: No valid UDP port");
+        return;
     }
     
-    m_trackTable->resizeColumnsToContents();
+    stopSources();
+    m_pendingADCFrames.clear();
+    m_pendingRawFrames.clear();
+    startSources(ports);
 }
 
-void MainWindow::generateSimulatedTargetData()
+void MainWindow::onSourceBindFailed(int source, quint16 port)
+{
+    Q_UNUSED(source)
+    QMessageBox::warning(this, "Network Error",
+                         QString("Failed to bind to UDP port %1. "
+                                 "Real data reception disabled for this source.").arg(port));
+    m_statusLabel->setText(QString("Status: Network Error on port %1").arg(port));
+}
+
+void MainWindow::onADCSourceChanged(int index)
+{
+    m_adcSource = std::max(0, index);
+    m_pendingADCFrames.clear();
+    m_pendingRawFrames.clear();
+}
+
+void MainWindow::onChannelDisplayChanged(int index)
+{
+    Q_UNUSED(index)
+    m_fftWidget->setChannelDisplay(
+        static_cast<FFTWidget::ChannelDisplay>(m_channelDisplayCombo->currentData().toInt()));
+    // No periodic refresh any more: recompute the shown frame for the new view
+    if (m_rawFrameReceived) {
+        m_fftWidget->updateData(*m_currentRawFrame);
+    }
+}
+
+void MainWindow::onMtiModeChanged(int index)
+{
+    Q_UNUSED(index)
+    m_fftWidget->setMtiMode(static_cast<SpectrumProcessor::MtiMode>(m_mtiCombo->currentData().toInt()));
+    if (m_rawFrameReceived) {
+        m_fftWidget->updateData(*m_currentRawFrame);
+    }
+}
+
+void MainWindow::onClutterMapToggled(bool enabled)
+{
+    // The background is learned from the frames that follow
+    m_fftWidget->setClutterMapEnabled(enabled);
+}
+
+void MainWindow::onMaxFpsChanged(int fps)
+{
+    m_refreshScheduler->setMaxFps(fps);
+}
+
+void MainWindow::onAutoDegradeToggled(bool enabled)
+{
+    m_degradation.setEnabled(enabled);
+    applyDegradation();
+}
+
+void MainWindow::onFrameBudgetChanged(int ms)
+{
+    m_degradation.setBudgetMs(ms);
+    updateDegradationLabel();
+}
+
+void MainWindow::applyDegradation()
+{
+    const DegradationController::Settings& detail = m_degradation.settings();
+    m_ppiWidget->setLabelsEnabled(detail.targetLabels);
+    m_fftWidget->setMaxChirps(detail.maxChirps);
+    updateDegradationLabel();
+}
+
+void MainWindow::updateDegradationLabel()
+{
+    QString text = QString("Display: %1 (%2 / %3 ms)")
+                       .arg(DegradationController::levelName(m_degradation.level()))
+                       .arg(m_degradation.costMs(), 0, 'f', 1)
+                       .arg(m_degradation.budgetMs(), 0, 'f', 0);
+    m_degradationLabel->setText(text);
+    const Stage costliest = m_degradation.costliestStage();
+    m_degradationLabel->setToolTip(QString("Smoothed GUI thread time per refresh; most spent in %1 (%2 ms)")
+                                       .arg(stageName(costliest))
+                                       .arg(m_degradation.stageCostMs(costliest), 0, 'f', 1));
+}
+
+void MainWindow::onFramePolicyChanged(int index)
+{
+    Q_UNUSED(index)
+    m_refreshScheduler->setFramePolicy(
+        static_cast<RefreshScheduler::FramePolicy>(m_framePolicyCombo->currentData().toInt()));
+}
+
+void MainWindow::onJitterDelayChanged(int ms)
 {
-    // Generate random number of targets
-    uint32_t numTargets = m_numTargetsDist(m_randomEngine);
-    m_currentTargets.resize(numTargets);
+    m_jitterDelayUs = static_cast<int64_t>(ms) * 1000;
+    for (SourcePlayout& playout : m_playout) {
+        playout.tracks.setDelayUs(m_jitterDelayUs);
+        playout.adcFrames.setDelayUs(m_jitterDelayUs);
+        playout.rawFrames.setDelayUs(m_jitterDelayUs);
+    }
+    if (m_jitterDelayUs > 0) {
+        releasePlayout();
+        return;
+    }
     
-    for (uint32_t i = 0; i < numTargets; ++i) {
-        TargetTrack& target = m_currentTargets.targets[i];
-        
-        target.target_id = i + 1;
-        target.level = m_levelDist(m_randomEngine);
-        target.radius = m_rangeDist(m_randomEngine);
-        target.azimuth = m_azimuthDist(m_randomEngine);
-        target.elevation = std::uniform_real_distribution<float>(-30.0f, 30.0f)(m_randomEngine);
-        target.radial_speed = m_speedDist(m_randomEngine);
-        target.azimuth_speed = std::uniform_real_distribution<float>(-5.0f, 5.0f)(m_randomEngine);
-        target.elevation_speed = std::uniform_real_distribution<float>(-2.0f, 2.0f)(m_randomEngine);
+    // Turned off: hand over whatever is still buffered, in order
+    const int64_t now = static_cast<int64_t>(Instrumentation::wallClockUs());
+    auto collect = [](auto& queue) {
+        return [&queue](auto&& frame, int64_t) { queue.push_back(std::move(frame)); };
+    };
+    for (size_t source = 0; source < m_playout.size(); ++source) {
+        SourcePlayout& playout = m_playout[source];
+        playout.tracks.flush(now, collect(m_collectedFrames.tracks));
+        playout.adcFrames.flush(now, collect(m_collectedFrames.adcFrames));
+        playout.rawFrames.flush(now, collect(m_collectedFrames.rawFrames));
+        playout.tracks.clear();
+        playout.adcFrames.clear();
+        playout.rawFrames.clear();
+        if (!m_collectedFrames.empty()) {
+            deliverFrames(static_cast<int>(source), m_collectedFrames);
+        }
+    }
+    m_playoutTimer->stop();
+}
+
+void MainWindow::exportSpectrum(const SpectrumProcessor& spectrum, uint32_t frameNumber,
+                                uint64_t timestampUs)
+{
+    if (spectrum.magnitude().empty()) {
+        return;
+    }
+    if (m_archiveWriter.isOpen()) {
+        // Spectra are computed at display time, shortly after their frame arrived
+        m_archiveWriter.writeSpectrum(m_adcSource, Instrumentation::wallClockUs(), timestampUs, frameNumber,
+                                      spectrum.magnitude(), spectrum.twoSided());
+    }
+    m_publisher.publishSpectrum(m_adcSource, timestampUs, frameNumber,
+                                spectrum.magnitude(), spectrum.twoSided());
+}
+
+void MainWindow::onPublishToggled(bool enabled)
+{
+    if (!enabled) {
+        m_publisher.close();
+        statusBar()->showMessage("Stopped publishing", 3000);
+        return;
+    }
+    if (!m_publisher.open(SHARED_RING_NAME)) {
+        QMessageBox::warning(this, "Publish Error",
+                             QString("Failed to create shared memory ring %1").arg(SHARED_RING_NAME));
+        m_publishCheckBox->blockSignals(true);
+        m_publishCheckBox->setChecked(false);
+        m_publishCheckBox->blockSignals(false);
+        return;
+    }
+    statusBar()->showMessage(QString("Publishing to shared memory ring %1").arg(SHARED_RING_NAME), 5000);
+}
+
+void MainWindow::onRecordToggled(bool recording)
+{
+    if (!recording) {
+        m_archiveWriter.close();
+        m_recordButton->setText("Record...");
+        updateTimeline();
+        return;
     }
     
-    m_targetCount += numTargets;
+    QString path = QFileDialog::getSaveFileName(this, "Record Archive", "radar_archive",
+                                                "Radar archives (*.tracks)");
+    if (path.endsWith(".tracks")) {
+        path.chop(6);
+    }
+    const std::string basePath = path.toStdString();
+    if (path.isEmpty() || !m_archiveWriter.open(basePath) || !m_archiveReader.open(basePath)) {
+        if (!path.isEmpty()) {
+            m_archiveWriter.close();
+            QMessageBox::warning(this, "Archive Error", QString("Failed to create %1").arg(path));
+        }
+        m_recordButton->blockSignals(true);
+        m_recordButton->setChecked(false);
+        m_recordButton->blockSignals(false);
+        return;
+    }
+    m_recordButton->setText("Stop Recording");
+    statusBar()->showMessage(QString("Recording to %1.tracks / .spectra").arg(path), 5000);
+    updateTimeline();
 }
 
-void MainWindow::generateSimulatedADCData()
+void MainWindow::onOpenArchive()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Open Archive", QString(),
+                                                "Radar archives (*.tracks)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (path.endsWith(".tracks")) {
+        path.chop(6);
+    }
+    if (!m_archiveReader.open(path.toStdString())) {
+        QMessageBox::warning(this, "Archive Error", QString("Failed to open %1").arg(path));
+        return;
+    }
+    updateTimeline();
+    // Start at the beginning of the archive
+    m_timelineSlider->setValue(0);
+    onTimelineMoved(0);
+}
+
+void MainWindow::updateTimeline()
 {
-    // Generate simulated ADC data with some frequency components
-    const uint32_t numSamples = 512;
-    m_currentADCFrame.sample_data.resize(numSamples);
-   // m_currentADCFrame.frame_number++;
-    m_currentADCFrame.num_samples_per_chirp = numSamples;
+    if (!m_archiveReader.isOpen() || !m_archiveReader.refresh() || m_archiveReader.lastTimestamp() == 0) {
+        m_timelineSlider->setEnabled(false);
+        return;
+    }
+    // Slider steps are milliseconds since the first archived frame
+    const uint64_t spanMs = (m_archiveReader.lastTimestamp() - m_archiveReader.firstTimestamp()) / 1000;
+    const int maximum = static_cast<int>(std::min<uint64_t>(spanMs, std::numeric_limits<int>::max()));
+    m_timelineSlider->blockSignals(true);
+    m_timelineSlider->setRange(0, maximum);
+    if (!m_playback) {
+        m_timelineSlider->setValue(maximum);
+    }
+    m_timelineSlider->blockSignals(false);
+    m_timelineSlider->setEnabled(true);
     
-    // Generate signal with multiple frequency components + noise
-    float sampleRate = 100000.0f; // 100 kHz
-    float t_step = 1.0f / sampleRate;
+    if (!m_playback) {
+        QString text = QString("%1 s archived").arg(spanMs / 1000);
+        if (m_archiveWriter.isOpen()) {
+            text += QString(", %1 MB").arg(m_archiveWriter.bytesUsed() / (1024.0 * 1024.0), 0, 'f', 1);
+        }
+        m_timelineLabel->setText(text);
+    }
+}
+
+void MainWindow::onTimelineMoved(int value)
+{
+    if (!m_archiveReader.isOpen()) {
+        return;
+    }
+    if (!m_playback) {
+        m_playback = true;
+        m_liveButton->setEnabled(true);
+        m_ppiWidget->clearHistory();
+    }
+    showArchiveAt(m_archiveReader.firstTimestamp() + static_cast<uint64_t>(value) * 1000);
+}
+
+void MainWindow::showArchiveAt(uint64_t timestampUs)
+{
+    // Trails only make sense moving forward in time
+    if (timestampUs < m_archivePositionUs) {
+        m_ppiWidget->clearHistory();
+    }
+    m_archivePositionUs = timestampUs;
     
-    // Add some dominant frequency components
-    float freq1 = 5000.0f;  // 5 kHz
-    float freq2 = 15000.0f; // 15 kHz
-    float freq3 = 25000.0f; // 25 kHz
+    if (!m_archiveReader.tracksAt(timestampUs, TrackMerger::DEFAULT_STALE_US, m_archiveTargets)) {
+        m_archiveTargets.resize(0);
+    }
+    // Replayed tracks stay out of the end-to-end latency histogram
+    m_archiveTargets.timestamp_us = 0;
+    m_ppiWidget->updateTargets(m_archiveTargets);
+    m_trackTable->updateTracks(m_archiveTargets);
     
-    std::uniform_real_distribution<float> noiseDist(-0.1f, 0.1f);
+    ArchiveStream::Frame spectrum;
+    if (m_archiveReader.spectrumAt(timestampUs, spectrum)) {
+        m_fftWidget->showSpectrum(spectrum.column<float>(0), spectrum.rows,
+                                  (spectrum.flags & ArchiveWriter::SPECTRUM_TWO_SIDED) != 0,
+                                  spectrum.frameNumber, spectrum.sourceTimestamp);
+    }
     
-    for (uint32_t i = 0; i < numSamples; ++i) {
-        float t = i * t_step;
-        
-        // Sum of sinusoids with different amplitudes
-        float signal = 0.8f * std::sin(2.0f * M_PI * freq1 * t) +
-                      0.5f * std::sin(2.0f * M_PI * freq2 * t) +
-                      0.3f * std::sin(2.0f * M_PI * freq3 * t);
-        
-        // Add noise
-        signal += noiseDist(m_randomEngine);
-        
-        m_currentADCFrame.sample_data[i] = signal;
+    m_timelineLabel->setText(QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(timestampUs / 1000))
+                                 .toString("yyyy-MM-dd hh:mm:ss.zzz") +
+                             QString(" (%1 tracks)").arg(m_archiveTargets.numTracks));
+}
+
+void MainWindow::onGoLive()
+{
+    m_playback = false;
+    m_archivePositionUs = 0;
+    m_liveButton->setEnabled(false);
+    m_ppiWidget->clearHistory();
+    updateTimeline();
+    // Redraw the live state on the next refresh
+    m_tracksUpdated = true;
+    m_refreshScheduler->markDirty();
+}
+
+void MainWindow::onStatsOverlayToggled(bool enabled)
+{
+    // Timers stay compiled in but cost a single branch while disabled
+    Instrumentation::setEnabled(enabled);
+    if (enabled) {
+        Instrumentation::instance().reset();
+    }
+    m_statsOverlay->setVisible(enabled);
+    m_exportStatsButton->setEnabled(enabled);
+}
+
+void MainWindow::onExportStats()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Stats", "radar_stats.csv",
+                                                "CSV files (*.csv)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (Instrumentation::instance().writeCsv(path.toStdString())) {
+        statusBar()->showMessage(QString("Stats written to %1").arg(path), 5000);
+    } else {
+        QMessageBox::warning(this, "Export Error",
+                             QString("Failed to write %1").arg(path));
     }
 }
+
+void MainWindow::updateTrackTable()
+{
+    ScopedStageTimer timer(Stage::TableUpdate);
+    m_trackTable->updateTracks(m_currentTargets);
+}
+
+void MainWindow::generateSimulatedTargetData()
+{
+    m_simulator.generateTargets(m_currentTargets);
+    m_tracksUpdated = true;
+}
+
+void MainWindow::generateSimulatedADCData()
+{
+    FramePool<RawADCFrameTest>::Ref frameRef = m_framePools.adcFrames.acquire();
+    m_simulator.generateADC(*frameRef);
+    m_pendingRawFrames.clear();
+    m_pendingADCFrames.clear();
+    m_pendingADCFrames.push_back(std::move(frameRef));
+}
@@ -1,8 +1,9 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QTimer>
-#include <QUdpSocket>
 #include <QSplitter>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -12,11 +13,26 @@
 #include <QGroupBox>
 #include <QSpinBox>
 #include <QPushButton>
-#include <random>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QSlider>
+#include <vector>
 
 #include "PPIWidget.h"
 #include "FFTWidget.h"
+#include "StatsOverlay.h"
+#include "TrackTableWidget.h"
+#include "RefreshScheduler.h"
+#include "DegradationController.h"
+#include "SourceReceiver.h"
+#include "TrackMerger.h"
+#include "JitterBuffer.h"
+#include "RadarArchive.h"
+#include "SharedFrameRing.h"
 #include "DataStructures.h"
+#include "BufferPool.h"
+#include "Simulator.h"
 
 class MainWindow : public QMainWindow
 {
@@ -28,55 +44,160 @@ public:
 
 private slots:
     void updateDisplay();
-    void readPendingDatagrams();
+    void onFramesReady(int source);
+    void onSourceBindFailed(int source, quint16 port);
+    void onApplyPorts();
+    void onADCSourceChanged(int index);
     void onSimulateDataToggled();
     void onRangeChanged(int range);
+    void onTrailsToggled(bool enabled);
+    void onTrailLengthChanged(int length);
+    void onPersistenceToggled(bool enabled);
+    void onPersistenceHalfLifeChanged(int frames);
+    void onHeatmapToggled(bool enabled);
+    void onLabelModeChanged(int index);
+    void onChannelDisplayChanged(int index);
+    void onMtiModeChanged(int index);
+    void onClutterMapToggled(bool enabled);
+    void onStatsOverlayToggled(bool enabled);
+    void onExportStats();
+    void onMaxFpsChanged(int fps);
+    void onAutoDegradeToggled(bool enabled);
+    void onFrameBudgetChanged(int ms);
+    void onFramePolicyChanged(int index);
+    void onJitterDelayChanged(int ms);
+    void releasePlayout();
+    void onRecordToggled(bool recording);
+    void onOpenArchive();
+    void onTimelineMoved(int value);
+    void onGoLive();
+    void onPublishToggled(bool enabled);
 
 private:
     void setupUI();
     void setupNetworking();
-    void setupTimer();
+    void startSources(const std::vector<quint16>& ports);
+    void stopSources();
+    void deliverFrames(int source, SourceFrames& frames);
+    void queueADCFrames(SourceFrames& frames);
+    void setupRefresh();
     void updateTrackTable();
+    void updateFrameCountLabel();
+    void updateSourceStatsLabel();
+    void applyDegradation();
+    void updateDegradationLabel();
+    void updateTimeline();
+    void showArchiveAt(uint64_t timestampUs);
+    void exportSpectrum(const SpectrumProcessor& spectrum, uint32_t frameNumber, uint64_t timestampUs);
     void generateSimulatedTargetData();
     void generateSimulatedADCData();
-    void parseADCMessage(const QString& message);
-    void parseTrackMessage(const QString& message);
     
     // UI Components
     PPIWidget* m_ppiWidget;
     FFTWidget* m_fftWidget;
-    QTableWidget* m_trackTable;
+    TrackTableWidget* m_trackTable;
     QSplitter* m_mainSplitter;
     QSplitter* m_rightSplitter;
     
     // Controls
     QSpinBox* m_rangeSpinBox;
+    QCheckBox* m_trailsCheckBox;
+    QSpinBox* m_trailLengthSpinBox;
+    QCheckBox* m_persistenceCheckBox;
+    QSpinBox* m_halfLifeSpinBox;
+    QCheckBox* m_heatmapCheckBox;
+    QComboBox* m_labelModeCombo;
+    QComboBox* m_channelDisplayCombo;
+    QComboBox* m_mtiCombo;
+    QCheckBox* m_clutterMapCheckBox;
+    QSpinBox* m_maxFpsSpinBox;
+    QCheckBox* m_autoDegradeCheckBox;
+    QSpinBox* m_frameBudgetSpinBox;
+    QComboBox* m_framePolicyCombo;
+    QSpinBox* m_jitterDelaySpinBox;
     QPushButton* m_simulateButton;
+    QCheckBox* m_statsCheckBox;
+    QPushButton* m_exportStatsButton;
+    StatsOverlay* m_statsOverlay;
     QLabel* m_statusLabel;
     QLabel* m_frameCountLabel;
+    QLineEdit* m_portsEdit;
+    QComboBox* m_adcSourceCombo;
+    QLabel* m_sourceStatsLabel;
+    QPushButton* m_recordButton;
+    QSlider* m_timelineSlider;
+    QLabel* m_timelineLabel;
+    QLabel* m_degradationLabel;
+    QPushButton* m_liveButton;
+    QCheckBox* m_publishCheckBox;
     
-    // Networking
-    QUdpSocket* m_udpSocket;
-    static constexpr quint16 UDP_PORT = 5000;
+    // Networking: one receive/decode thread per source port
+    static constexpr quint16 DEFAULT_UDP_PORT = 5000;
+    std::vector<SourceReceiver*> m_sources;
+    std::vector<QThread*> m_sourceThreads;
+    TrackMerger m_trackMerger;
+    int m_adcSource;  // source whose ADC frames feed the FFT and heatmap
     
-    // Timer
-    QTimer* m_updateTimer;
-    static constexpr int UPDATE_INTERVAL_MS = 50;
+    // Display refresh, driven by data arrival
+    RefreshScheduler* m_refreshScheduler;
+    static constexpr size_t MAX_AGGREGATE_FRAMES = 16;
     
-    // Data
+    // Load shedding: what the last refreshes cost against the frame budget
+    // decides how much detail the display keeps
+    DegradationController m_degradation;
+    unsigned m_tableRefreshes;     // refreshes since the track table was updated
+    unsigned m_spectrumRefreshes;  // refreshes since the spectrum was computed
+    bool m_tableStale;             // tracks shown on the PPI but not yet in the table
+    std::vector<uint32_t> m_trackDecimation;  // per-source track frame counter
+    uint32_t m_adcDecimation;                 // ADC frame counter
+    
+    // Data (pools are declared first so they outlive the frames they hand out)
+    SourceFramePools m_framePools;
     TargetTrackData m_currentTargets;
-    RawADCFrameTest m_currentADCFrame;
+    FramePool<RawADCFrameTest>::Ref m_currentADCFrame;
+    FramePool<RawADCFrame>::Ref m_currentRawFrame;
+    bool m_rawFrameReceived;
+    
+    // Received since the last refresh (one frame under the Latest policy)
+    bool m_tracksUpdated;
+    std::vector<FramePool<RawADCFrameTest>::Ref> m_pendingADCFrames;
+    std::vector<FramePool<RawADCFrame>::Ref> m_pendingRawFrames;
+    std::vector<const RawADCFrameTest*> m_pendingADCPointers;
+    std::vector<const RawADCFrame*> m_pendingRawPointers;
+    SourceFrames m_collectedFrames;  // reused by onFramesReady
+    
+    // Per-source playout in source-timestamp order, bypassed while the delay is 0
+    struct SourcePlayout {
+        JitterBuffer<TargetTrackData> tracks;
+        JitterBuffer<RawADCFrameTest> adcFrames;
+        JitterBuffer<RawADCFrame> rawFrames;
+    };
+    std::vector<SourcePlayout> m_playout;
+    int64_t m_jitterDelayUs;
+    QTimer* m_playoutTimer;  // fires when the earliest buffered frame is due
+    
+    // Archive: recording and timeline playback (the display leaves live mode
+    // while scrubbing; recording continues)
+    ArchiveWriter m_archiveWriter;
+    ArchiveReader m_archiveReader;
+    bool m_playback;
+    uint64_t m_archivePositionUs;
+    TargetTrackData m_archiveTargets;
+    SpectrumProcessor m_exportSpectrum;  // spectra to record/publish while the FFT view shows the archive
+    
+    // Decoded frames for other local processes (shared-memory ring)
+    static constexpr const char* SHARED_RING_NAME = "radar_frames";
+    SharedFramePublisher m_publisher;
     
     // Simulation
     bool m_simulationEnabled;
-    std::mt19937 m_randomEngine;
-    std::uniform_real_distribution<float> m_rangeDist;
-    std::uniform_real_distribution<float> m_azimuthDist;
-    std::uniform_real_distribution<float> m_speedDist;
-    std::uniform_real_distribution<float> m_levelDist;
-    std::uniform_int_distribution<int> m_numTargetsDist;
+    Simulator m_simulator;
     
     // Statistics
-    uint64_t m_frameCount;
-    uint64_t m_targetCount;
+    uint64_t m_frameCount;  // frames decoded from the network
+    uint64_t m_refreshCount;  // display refreshes
+    QTimer* m_sourceStatsTimer;  // per-source rates, also while no data arrives
+    QElapsedTimer m_sourceStatsClock;
+    std::vector<uint64_t> m_sourceFramesAtLastStats;
+    std::vector<uint64_t> m_sourceBytesAtLastStats;
 };
@@ -0,0 +1,203 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, Mode mode)
+{
+    close();
+    const bool write = mode == Mode::ReadWrite;
+    HANDLE file = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              write ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_file = file;
+    m_mode = mode;
+    if (!map(fileSize())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    unmap();
+    if (m_file) {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+bool MappedFile::resize(size_t size)
+{
+    if (!m_file || m_mode != Mode::ReadWrite) {
+        return false;
+    }
+    unmap();
+    LARGE_INTEGER length;
+    length.QuadPart = static_cast<LONGLONG>(size);
+    // Shrinking fails while another process still maps the tail; the
+    // mapping below then simply keeps the old length
+    if (SetFilePointerEx(m_file, length, nullptr, FILE_BEGIN)) {
+        SetEndOfFile(m_file);
+    }
+    return map(fileSize()) && m_size >= size;
+}
+
+bool MappedFile::map(size_t size)
+{
+    if (size == 0) {
+        return true;
+    }
+    const bool write = m_mode == Mode::ReadWrite;
+    m_mapping = CreateFileMappingA(m_file, nullptr, write ? PAGE_READWRITE : PAGE_READONLY,
+                                   static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                   static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    if (!m_mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(m_mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if (!view) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_size = 0;
+}
+
+size_t MappedFile::fileSize() const
+{
+    LARGE_INTEGER size;
+    return GetFileSizeEx(m_file, &size) ? static_cast<size_t>(size.QuadPart) : 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, Mode mode)
+{
+    close();
+    const bool write = mode == Mode::ReadWrite;
+    const int fd = write ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                         : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    m_fd = fd;
+    m_mode = mode;
+    if (!map(fileSize())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    unmap();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+bool MappedFile::resize(size_t size)
+{
+    if (m_fd < 0 || m_mode != Mode::ReadWrite) {
+        return false;
+    }
+    unmap();
+    if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        map(fileSize());
+        return false;
+    }
+    return map(size);
+}
+
+bool MappedFile::map(size_t size)
+{
+    if (size == 0) {
+        return true;
+    }
+    const bool write = m_mode == Mode::ReadWrite;
+    void* view = ::mmap(nullptr, size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) {
+        ::munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    m_size = 0;
+}
+
+size_t MappedFile::fileSize() const
+{
+    struct stat info;
+    return ::fstat(m_fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+}
+
+#endif
+
+bool MappedFile::remap()
+{
+    if (!isOpen()) {
+        return false;
+    }
+    const size_t size = fileSize();
+    if (size == m_size) {
+        return true;
+    }
+    unmap();
+    return map(size);
+}
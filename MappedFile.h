@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Whole-file shared memory mapping (mmap / MapViewOfFile). Read-write files
+// can be grown or shrunk, which remaps them, so pointers into data() are
+// only valid until the next resize() or remap().
+class MappedFile
+{
+public:
+    enum class Mode {
+        ReadOnly,
+        ReadWrite  // created if missing, truncated to zero length
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, Mode mode);
+    void close();
+    bool isOpen() const;
+
+    // ReadWrite only: sets the file length and remaps
+    bool resize(size_t size);
+    // Maps the file again at its current length, e.g. after another writer
+    // appended to it
+    bool remap();
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    bool map(size_t size);
+    void unmap();
+    size_t fileSize() const;
+
+    Mode m_mode = Mode::ReadOnly;
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;     // HANDLE, INVALID_HANDLE_VALUE stored as nullptr
+    void* m_mapping = nullptr;  // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
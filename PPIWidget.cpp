@@ -1,8 +1,13 @@
 #include "PPIWidget.h"
+#include "Instrumentation.h"
+#include "RasterKernels.h"
+#include <QMouseEvent>
 #include <QPaintEvent>
 #include <QResizeEvent>
+#include <QWheelEvent>
 #include <QFont>
 #include <QFontMetrics>
+#include <algorithm>
 #include <cmath>
 #include <QtMath>
 
@@ -11,15 +16,41 @@ PPIWidget::PPIWidget(QWidget *parent)
     : QWidget(parent)
     , m_maxRange(500.0f) // 500 default
     , m_plotRadius(0)
+    , m_paintedTimestamp(0)
+    , m_paintTimeNs(0)
+    , m_zoom(1.0f)
+    , m_pixelsPerMeter(0.0f)
+    , m_dragging(false)
+    , m_showTrails(true)
+    , m_persistence(false)
+    , m_decayFactor(decayFactorForHalfLife(8.0))
+    , m_showHeatmap(false)
+    , m_heatmapValid(false)
+    , m_heatmapRangeResolution(0.0f)
+    , m_labelMode(LabelMode::ByLevel)
+    , m_labelsEnabled(true)
+    , m_labelFont("Arial", 8)
 {
     setMinimumSize(400, 200);
     setBackgroundRole(QPalette::Base);
     setAutoFillBackground(true);
+    
+    // Labels are target IDs, so their width follows from the digit count
+    const QFontMetricsF metrics(m_labelFont);
+    m_labelDigitWidth = static_cast<float>(metrics.horizontalAdvance(QLatin1Char('0')));
+    m_labelAscent = static_cast<float>(metrics.ascent());
+    m_labelHeight = static_cast<float>(metrics.height());
+    m_labelPlacer.setMarker(TARGET_MARKER_RADIUS, 3.0f);
 }
 
 void PPIWidget::updateTargets(const TargetTrackData& trackData)
 {
     m_currentTargets = trackData;
+    m_trackIndex.build(m_currentTargets.targets, m_maxRange, MIN_AZIMUTH, MAX_AZIMUTH);
+    m_trackHistory.update(trackData);
+    if (m_persistence) {
+        accumulatePersistence();
+    }
     update();
 }
 
@@ -27,10 +58,106 @@ void PPIWidget::setMaxRange(float range)
 {
     if (range > 0) {
         m_maxRange = range;
+        updateTransform();
+        m_trackIndex.build(m_currentTargets.targets, m_maxRange, MIN_AZIMUTH, MAX_AZIMUTH);
+        // Accumulated returns were drawn at the old scale
+        if (!m_persistenceImage.isNull()) {
+            m_persistenceImage.fill(Qt::transparent);
+        }
+        rebuildHeatmapLut();
+        update();
+    }
+}
+
+void PPIWidget::setShowTrails(bool show)
+{
+    if (show != m_showTrails) {
+        m_showTrails = show;
         update();
     }
 }
 
+void PPIWidget::setTrailLength(int length)
+{
+    m_trackHistory.setTrailLength(static_cast<size_t>(std::max(2, length)));
+    update();
+}
+
+void PPIWidget::clearHistory()
+{
+    m_trackHistory.clear();
+    if (!m_persistenceImage.isNull()) {
+        m_persistenceImage.fill(Qt::transparent);
+    }
+    update();
+}
+
+void PPIWidget::setPersistence(bool enabled)
+{
+    if (enabled == m_persistence) {
+        return;
+    }
+    m_persistence = enabled;
+    if (m_persistence) {
+        m_persistenceImage = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+        m_persistenceImage.fill(Qt::transparent);
+    } else {
+        m_persistenceImage = QImage();
+    }
+    update();
+}
+
+void PPIWidget::setPersistenceHalfLife(double halfLifeFrames)
+{
+    m_decayFactor = decayFactorForHalfLife(halfLifeFrames);
+}
+
+void PPIWidget::setShowHeatmap(bool show)
+{
+    if (show == m_showHeatmap) {
+        return;
+    }
+    m_showHeatmap = show;
+    if (m_showHeatmap) {
+        rebuildHeatmapLut();
+    } else {
+        m_heatmapLut = PolarRasterLut();
+        m_heatmapImage = QImage();
+        m_heatmapValid = false;
+    }
+    update();
+}
+
+void PPIWidget::setHeatmapRangeResolution(float metersPerBin)
+{
+    m_heatmapRangeResolution = std::max(0.0f, metersPerBin);
+    rebuildHeatmapLut();
+    update();
+}
+
+void PPIWidget::updateRawFrame(const RawADCFrame& frame)
+{
+    if (!m_showHeatmap) {
+        return;
+    }
+    {
+        ScopedStageTimer timer(Stage::FFT);
+        m_heatmapValid = m_rangeAzimuth.process(frame);
+    }
+    if (!m_heatmapValid) {
+        return;
+    }
+    // A different bin layout invalidates the LUT even without a resize
+    const PolarRasterLut::Geometry& geometry = m_heatmapLut.geometry();
+    if (geometry.rangeBins != m_rangeAzimuth.rangeBins() ||
+        geometry.azimuthBins != m_rangeAzimuth.azimuthBins()) {
+        rebuildHeatmapLut();
+    } else {
+        renderHeatmap();
+    }
+    update();
+}
+
 void PPIWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
@@ -42,7 +169,12 @@ void PPIWidget::resizeEvent(QResizeEvent *event)
     
     // For semi-circle, height should be at least half of width
     int diameter = std::min(availableWidth, availableHeight * 2);
+    const float oldRadius = m_plotRadius;
     m_plotRadius = diameter / 2.0f;
+    // The pan follows the scale, so the same ground stays in view
+    if (oldRadius > 0) {
+        m_pan = m_pan * (m_plotRadius / oldRadius);
+    }
     
     m_plotRect = QRect(
         (width() - diameter) / 2,
@@ -52,20 +184,153 @@ void PPIWidget::resizeEvent(QResizeEvent *event)
     );
     
     m_center = QPointF(width() / 2.0f, height() - margin);
+    updateTransform();
+    m_labelPlacer.setViewport(width(), height());
+    
+    if (m_persistence) {
+        m_persistenceImage = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+        m_persistenceImage.fill(Qt::transparent);
+    }
+    rebuildHeatmapLut();
+}
+
+void PPIWidget::setZoom(float zoom, const QPointF& anchor)
+{
+    zoom = std::max(1.0f, std::min(MAX_ZOOM, zoom));
+    if (zoom == m_zoom) {
+        return;
+    }
+    // Scale the antenna's offset from the anchor, so the ground under the
+    // anchor does not move; all the way out is the full semicircle again
+    const QPointF origin = anchor + (m_origin - anchor) * (zoom / m_zoom);
+    m_zoom = zoom;
+    m_pan = m_zoom > 1.0f ? origin - m_center : QPointF();
+    viewChanged();
+}
+
+void PPIWidget::resetView()
+{
+    m_zoom = 1.0f;
+    m_pan = QPointF();
+    viewChanged();
+}
+
+void PPIWidget::updateTransform()
+{
+    // Horizontally the antenna may move a full display radius either way,
+    // vertically only down: enough to bring any part of the semicircle to
+    // the middle, without losing it entirely
+    const float radius = m_plotRadius * m_zoom;
+    m_pan = QPointF(std::max<double>(-radius, std::min<double>(radius, m_pan.x())),
+                    std::max<double>(0.0, std::min<double>(radius, m_pan.y())));
+    m_origin = m_center + m_pan;
+    m_pixelsPerMeter = m_maxRange > 0 ? radius / m_maxRange : 0.0f;
+}
+
+void PPIWidget::viewChanged()
+{
+    updateTransform();
+    // Accumulated returns were drawn with the old transform
+    if (!m_persistenceImage.isNull()) {
+        m_persistenceImage.fill(Qt::transparent);
+    }
+    // While dragging the heatmap image is only moved; see mouseMoveEvent()
+    if (!m_dragging) {
+        rebuildHeatmapLut();
+    }
+    update();
+}
+
+void PPIWidget::wheelEvent(QWheelEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QPointF anchor = event->position();
+#else
+    const QPointF anchor = event->posF();
+#endif
+    // One notch (120) zooms by 25%
+    const float notches = event->angleDelta().y() / 120.0f;
+    setZoom(m_zoom * std::pow(1.25f, notches), anchor);
+    event->accept();
+}
+
+void PPIWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    m_dragging = true;
+    m_dragStart = event->pos();
+    m_dragStartPan = m_pan;
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void PPIWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging) {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+    const QPointF previousOrigin = m_origin;
+    m_pan = m_dragStartPan + QPointF(event->pos() - m_dragStart);
+    viewChanged();
+    // Rebuilding the heatmap LUT costs per-pixel trigonometry, so during
+    // the drag the last image just moves along
+    m_heatmapOrigin += (m_origin - previousOrigin).toPoint();
+}
+
+void PPIWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!m_dragging || event->button() != Qt::LeftButton) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+    m_dragging = false;
+    unsetCursor();
+    rebuildHeatmapLut();
+    update();
+}
+
+void PPIWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        resetView();
+    }
 }
 
 void PPIWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
     
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    const uint64_t paintStart = Instrumentation::nowNs();
+    {
+        ScopedStageTimer timer(Stage::PaintPPI);
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        
+        drawBackground(painter);
+        if (m_showHeatmap && m_heatmapValid) {
+            painter.drawImage(m_heatmapOrigin, m_heatmapImage);
+        }
+        if (m_persistence) {
+            painter.drawImage(0, 0, m_persistenceImage);
+        }
+        drawRangeRings(painter);
+        drawAzimuthLines(painter);
+        if (m_showTrails) {
+            drawTrails(painter);
+        }
+        drawTargets(painter);
+        drawLabels(painter);
+    }
+    m_paintTimeNs += Instrumentation::nowNs() - paintStart;
     
-    drawBackground(painter);
-    drawRangeRings(painter);
-    drawAzimuthLines(painter);
-    drawTargets(painter);
-    drawLabels(painter);
+    // Repaints of an already shown frame don't count towards end-to-end latency
+    if (m_currentTargets.timestamp_us != m_paintedTimestamp) {
+        m_paintedTimestamp = m_currentTargets.timestamp_us;
+        Instrumentation::instance().recordEndToEnd(m_paintedTimestamp);
+    }
 }
 
 void PPIWidget::drawBackground(QPainter& painter)
@@ -77,18 +342,45 @@ void PPIWidget::drawBackground(QPainter& painter)
     painter.setBrush(QColor(0, 0, 0));
     painter.setPen(QPen(QColor(100, 100, 100), 2));
     
-    QRectF ellipseRect(m_center.x() - m_plotRadius, m_center.y() - m_plotRadius,
-                       2 * m_plotRadius, 2 * m_plotRadius);
+    const float radius = m_plotRadius * m_zoom;
+    QRectF ellipseRect(m_origin.x() - radius, m_origin.y() - radius, 2 * radius, 2 * radius);
     painter.drawChord(ellipseRect, 0, 180 * 16); // Draw upper semi-circle
 }
 
+float PPIWidget::ringSpacing() const
+{
+    // NUM_RANGE_RINGS over the full range, halving with every doubling of the zoom
+    return m_maxRange / NUM_RANGE_RINGS / std::exp2(std::floor(std::log2(m_zoom)));
+}
+
+void PPIWidget::visibleDistances(float& nearest, float& farthest) const
+{
+    const double dx0 = 0.0 - m_origin.x();
+    const double dx1 = width() - m_origin.x();
+    const double dy0 = 0.0 - m_origin.y();
+    const double dy1 = height() - m_origin.y();
+    const double nearX = dx0 > 0 ? dx0 : (dx1 < 0 ? dx1 : 0.0);
+    const double nearY = dy0 > 0 ? dy0 : (dy1 < 0 ? dy1 : 0.0);
+    const double farX = std::max(std::abs(dx0), std::abs(dx1));
+    const double farY = std::max(std::abs(dy0), std::abs(dy1));
+    const double scale = m_pixelsPerMeter > 0 ? 1.0 / m_pixelsPerMeter : 0.0;
+    nearest = static_cast<float>(std::sqrt(nearX * nearX + nearY * nearY) * scale);
+    farthest = static_cast<float>(std::sqrt(farX * farX + farY * farY) * scale);
+}
+
 void PPIWidget::drawRangeRings(QPainter& painter)
 {
     painter.setPen(QPen(QColor(100, 100, 100), 1));
     
-    for (int i = 1; i <= NUM_RANGE_RINGS; ++i) {
-        float radius = (float(i) / NUM_RANGE_RINGS) * m_plotRadius;
-        QRectF ellipseRect(m_center.x() - radius, m_center.y() - radius,
+    // Only rings crossing the widget
+    const float step = ringSpacing();
+    float nearest, farthest;
+    visibleDistances(nearest, farthest);
+    const int first = std::max(1, static_cast<int>(std::ceil(nearest / step)));
+    const int last = static_cast<int>(std::min(farthest, m_maxRange) / step + 1e-3f);
+    for (int i = first; i <= last; ++i) {
+        float radius = i * step * m_pixelsPerMeter;
+        QRectF ellipseRect(m_origin.x() - radius, m_origin.y() - radius,
                            2 * radius, 2 * radius);
         painter.drawChord(ellipseRect, 0, 180 * 16);
     }
@@ -98,47 +390,278 @@ void PPIWidget::drawAzimuthLines(QPainter& painter)
 {
     painter.setPen(QPen(QColor(100, 100, 100), 1));
     
+    const float radius = m_plotRadius * m_zoom;
     for (int i = 0; i < NUM_AZIMUTH_LINES; ++i) {
         float azimuth = MIN_AZIMUTH + (float(i) / (NUM_AZIMUTH_LINES - 1)) * (MAX_AZIMUTH - MIN_AZIMUTH);
         float radians = qDegreesToRadians(90.0f - azimuth); // Convert to math coordinates
         
         QPointF endPoint(
-            m_center.x() + m_plotRadius * std::cos(radians),
-            m_center.y() - m_plotRadius * std::sin(radians)
+            m_origin.x() + radius * std::cos(radians),
+            m_origin.y() - radius * std::sin(radians)
         );
         
-        painter.drawLine(m_center, endPoint);
+        painter.drawLine(m_origin, endPoint);
     }
 }
 
-void PPIWidget::drawTargets(QPainter& painter)
+void PPIWidget::drawTrails(QPainter& painter)
 {
-    for (const auto& target : m_currentTargets.targets) {
-        // Skip targets outside our azimuth range
-        if (target.azimuth < MIN_AZIMUTH || target.azimuth > MAX_AZIMUTH) {
-            continue;
+    for (std::vector<QLineF>& segments : m_trailSegments) {
+        segments.clear();
+    }
+    
+    // Zoomed in, most segments lie off screen: keep those with an end in view
+    const double left = -2.0, top = -2.0, right = width() + 2.0, bottom = height() + 2.0;
+    const auto onScreen = [&](const QPointF& p) {
+        return p.x() >= left && p.x() <= right && p.y() >= top && p.y() <= bottom;
+    };
+    
+    const size_t trailLength = m_trackHistory.trailLength();
+    m_trackHistory.forEachTrail([&](uint32_t, const TrackHistory::Trail& trail) {
+        QPointF previous;
+        bool previousInView = false;
+        for (size_t i = 0; i < trail.size(); ++i) {
+            const TrackHistory::Point& point = trail[i];
+            const bool inView = isInView(point.radius, point.azimuth);
+            if (!inView) {
+                previousInView = false;
+                continue;
+            }
+            const QPointF current = polarToCartesian(point.radius, point.azimuth);
+            if (previousInView && (onScreen(previous) || onScreen(current))) {
+                // Age 0 is the segment ending at the current position
+                const size_t age = trail.size() - 1 - i;
+                m_trailSegments[age * TRAIL_FADE_STEPS / trailLength].push_back(QLineF(previous, current));
+            }
+            previous = current;
+            previousInView = true;
         }
-        
-        // Skip targets outside our range
-        if (target.radius > m_maxRange) {
+    });
+    
+    // Oldest (faintest) first so newer segments stay on top
+    for (int step = TRAIL_FADE_STEPS - 1; step >= 0; --step) {
+        const std::vector<QLineF>& segments = m_trailSegments[step];
+        if (segments.empty()) {
             continue;
         }
-        
-        QPointF targetPos = polarToCartesian(target.radius, target.azimuth);
+        const int alpha = 200 * (TRAIL_FADE_STEPS - step) / TRAIL_FADE_STEPS;
+        painter.setPen(QPen(QColor(120, 200, 160, alpha), 1.5));
+        painter.drawLines(segments.data(), static_cast<int>(segments.size()));
+    }
+}
+
+void PPIWidget::accumulatePersistence()
+{
+    if (m_persistenceImage.isNull()) {
+        return;
+    }
+    
+    // Cost depends on the image size only, not on how much history is visible
+    decayPixels(reinterpret_cast<uint32_t*>(m_persistenceImage.bits()),
+                static_cast<size_t>(m_persistenceImage.bytesPerLine() / 4) * m_persistenceImage.height(),
+                m_decayFactor);
+    
+    QPainter painter(&m_persistenceImage);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    const float* xs = m_trackIndex.x();
+    const float* ys = m_trackIndex.y();
+    const uint32_t* tracks = m_trackIndex.track();
+    for (size_t slot = 0; slot < m_trackIndex.size(); ++slot) {
+        painter.setBrush(getTargetColor(m_currentTargets.targets[tracks[slot]].radial_speed).lighter(130));
+        painter.drawEllipse(toScreen(xs[slot], ys[slot]), 4.0, 4.0);
+    }
+}
+
+void PPIWidget::rebuildHeatmapLut()
+{
+    if (!m_showHeatmap || !m_heatmapValid || m_plotRadius <= 0) {
+        return;
+    }
+    
+    // Raster covers the part of the semicircle's bounding box inside the
+    // widget; zoomed in, the antenna may lie outside it
+    const float radius = m_plotRadius * m_zoom;
+    const int left = std::max(0, static_cast<int>(std::floor(m_origin.x() - radius)));
+    const int top = std::max(0, static_cast<int>(std::floor(m_origin.y() - radius)));
+    const int right = std::min(width(), static_cast<int>(std::ceil(m_origin.x() + radius)) + 1);
+    const int bottom = std::min(height(), static_cast<int>(std::ceil(m_origin.y())) + 1);
+    m_heatmapOrigin = QPoint(left, top);
+    
+    PolarRasterLut::Geometry geometry;
+    geometry.width = std::max(0, right - left);
+    geometry.height = std::max(0, bottom - top);
+    geometry.centerX = static_cast<float>(m_origin.x() - left);
+    geometry.centerY = static_cast<float>(m_origin.y() - top);
+    geometry.radius = radius;
+    geometry.minAzimuth = MIN_AZIMUTH;
+    geometry.maxAzimuth = MAX_AZIMUTH;
+    geometry.rangeBins = m_rangeAzimuth.rangeBins();
+    geometry.rangeBinsPerRadius = m_heatmapRangeResolution > 0.0f
+        ? m_maxRange / m_heatmapRangeResolution
+        : static_cast<float>(geometry.rangeBins);
+    geometry.azimuthBins = m_rangeAzimuth.azimuthBins();
+    m_heatmapLut.build(geometry);
+    if (!m_heatmapLut.isValid()) {
+        m_heatmapImage = QImage();
+        return;
+    }
+    
+    m_heatmapImage = QImage(geometry.width, geometry.height, QImage::Format_ARGB32_Premultiplied);
+    renderHeatmap();
+}
+
+void PPIWidget::renderHeatmap()
+{
+    if (!m_heatmapLut.isValid() || m_heatmapImage.isNull()) {
+        return;
+    }
+    
+    // Black -> red -> yellow -> white over the top HEATMAP_DYNAMIC_RANGE_DB,
+    // with alpha rising alongside so weak cells let the background through
+    static const std::vector<uint32_t> palette = [] {
+        std::vector<uint32_t> colors(256);
+        for (int i = 0; i < 256; ++i) {
+            const float t = i / 255.0f;
+            const float red = std::min(1.0f, 3.0f * t);
+            const float green = std::max(0.0f, std::min(1.0f, 3.0f * t - 1.0f));
+            const float blue = std::max(0.0f, 3.0f * t - 2.0f);
+            const uint32_t alpha = static_cast<uint32_t>(255.0f * t + 0.5f);
+            colors[i] = (alpha << 24) |
+                        (static_cast<uint32_t>(red * t * 255.0f + 0.5f) << 16) |
+                        (static_cast<uint32_t>(green * t * 255.0f + 0.5f) << 8) |
+                        static_cast<uint32_t>(blue * t * 255.0f + 0.5f);
+        }
+        return colors;
+    }();
+    
+    const std::vector<float>& power = m_rangeAzimuth.power();
+    const float floorDb = m_rangeAzimuth.maxPower() - HEATMAP_DYNAMIC_RANGE_DB;
+    const float scale = 255.0f / HEATMAP_DYNAMIC_RANGE_DB;
+    m_heatmapColors.resize(power.size());
+    for (size_t i = 0; i < power.size(); ++i) {
+        const float level = std::max(0.0f, std::min(255.0f, (power[i] - floorDb) * scale));
+        m_heatmapColors[i] = palette[static_cast<size_t>(level)];
+    }
+    
+    m_heatmapLut.scanConvert(m_heatmapColors.data(),
+                             reinterpret_cast<uint32_t*>(m_heatmapImage.bits()),
+                             static_cast<size_t>(m_heatmapImage.bytesPerLine() / 4));
+}
+
+void PPIWidget::setLabelMode(LabelMode mode)
+{
+    if (mode != m_labelMode) {
+        m_labelMode = mode;
+        update();
+    }
+}
+
+void PPIWidget::setLabelsEnabled(bool enabled)
+{
+    if (enabled != m_labelsEnabled) {
+        m_labelsEnabled = enabled;
+        update();
+    }
+}
+
+uint64_t PPIWidget::takePaintTimeNs()
+{
+    const uint64_t ns = m_paintTimeNs;
+    m_paintTimeNs = 0;
+    return ns;
+}
+
+void PPIWidget::drawTargets(QPainter& painter)
+{
+    m_labels.clear();
+    m_labelIds.clear();
+    if (m_pixelsPerMeter <= 0) {
+        return;
+    }
+    
+    // Ground rectangle under the widget, widened so partly visible markers stay
+    const double margin = TARGET_MARKER_RADIUS + 2.0;
+    m_trackIndex.query(static_cast<float>((-margin - m_origin.x()) / m_pixelsPerMeter),
+                       static_cast<float>((m_origin.y() - height() - margin) / m_pixelsPerMeter),
+                       static_cast<float>((width() + margin - m_origin.x()) / m_pixelsPerMeter),
+                       static_cast<float>((m_origin.y() + margin) / m_pixelsPerMeter),
+                       m_visibleSlots);
+    const std::vector<TargetTrack>& targets = m_currentTargets.targets;
+    const float* xs = m_trackIndex.x();
+    const float* ys = m_trackIndex.y();
+    const uint32_t* tracks = m_trackIndex.track();
+    
+    if (m_visibleSlots.size() > MAX_DETAILED_TARGETS) {
+        // Too many to tell apart or label: plain squares, one drawPoints per colour
+        for (std::vector<QPointF>& batch : m_markerBatches) {
+            batch.clear();
+        }
+        for (uint32_t slot : m_visibleSlots) {
+            m_markerBatches[colorBucket(targets[tracks[slot]].radial_speed)].push_back(toScreen(xs[slot], ys[slot]));
+        }
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        for (int bucket = 0; bucket < MARKER_COLOR_BUCKETS; ++bucket) {
+            const std::vector<QPointF>& batch = m_markerBatches[bucket];
+            if (!batch.empty()) {
+                painter.setPen(QPen(bucketColor(bucket), 4));
+                painter.drawPoints(batch.data(), static_cast<int>(batch.size()));
+            }
+        }
+        painter.setRenderHint(QPainter::Antialiasing);
+        return;
+    }
+    
+    for (uint32_t slot : m_visibleSlots) {
+        const TargetTrack& target = targets[tracks[slot]];
+        QPointF targetPos = toScreen(xs[slot], ys[slot]);
         QColor targetColor = getTargetColor(target.radial_speed);
         
         // Draw target as a circle
         painter.setBrush(targetColor);
         painter.setPen(QPen(targetColor.lighter(), 2));
         
-        float targetSize = 5.0f;// 6 + target.level * 0.1f; // Size based on level
+        float targetSize = TARGET_MARKER_RADIUS;// 6 + target.level * 0.1f; // Size based on level
         painter.drawEllipse(targetPos, targetSize, targetSize);
         
-        // Draw target ID
-        painter.setPen(QPen(Qt::white, 1));
-        painter.setFont(QFont("Arial", 8));
-        QPointF textPos = targetPos + QPointF(8, -8);
-        painter.drawText(textPos, QString::number(target.target_id));
+        if (m_labelMode != LabelMode::Off && m_labelsEnabled) {
+            int digits = 1;
+            for (uint32_t id = target.target_id; id >= 10; id /= 10) {
+                ++digits;
+            }
+            const float priority = m_labelMode == LabelMode::BySpeed
+                ? std::abs(target.radial_speed) : static_cast<float>(target.level);
+            m_labels.push_back(LabelPlacer::Label{
+                static_cast<float>(targetPos.x()), static_cast<float>(targetPos.y()),
+                digits * m_labelDigitWidth, m_labelHeight, priority});
+            m_labelIds.push_back(target.target_id);
+        }
+    }
+    
+    drawTargetLabels(painter);
+}
+
+void PPIWidget::drawTargetLabels(QPainter& painter)
+{
+    if (m_labels.empty()) {
+        return;
+    }
+    painter.setPen(QPen(Qt::white, 1));
+    painter.setFont(m_labelFont);
+    
+    if (m_labelMode == LabelMode::All) {
+        for (size_t i = 0; i < m_labels.size(); ++i) {
+            const QPointF textPos(m_labels[i].x + 8, m_labels[i].y - 8);
+            painter.drawText(textPos, QString::number(m_labelIds[i]));
+        }
+        return;
+    }
+    
+    // Only labels that found a free spot are shaped and rasterised
+    m_labelPlacer.place(m_labels, m_labelPlacements);
+    for (const LabelPlacer::Placement& placement : m_labelPlacements) {
+        const QPointF baseline(placement.left, placement.top + m_labelAscent);
+        painter.drawText(baseline, QString::number(m_labelIds[placement.label]));
     }
 }
 
@@ -147,13 +670,30 @@ void PPIWidget::drawLabels(QPainter& painter)
     painter.setPen(QPen(Qt::white, 1));
     painter.setFont(QFont("Arial", 10));
     
-    // Range labels
-    for (int i = 1; i <= NUM_RANGE_RINGS; ++i) {
-        float range = (float(i) / NUM_RANGE_RINGS) * m_maxRange;
-        float radius = (float(i) / NUM_RANGE_RINGS) * m_plotRadius;
+    // Range labels on the visible rings: along the 45° line, or when that
+    // point is off screen, along the bearing of the widget centre
+    const float step = ringSpacing();
+    int decimals = 1;
+    for (float scaled = step * 10.0f; decimals < 4 && std::abs(scaled - std::round(scaled)) > 1e-3f; scaled *= 10.0f) {
+        ++decimals;
+    }
+    const float bearingDegrees = static_cast<float>(
+        qRadiansToDegrees(std::atan2(width() / 2.0 - m_origin.x(), m_origin.y() - height() / 2.0)));
+    const float bearing = qDegreesToRadians(
+        std::max(MIN_AZIMUTH + 5.0f, std::min(MAX_AZIMUTH - 5.0f, bearingDegrees)));
+    float nearest, farthest;
+    visibleDistances(nearest, farthest);
+    const int firstRing = std::max(1, static_cast<int>(std::ceil(nearest / step)));
+    const int lastRing = static_cast<int>(std::min(farthest, m_maxRange) / step + 1e-3f);
+    for (int i = firstRing; i <= lastRing; ++i) {
+        float range = i * step;
+        float radius = range * m_pixelsPerMeter;
         
-        QPointF labelPos(m_center.x() + radius * 0.707f, m_center.y() - radius * 0.707f);
-        QString rangeText = QString("%1").arg(range, 0, 'f', 1) + "m";
+        QPointF labelPos(m_origin.x() + radius * 0.707f, m_origin.y() - radius * 0.707f);
+        if (!rect().contains(labelPos.toPoint())) {
+            labelPos = QPointF(m_origin.x() + radius * std::sin(bearing), m_origin.y() - radius * std::cos(bearing));
+        }
+        QString rangeText = QString("%1").arg(range, 0, 'f', decimals) + "m";
         painter.drawText(labelPos, rangeText);
     }
     
@@ -161,13 +701,14 @@ void PPIWidget::drawLabels(QPainter& painter)
     QFont azFont("Arial", 12, QFont::Bold);
     painter.setFont(azFont);
     
+    const float labelRadius = m_plotRadius * m_zoom + 20;
     for (int i = 0; i < NUM_AZIMUTH_LINES; i += 2) { // Label every other line
         float azimuth = MIN_AZIMUTH + (float(i) / (NUM_AZIMUTH_LINES - 1)) * (MAX_AZIMUTH - MIN_AZIMUTH);
         float radians = qDegreesToRadians(90.0f - azimuth);
         
         QPointF labelPos(
-            m_center.x() + (m_plotRadius + 20) * std::cos(radians),
-            m_center.y() - (m_plotRadius + 20) * std::sin(radians)
+            m_origin.x() + labelRadius * std::cos(radians),
+            m_origin.y() - labelRadius * std::sin(radians)
         );
         
         QString azText = QString("%1°").arg(azimuth, 0, 'f', 0);
@@ -181,6 +722,10 @@ void PPIWidget::drawLabels(QPainter& painter)
     // Title
     painter.setFont(QFont("Arial", 14, QFont::Bold));
     painter.drawText(QPointF(10, 25), "PPI Display - Target Tracks");
+    if (m_zoom > 1.0f) {
+        painter.setFont(QFont("Arial", 10));
+        painter.drawText(QPointF(10, 45), QString("Zoom x%1 (double-click to reset)").arg(m_zoom, 0, 'f', 1));
+    }
 }
 
 QColor PPIWidget::getTargetColor(float radialSpeed) const
@@ -203,16 +748,38 @@ QColor PPIWidget::getTargetColor(float radialSpeed) const
     }
 }
 
+int PPIWidget::colorBucket(float radialSpeed)
+{
+    // Same thresholds and intensity ramp as getTargetColor()
+    const float speed = std::abs(radialSpeed);
+    if (!(speed >= 1.0f)) {
+        return 0;
+    }
+    const float intensity = std::min(255.0f, 50.0f + speed * 10.0f);
+    const int step = std::min(SPEED_COLOR_STEPS - 1, static_cast<int>((intensity - 50.0f) * SPEED_COLOR_STEPS / 206.0f));
+    return 1 + step + (radialSpeed < 0 ? SPEED_COLOR_STEPS : 0);
+}
+
+QColor PPIWidget::bucketColor(int bucket) const
+{
+    if (bucket == 0) {
+        return getTargetColor(0.0f);
+    }
+    // Speed in the middle of the step's intensity range
+    const int step = (bucket - 1) % SPEED_COLOR_STEPS;
+    const float speed = (step + 0.5f) * 20.6f / SPEED_COLOR_STEPS;
+    return getTargetColor(bucket > SPEED_COLOR_STEPS ? -speed : speed);
+}
+
 QPointF PPIWidget::polarToCartesian(float range, float azimuth) const
 {
-    // Normalize range to plot radius
-    float normalizedRange = (range / m_maxRange) * m_plotRadius;
-    
     // Convert azimuth to radians (0° is up/north, positive is clockwise)
     float radians = qDegreesToRadians(90.0f - azimuth);
     
-    return QPointF(
-        m_center.x() + normalizedRange * std::cos(radians),
-        m_center.y() - normalizedRange * std::sin(radians)
-    );
+    return toScreen(range * std::cos(radians), range * std::sin(radians));
+}
+
+bool PPIWidget::isInView(float range, float azimuth) const
+{
+    return azimuth >= MIN_AZIMUTH && azimuth <= MAX_AZIMUTH && range <= m_maxRange;
 }
@@ -1,40 +1,162 @@
 #pragma once
 
 #include <QWidget>
+#include <QImage>
+#include <QLineF>
 #include <QPainter>
 #include <QTimer>
 #include <vector>
 #include "DataStructures.h"
+#include "LabelPlacer.h"
+#include "PolarRasterLut.h"
+#include "RangeAzimuthMap.h"
+#include "TrackGridIndex.h"
+#include "TrackHistory.h"
 
 class PPIWidget : public QWidget
 {
     Q_OBJECT
 
 public:
+    // Target ID labels: placed without overlap, strongest (level) or
+    // fastest (|radial speed|) targets first, or all at a fixed offset
+    enum class LabelMode {
+        ByLevel,
+        BySpeed,
+        All,
+        Off
+    };
+    
     explicit PPIWidget(QWidget *parent = nullptr);
     
     void updateTargets(const TargetTrackData& trackData);
     void setMaxRange(float range);
+    void setShowTrails(bool show);
+    void setTrailLength(int length);
+    // Forgets trails and persistence, e.g. when jumping in time
+    void clearHistory();
+    // Phosphor-style persistence: returns accumulate in an offscreen image
+    // that is dimmed once per update, halving every `halfLifeFrames` updates
+    void setPersistence(bool enabled);
+    void setPersistenceHalfLife(double halfLifeFrames);
+    // Range-azimuth heatmap of raw ADC frames under the tracks. Range bins
+    // span the display radius unless a bin size in metres is given.
+    void setShowHeatmap(bool show);
+    void setHeatmapRangeResolution(float metersPerBin);
+    void updateRawFrame(const RawADCFrame& frame);
+    void setLabelMode(LabelMode mode);
+    // View transform: the mouse wheel zooms about the cursor, a left drag
+    // pans and a double-click returns to the full semicircle. `anchor` (widget
+    // pixels) stays over the same ground point.
+    void setZoom(float zoom, const QPointF& anchor);
+    void resetView();
+    float zoom() const { return m_zoom; }
+    // Load shedding: no target labels, whatever the label mode
+    void setLabelsEnabled(bool enabled);
+    // Paint time since the last call (measured with instrumentation off too)
+    uint64_t takePaintTimeNs();
     
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
 
 private:
     void drawBackground(QPainter& painter);
     void drawRangeRings(QPainter& painter);
     void drawAzimuthLines(QPainter& painter);
+    void drawTrails(QPainter& painter);
+    void accumulatePersistence();
+    void rebuildHeatmapLut();
+    void renderHeatmap();
     void drawTargets(QPainter& painter);
+    void drawTargetLabels(QPainter& painter);
     void drawLabels(QPainter& painter);
+    void updateTransform();
+    void viewChanged();
+    // Range ring spacing in metres for the current zoom
+    float ringSpacing() const;
+    // Distance range (metres from the antenna) covered by the widget
+    void visibleDistances(float& nearest, float& farthest) const;
     
     QColor getTargetColor(float radialSpeed) const;
+    // Marker colours quantised for batched drawing, and back
+    static int colorBucket(float radialSpeed);
+    QColor bucketColor(int bucket) const;
     QPointF polarToCartesian(float range, float azimuth) const;
+    // x east / y north in metres
+    QPointF toScreen(float x, float y) const
+    {
+        return QPointF(m_origin.x() + x * m_pixelsPerMeter, m_origin.y() - y * m_pixelsPerMeter);
+    }
+    bool isInView(float range, float azimuth) const;
     
     TargetTrackData m_currentTargets;
     float m_maxRange;
     QRect m_plotRect;
     QPointF m_center;
     float m_plotRadius;
+    uint64_t m_paintedTimestamp;  // last frame recorded into the end-to-end histogram
+    uint64_t m_paintTimeNs;
+    
+    // View transform: m_pan moves the antenna away from m_center, m_origin
+    // is where it ends up on screen
+    float m_zoom;
+    QPointF m_pan;
+    QPointF m_origin;
+    float m_pixelsPerMeter;
+    bool m_dragging;
+    QPoint m_dragStart;
+    QPointF m_dragStartPan;
+    static constexpr float MAX_ZOOM = 256.0f;
+    
+    // Tracks in view, indexed once per update so a paint only touches the
+    // visible ones. Past MAX_DETAILED_TARGETS the markers become unlabelled
+    // squares drawn in one batch per colour.
+    static constexpr size_t MAX_DETAILED_TARGETS = 2000;
+    static constexpr int SPEED_COLOR_STEPS = 8;
+    static constexpr int MARKER_COLOR_BUCKETS = 1 + 2 * SPEED_COLOR_STEPS;
+    TrackGridIndex m_trackIndex;
+    std::vector<uint32_t> m_visibleSlots;
+    std::vector<QPointF> m_markerBatches[MARKER_COLOR_BUCKETS];
+    
+    // Trails are batched by age so each fade step is a single drawLines call
+    static constexpr int TRAIL_FADE_STEPS = 4;
+    TrackHistory m_trackHistory;
+    bool m_showTrails;
+    std::vector<QLineF> m_trailSegments[TRAIL_FADE_STEPS];
+    
+    bool m_persistence;
+    uint32_t m_decayFactor;     // per update, out of 256
+    QImage m_persistenceImage;  // widget-sized, premultiplied ARGB
+    
+    // The LUT depends on geometry only, so a frame costs one gather pass
+    bool m_showHeatmap;
+    bool m_heatmapValid;        // m_rangeAzimuth holds a processed frame
+    float m_heatmapRangeResolution;
+    RangeAzimuthMap m_rangeAzimuth;
+    PolarRasterLut m_heatmapLut;
+    std::vector<uint32_t> m_heatmapColors;  // premultiplied ARGB per map cell
+    QImage m_heatmapImage;      // bounding box of the semicircle
+    QPoint m_heatmapOrigin;
+    static constexpr float HEATMAP_DYNAMIC_RANGE_DB = 40.0f;
+    
+    // Labels of the targets drawn this frame, placed in one pass
+    LabelMode m_labelMode;
+    bool m_labelsEnabled;
+    LabelPlacer m_labelPlacer;
+    std::vector<LabelPlacer::Label> m_labels;
+    std::vector<uint32_t> m_labelIds;
+    std::vector<LabelPlacer::Placement> m_labelPlacements;
+    QFont m_labelFont;
+    float m_labelDigitWidth;
+    float m_labelAscent;
+    float m_labelHeight;
+    static constexpr float TARGET_MARKER_RADIUS = 5.0f;
     
     // Visual settings
     static constexpr int NUM_RANGE_RINGS = 5;
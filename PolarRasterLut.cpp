@@ -0,0 +1,83 @@
+#include "PolarRasterLut.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Row bands per thread; a few per thread evens out the empty corners
+constexpr size_t BANDS_PER_THREAD = 4;
+
+template <typename Fn>
+void forEachRowBand(int height, Fn&& fn)
+{
+    ThreadPool& pool = ThreadPool::instance();
+    const size_t bands = std::min<size_t>(height, pool.concurrency() * BANDS_PER_THREAD);
+    if (bands == 0) {
+        return;
+    }
+    const size_t rowsPerBand = (height + bands - 1) / bands;
+    pool.parallelFor(bands, [&](size_t band) {
+        const int first = static_cast<int>(band * rowsPerBand);
+        const int last = std::min(height, static_cast<int>((band + 1) * rowsPerBand));
+        fn(first, last);
+    });
+}
+
+} // namespace
+
+void PolarRasterLut::build(const Geometry& geometry)
+{
+    m_geometry = geometry;
+    const int width = std::max(0, geometry.width);
+    const int height = std::max(0, geometry.height);
+    if (width == 0 || height == 0 || geometry.radius <= 0.0f ||
+        geometry.rangeBins == 0 || geometry.azimuthBins == 0) {
+        m_cells.clear();
+        return;
+    }
+    m_cells.resize(size_t(width) * height);
+
+    const float binsPerPixel = geometry.rangeBinsPerRadius / geometry.radius;
+    const float azimuthScale = geometry.azimuthBins / 2.0f;
+    forEachRowBand(height, [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; ++y) {
+            int32_t* row = &m_cells[size_t(y) * width];
+            const float dy = geometry.centerY - (y + 0.5f);
+            for (int x = 0; x < width; ++x) {
+                const float dx = (x + 0.5f) - geometry.centerX;
+                const float distance = std::sqrt(dx * dx + dy * dy);
+                const float azimuth = std::atan2(dx, dy) * 180.0f / float(M_PI);
+                const size_t rangeBin = static_cast<size_t>(distance * binsPerPixel);
+                if (dy < 0.0f || distance > geometry.radius || rangeBin >= geometry.rangeBins ||
+                    azimuth < geometry.minAzimuth || azimuth > geometry.maxAzimuth) {
+                    row[x] = OUTSIDE;
+                    continue;
+                }
+                // Same bin mapping as RangeAzimuthMap::binForAzimuth, from the pixel's sine
+                const float sine = distance > 0.0f ? dx / distance : 0.0f;
+                const size_t azimuthBin = std::min(geometry.azimuthBins - 1,
+                    static_cast<size_t>(std::max(0.0f, azimuthScale + sine * azimuthScale + 0.5f)));
+                row[x] = static_cast<int32_t>(azimuthBin * geometry.rangeBins + rangeBin);
+            }
+        }
+    });
+}
+
+void PolarRasterLut::scanConvert(const uint32_t* cellColors, uint32_t* pixels, size_t pixelsPerLine) const
+{
+    if (m_cells.empty()) {
+        return;
+    }
+    const int width = m_geometry.width;
+    forEachRowBand(m_geometry.height, [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; ++y) {
+            const int32_t* cells = &m_cells[size_t(y) * width];
+            uint32_t* out = pixels + size_t(y) * pixelsPerLine;
+            for (int x = 0; x < width; ++x) {
+                const int32_t cell = cells[x];
+                out[x] = cell == OUTSIDE ? 0u : cellColors[cell];
+            }
+        }
+    });
+}
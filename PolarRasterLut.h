@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Screen-pixel -> polar cell lookup for drawing a range/azimuth grid into a
+// semicircular PPI. build() does the per-pixel trigonometry and only runs
+// when the geometry changes; scanConvert() is then a single gather pass,
+// split into row bands on the ThreadPool.
+class PolarRasterLut
+{
+public:
+    struct Geometry {
+        int width = 0;               // raster size in pixels
+        int height = 0;
+        float centerX = 0.0f;        // antenna position in raster pixels
+        float centerY = 0.0f;
+        float radius = 0.0f;         // pixels at full display range
+        float minAzimuth = -90.0f;   // degrees, 0 = up, positive clockwise
+        float maxAzimuth = 90.0f;
+        size_t rangeBins = 0;
+        float rangeBinsPerRadius = 0.0f;  // range bins spanned by `radius`
+        size_t azimuthBins = 0;      // uniform in sin(azimuth), broadside in the middle
+    };
+
+    void build(const Geometry& geometry);
+    const Geometry& geometry() const { return m_geometry; }
+    bool isValid() const { return !m_cells.empty(); }
+
+    // pixels[y * pixelsPerLine + x] = cellColors[azimuthBin * rangeBins + rangeBin],
+    // or 0 (transparent) outside the covered area
+    void scanConvert(const uint32_t* cellColors, uint32_t* pixels, size_t pixelsPerLine) const;
+
+private:
+    static constexpr int32_t OUTSIDE = -1;
+
+    Geometry m_geometry;
+    std::vector<int32_t> m_cells;  // cell index per pixel, row-major
+};
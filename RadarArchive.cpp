@@ -0,0 +1,450 @@
+#include "RadarArchive.h"
+#include "TrackMerger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t FILE_MAGIC = 0x31414452;   // "RDA1"
+constexpr uint32_t BLOCK_MAGIC = 0x4B4C4252;  // "RBLK"
+constexpr uint32_t FORMAT_VERSION = 2;
+constexpr size_t FILE_HEADER_BYTES = 64;
+constexpr size_t BLOCK_HEADER_BYTES = 64;
+
+constexpr size_t TRACK_COLUMNS = 8;  // one per TargetTrack field
+constexpr size_t SPECTRUM_COLUMNS = 1;
+
+// Frame columns follow the block header, row columns follow those
+constexpr size_t F = ArchiveStream::FRAMES_PER_BLOCK;
+constexpr size_t TIMESTAMP_OFFSET = BLOCK_HEADER_BYTES;
+constexpr size_t SOURCE_TIMESTAMP_OFFSET = TIMESTAMP_OFFSET + F * sizeof(uint64_t);
+constexpr size_t ROW_BEGIN_OFFSET = SOURCE_TIMESTAMP_OFFSET + F * sizeof(uint64_t);
+constexpr size_t ROW_COUNT_OFFSET = ROW_BEGIN_OFFSET + F * sizeof(uint32_t);
+constexpr size_t SOURCE_OFFSET = ROW_COUNT_OFFSET + F * sizeof(uint32_t);
+constexpr size_t FRAME_NUMBER_OFFSET = SOURCE_OFFSET + F * sizeof(uint32_t);
+constexpr size_t FLAGS_OFFSET = FRAME_NUMBER_OFFSET + F * sizeof(uint32_t);
+constexpr size_t ROWS_OFFSET = FLAGS_OFFSET + F * sizeof(uint32_t);
+static_assert(ROWS_OFFSET % 64 == 0, "row columns should start cache-line aligned");
+
+template <typename T>
+T* at(uint8_t* block, size_t offset)
+{
+    return reinterpret_cast<T*>(block + offset);
+}
+
+template <typename T>
+const T* at(const uint8_t* block, size_t offset)
+{
+    return reinterpret_cast<const T*>(block + offset);
+}
+
+} // namespace
+
+struct ArchiveStream::FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t rowColumns;
+    uint32_t blockBytes;
+    uint32_t framesPerBlock;
+    uint32_t rowsPerBlock;
+};
+
+struct ArchiveStream::BlockHeader {
+    uint32_t magic;
+    uint32_t frames;
+    uint32_t rows;
+    uint32_t sourceMask;
+    uint64_t firstTimestamp;
+    uint64_t lastTimestamp;
+};
+
+ArchiveStream::ArchiveStream(Kind kind, size_t rowColumns)
+    : m_kind(kind)
+    , m_rowColumns(rowColumns)
+    // Multiple of 16 rows keeps every column 64-byte aligned
+    , m_rowsPerBlock((BLOCK_BYTES - ROWS_OFFSET) / (4 * rowColumns) / 16 * 16)
+{
+    static_assert(sizeof(FileHeader) <= FILE_HEADER_BYTES, "file header too large");
+    static_assert(sizeof(BlockHeader) <= BLOCK_HEADER_BYTES, "block header too large");
+}
+
+size_t ArchiveStream::dataOffset(size_t block)
+{
+    return FILE_HEADER_BYTES + block * BLOCK_BYTES;
+}
+
+uint8_t* ArchiveStream::blockData(size_t block)
+{
+    return m_file.data() + dataOffset(block);
+}
+
+const uint8_t* ArchiveStream::blockData(size_t block) const
+{
+    return m_file.data() + dataOffset(block);
+}
+
+bool ArchiveStream::create(const std::string& path)
+{
+    close();
+    if (!m_file.open(path, MappedFile::Mode::ReadWrite) ||
+        !m_file.resize(dataOffset(GROWTH_BLOCKS))) {
+        m_file.close();
+        return false;
+    }
+    FileHeader* header = at<FileHeader>(m_file.data(), 0);
+    header->magic = FILE_MAGIC;
+    header->version = FORMAT_VERSION;
+    header->kind = static_cast<uint32_t>(m_kind);
+    header->rowColumns = static_cast<uint32_t>(m_rowColumns);
+    header->blockBytes = static_cast<uint32_t>(BLOCK_BYTES);
+    header->framesPerBlock = static_cast<uint32_t>(FRAMES_PER_BLOCK);
+    header->rowsPerBlock = static_cast<uint32_t>(m_rowsPerBlock);
+    m_writing = true;
+    return true;
+}
+
+bool ArchiveStream::openRead(const std::string& path)
+{
+    close();
+    if (!m_file.open(path, MappedFile::Mode::ReadOnly) || m_file.size() < FILE_HEADER_BYTES) {
+        m_file.close();
+        return false;
+    }
+    const FileHeader* header = at<FileHeader>(m_file.data(), 0);
+    if (header->magic != FILE_MAGIC || header->version != FORMAT_VERSION ||
+        header->kind != static_cast<uint32_t>(m_kind) || header->rowColumns != m_rowColumns ||
+        header->blockBytes != BLOCK_BYTES || header->framesPerBlock != FRAMES_PER_BLOCK ||
+        header->rowsPerBlock != m_rowsPerBlock) {
+        m_file.close();
+        return false;
+    }
+    return refresh();
+}
+
+void ArchiveStream::close()
+{
+    if (m_writing) {
+        m_file.resize(dataOffset(m_blockCount));
+        m_writing = false;
+    }
+    m_file.close();
+    m_blockCount = 0;
+    m_lastTimestamp = 0;
+    m_pendingRow = nullptr;
+    m_droppedRows = 0;
+    m_index.clear();
+    m_frameCount = 0;
+    m_sourceMask = 0;
+}
+
+bool ArchiveStream::startBlock()
+{
+    if (dataOffset(m_blockCount + 1) > m_file.size() &&
+        !m_file.resize(dataOffset(m_blockCount + GROWTH_BLOCKS))) {
+        return false;
+    }
+    BlockHeader* header = at<BlockHeader>(blockData(m_blockCount), 0);
+    std::memset(header, 0, BLOCK_HEADER_BYTES);
+    header->magic = BLOCK_MAGIC;
+    ++m_blockCount;
+    return true;
+}
+
+size_t ArchiveStream::beginFrame(uint64_t timestamp, uint64_t sourceTimestamp, uint32_t source,
+                                 uint32_t frameNumber, uint32_t flags, size_t rows)
+{
+    m_pendingRow = nullptr;
+    if (!m_writing) {
+        return 0;
+    }
+    if (rows > m_rowsPerBlock) {
+        m_droppedRows += rows - m_rowsPerBlock;
+        rows = m_rowsPerBlock;
+    }
+
+    BlockHeader* header = m_blockCount ? at<BlockHeader>(blockData(m_blockCount - 1), 0) : nullptr;
+    if (!header || header->frames == FRAMES_PER_BLOCK || header->rows + rows > m_rowsPerBlock) {
+        if (!startBlock()) {
+            m_droppedRows += rows;
+            return 0;
+        }
+    }
+    uint8_t* block = blockData(m_blockCount - 1);
+    header = at<BlockHeader>(block, 0);
+
+    m_lastTimestamp = std::max(m_lastTimestamp, timestamp);
+    const uint32_t f = header->frames;
+    at<uint64_t>(block, TIMESTAMP_OFFSET)[f] = m_lastTimestamp;
+    at<uint64_t>(block, SOURCE_TIMESTAMP_OFFSET)[f] = sourceTimestamp;
+    at<uint32_t>(block, ROW_BEGIN_OFFSET)[f] = header->rows;
+    at<uint32_t>(block, ROW_COUNT_OFFSET)[f] = static_cast<uint32_t>(rows);
+    at<uint32_t>(block, SOURCE_OFFSET)[f] = source;
+    at<uint32_t>(block, FRAME_NUMBER_OFFSET)[f] = frameNumber;
+    at<uint32_t>(block, FLAGS_OFFSET)[f] = flags;
+    m_pendingRow = block + ROWS_OFFSET + header->rows * sizeof(uint32_t);
+    return rows;
+}
+
+void ArchiveStream::commitFrame()
+{
+    if (!m_pendingRow) {
+        return;
+    }
+    uint8_t* block = blockData(m_blockCount - 1);
+    BlockHeader* header = at<BlockHeader>(block, 0);
+    const uint32_t f = header->frames;
+    if (f == 0) {
+        header->firstTimestamp = m_lastTimestamp;
+    }
+    header->lastTimestamp = m_lastTimestamp;
+    header->rows += at<uint32_t>(block, ROW_COUNT_OFFSET)[f];
+    header->sourceMask |= 1u << (at<uint32_t>(block, SOURCE_OFFSET)[f] & 31);
+    header->frames = f + 1;
+    m_pendingRow = nullptr;
+}
+
+bool ArchiveStream::refresh()
+{
+    if (!m_file.isOpen() || !m_file.remap()) {
+        return false;
+    }
+    // The last indexed block may have gained frames since
+    size_t block = m_index.empty() ? 0 : m_index.size() - 1;
+    if (!m_index.empty()) {
+        m_frameCount -= m_index.back().frames;
+        m_index.pop_back();
+    }
+    for (; dataOffset(block + 1) <= m_file.size(); ++block) {
+        const BlockHeader* header = at<BlockHeader>(blockData(block), 0);
+        if (header->magic != BLOCK_MAGIC || header->frames == 0) {
+            break;
+        }
+        m_index.push_back(BlockIndex{header->firstTimestamp, header->lastTimestamp, header->frames});
+        m_frameCount += header->frames;
+        m_sourceMask |= header->sourceMask;
+    }
+    return true;
+}
+
+uint64_t ArchiveStream::firstTimestamp() const
+{
+    return m_index.empty() ? 0 : m_index.front().firstTimestamp;
+}
+
+uint64_t ArchiveStream::lastTimestamp() const
+{
+    return m_index.empty() ? 0 : m_index.back().lastTimestamp;
+}
+
+bool ArchiveStream::seek(uint64_t timestamp, Cursor& cursor) const
+{
+    auto block = std::lower_bound(m_index.begin(), m_index.end(), timestamp,
+                                  [](const BlockIndex& index, uint64_t t) { return index.lastTimestamp < t; });
+    if (block == m_index.end()) {
+        return false;
+    }
+    cursor.block = static_cast<size_t>(block - m_index.begin());
+    const uint64_t* timestamps = at<uint64_t>(blockData(cursor.block), TIMESTAMP_OFFSET);
+    cursor.frame = static_cast<size_t>(
+        std::lower_bound(timestamps, timestamps + block->frames, timestamp) - timestamps);
+    return true;
+}
+
+bool ArchiveStream::seekBefore(uint64_t timestamp, Cursor& cursor) const
+{
+    auto block = std::upper_bound(m_index.begin(), m_index.end(), timestamp,
+                                  [](uint64_t t, const BlockIndex& index) { return t < index.firstTimestamp; });
+    if (block == m_index.begin()) {
+        return false;
+    }
+    --block;
+    cursor.block = static_cast<size_t>(block - m_index.begin());
+    const uint64_t* timestamps = at<uint64_t>(blockData(cursor.block), TIMESTAMP_OFFSET);
+    cursor.frame = static_cast<size_t>(
+        std::upper_bound(timestamps, timestamps + block->frames, timestamp) - timestamps) - 1;
+    return true;
+}
+
+bool ArchiveStream::frameAt(const Cursor& cursor, Frame& frame) const
+{
+    if (cursor.block >= m_index.size() || cursor.frame >= m_index[cursor.block].frames) {
+        return false;
+    }
+    const uint8_t* block = blockData(cursor.block);
+    const size_t f = cursor.frame;
+    frame.timestamp = at<uint64_t>(block, TIMESTAMP_OFFSET)[f];
+    frame.sourceTimestamp = at<uint64_t>(block, SOURCE_TIMESTAMP_OFFSET)[f];
+    frame.rows = at<uint32_t>(block, ROW_COUNT_OFFSET)[f];
+    frame.source = at<uint32_t>(block, SOURCE_OFFSET)[f];
+    frame.frameNumber = at<uint32_t>(block, FRAME_NUMBER_OFFSET)[f];
+    frame.flags = at<uint32_t>(block, FLAGS_OFFSET)[f];
+    frame.firstRow = block + ROWS_OFFSET + at<uint32_t>(block, ROW_BEGIN_OFFSET)[f] * sizeof(uint32_t);
+    frame.columnStride = columnStride();
+    return true;
+}
+
+bool ArchiveStream::next(Cursor& cursor) const
+{
+    if (cursor.block >= m_index.size()) {
+        return false;
+    }
+    if (++cursor.frame >= m_index[cursor.block].frames) {
+        ++cursor.block;
+        cursor.frame = 0;
+    }
+    return cursor.block < m_index.size();
+}
+
+ArchiveWriter::ArchiveWriter()
+    : m_tracks(ArchiveStream::Kind::Tracks, TRACK_COLUMNS)
+    , m_spectra(ArchiveStream::Kind::Spectra, SPECTRUM_COLUMNS)
+{
+}
+
+bool ArchiveWriter::open(const std::string& basePath)
+{
+    if (!m_tracks.create(basePath + ".tracks") || !m_spectra.create(basePath + ".spectra")) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ArchiveWriter::close()
+{
+    m_tracks.close();
+    m_spectra.close();
+}
+
+void ArchiveWriter::writeTracks(size_t source, const TargetTrackData& trackData, uint64_t receivedUs)
+{
+    const size_t count = std::min<size_t>(trackData.numTracks, trackData.targets.size());
+    const size_t rows = m_tracks.beginFrame(receivedUs, trackData.timestamp_us, static_cast<uint32_t>(source),
+                                            0, 0, count);
+    if (rows == 0 && count > 0) {
+        return;
+    }
+    uint32_t* ids = m_tracks.column<uint32_t>(0);
+    float* level = m_tracks.column<float>(1);
+    float* radius = m_tracks.column<float>(2);
+    float* azimuth = m_tracks.column<float>(3);
+    float* elevation = m_tracks.column<float>(4);
+    float* radialSpeed = m_tracks.column<float>(5);
+    float* azimuthSpeed = m_tracks.column<float>(6);
+    float* elevationSpeed = m_tracks.column<float>(7);
+    for (size_t i = 0; i < rows; ++i) {
+        const TargetTrack& target = trackData.targets[i];
+        ids[i] = target.target_id;
+        level[i] = target.level;
+        radius[i] = target.radius;
+        azimuth[i] = target.azimuth;
+        elevation[i] = target.elevation;
+        radialSpeed[i] = target.radial_speed;
+        azimuthSpeed[i] = target.azimuth_speed;
+        elevationSpeed[i] = target.elevation_speed;
+    }
+    m_tracks.commitFrame();
+}
+
+void ArchiveWriter::writeSpectrum(size_t source, uint64_t receivedUs, uint64_t timestampUs,
+                                  uint32_t frameNumber, const std::vector<float>& magnitude, bool twoSided)
+{
+    const size_t rows = m_spectra.beginFrame(receivedUs, timestampUs, static_cast<uint32_t>(source),
+                                             frameNumber, twoSided ? SPECTRUM_TWO_SIDED : 0, magnitude.size());
+    if (rows == 0 && !magnitude.empty()) {
+        return;
+    }
+    if (rows > 0) {
+        std::memcpy(m_spectra.column<float>(0), magnitude.data(), rows * sizeof(float));
+    }
+    m_spectra.commitFrame();
+}
+
+ArchiveReader::ArchiveReader()
+    : m_tracks(ArchiveStream::Kind::Tracks, TRACK_COLUMNS)
+    , m_spectra(ArchiveStream::Kind::Spectra, SPECTRUM_COLUMNS)
+{
+}
+
+bool ArchiveReader::open(const std::string& basePath)
+{
+    if (!m_tracks.openRead(basePath + ".tracks") || !m_spectra.openRead(basePath + ".spectra")) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ArchiveReader::close()
+{
+    m_tracks.close();
+    m_spectra.close();
+}
+
+bool ArchiveReader::refresh()
+{
+    return m_tracks.refresh() && m_spectra.refresh();
+}
+
+uint64_t ArchiveReader::firstTimestamp() const
+{
+    const uint64_t tracks = m_tracks.firstTimestamp();
+    const uint64_t spectra = m_spectra.firstTimestamp();
+    if (tracks == 0 || spectra == 0) {
+        return std::max(tracks, spectra);
+    }
+    return std::min(tracks, spectra);
+}
+
+uint64_t ArchiveReader::lastTimestamp() const
+{
+    return std::max(m_tracks.lastTimestamp(), m_spectra.lastTimestamp());
+}
+
+bool ArchiveReader::tracksAt(uint64_t timestampUs, uint64_t maxAgeUs, TargetTrackData& trackData) const
+{
+    const uint64_t begin = timestampUs > maxAgeUs ? timestampUs - maxAgeUs : 0;
+    m_latestPerSource.clear();
+    m_tracks.forEachFrame(begin, timestampUs, [this](const ArchiveStream::Frame& frame) {
+        for (ArchiveStream::Frame& latest : m_latestPerSource) {
+            if (latest.source == frame.source) {
+                latest = frame;
+                return;
+            }
+        }
+        m_latestPerSource.push_back(frame);
+    });
+    if (m_latestPerSource.empty()) {
+        return false;
+    }
+
+    const uint32_t mask = m_tracks.sourceMask();
+    const bool severalSources = (mask & (mask - 1)) != 0;
+    trackData.targets.clear();
+    trackData.timestamp_us = 0;
+    for (const ArchiveStream::Frame& frame : m_latestPerSource) {
+        const uint32_t* ids = frame.column<uint32_t>(0);
+        for (uint32_t i = 0; i < frame.rows; ++i) {
+            TargetTrack target;
+            target.target_id = severalSources ? TrackMerger::mergedId(frame.source, ids[i]) : ids[i];
+            target.level = frame.column<float>(1)[i];
+            target.radius = frame.column<float>(2)[i];
+            target.azimuth = frame.column<float>(3)[i];
+            target.elevation = frame.column<float>(4)[i];
+            target.radial_speed = frame.column<float>(5)[i];
+            target.azimuth_speed = frame.column<float>(6)[i];
+            target.elevation_speed = frame.column<float>(7)[i];
+            trackData.targets.push_back(target);
+        }
+        trackData.timestamp_us = std::max(trackData.timestamp_us, frame.timestamp);
+    }
+    trackData.numTracks = static_cast<uint32_t>(trackData.targets.size());
+    return true;
+}
+
+bool ArchiveReader::spectrumAt(uint64_t timestampUs, ArchiveStream::Frame& spectrum) const
+{
+    ArchiveStream::Cursor cursor;
+    return m_spectra.seekBefore(timestampUs, cursor) && m_spectra.frameAt(cursor, spectrum);
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DataStructures.h"
+#include "MappedFile.h"
+
+// One archive file: a short file header followed by fixed-size blocks.
+// Each block stores up to FRAMES_PER_BLOCK frames as columns (timestamp,
+// source timestamp, first row, row count, source, frame number, flags) and
+// their rows as 4-byte columns (one column per TargetTrack field, or the
+// magnitude of a spectrum), so a query touches only the pages of the blocks
+// it reads. The timestamp is local time, which never decreases within a
+// file: when the frame was received, or for spectra (computed at display
+// time) when it was shown. The sender's own timestamp is kept as is in its
+// own column, since source clocks may be skewed against each other. The
+// block headers (first/last timestamp) form a sparse time index that the
+// reader keeps in memory; frames within a block are found by binary search
+// on the timestamp column.
+class ArchiveStream
+{
+public:
+    enum class Kind : uint32_t {
+        Tracks = 1,
+        Spectra = 2
+    };
+
+    static constexpr size_t BLOCK_BYTES = size_t(1) << 20;
+    static constexpr size_t FRAMES_PER_BLOCK = 4096;
+    static constexpr size_t GROWTH_BLOCKS = 16;  // file grows 16 MiB at a time
+
+    // Read view of one stored frame, valid until the next refresh()
+    struct Frame {
+        uint64_t timestamp = 0;        // local receive (spectra: display) time
+        uint64_t sourceTimestamp = 0;  // as sent
+        uint32_t source = 0;
+        uint32_t frameNumber = 0;
+        uint32_t flags = 0;
+        uint32_t rows = 0;
+        const uint8_t* firstRow = nullptr;  // column 0, row 0 of this frame
+        size_t columnStride = 0;            // bytes between columns
+
+        template <typename T>
+        const T* column(size_t c) const
+        {
+            return reinterpret_cast<const T*>(firstRow + c * columnStride);
+        }
+    };
+
+    // Position of a frame: block index and frame index within it
+    struct Cursor {
+        size_t block = 0;
+        size_t frame = 0;
+    };
+
+    ArchiveStream(Kind kind, size_t rowColumns);
+
+    bool create(const std::string& path);
+    bool openRead(const std::string& path);
+    // Writers trim the preallocated tail
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Writing. beginFrame() returns the row capacity granted (rows beyond a
+    // block are cut), column() the frame's first row in column c, and
+    // commitFrame() makes the frame visible to readers. A timestamp older
+    // than the previous frame's (the local clock stepped back) is raised
+    // to it, so the column stays sorted.
+    size_t beginFrame(uint64_t timestamp, uint64_t sourceTimestamp, uint32_t source, uint32_t frameNumber,
+                      uint32_t flags, size_t rows);
+    template <typename T>
+    T* column(size_t c) { return reinterpret_cast<T*>(m_pendingRow + c * columnStride()); }
+    void commitFrame();
+    uint64_t droppedRows() const { return m_droppedRows; }
+    size_t bytesUsed() const { return dataOffset(m_blockCount); }
+
+    // Reading: picks up frames appended since the last call
+    bool refresh();
+    size_t frameCount() const { return m_frameCount; }
+    uint64_t firstTimestamp() const;
+    uint64_t lastTimestamp() const;
+    uint32_t sourceMask() const { return m_sourceMask; }  // bit per recorded source (mod 32)
+
+    // First frame at or after timestamp; false if there is none
+    bool seek(uint64_t timestamp, Cursor& cursor) const;
+    // Last frame at or before timestamp; false if there is none
+    bool seekBefore(uint64_t timestamp, Cursor& cursor) const;
+    bool frameAt(const Cursor& cursor, Frame& frame) const;
+    bool next(Cursor& cursor) const;
+
+    // Calls fn(const Frame&) for every frame with begin <= timestamp <= end
+    template <typename Fn>
+    void forEachFrame(uint64_t begin, uint64_t end, Fn&& fn) const
+    {
+        Cursor cursor;
+        Frame frame;
+        if (!seek(begin, cursor)) {
+            return;
+        }
+        do {
+            frameAt(cursor, frame);
+            if (frame.timestamp > end) {
+                break;
+            }
+            fn(frame);
+        } while (next(cursor));
+    }
+
+private:
+    struct FileHeader;
+    struct BlockHeader;
+
+    struct BlockIndex {
+        uint64_t firstTimestamp;
+        uint64_t lastTimestamp;
+        uint32_t frames;
+    };
+
+    size_t columnStride() const { return m_rowsPerBlock * 4; }
+    static size_t dataOffset(size_t block);
+    uint8_t* blockData(size_t block);
+    const uint8_t* blockData(size_t block) const;
+    bool startBlock();
+
+    Kind m_kind;
+    size_t m_rowColumns;
+    size_t m_rowsPerBlock;
+    MappedFile m_file;
+    bool m_writing = false;
+
+    // Writer state
+    size_t m_blockCount = 0;  // blocks holding at least one frame
+    uint64_t m_lastTimestamp = 0;
+    uint8_t* m_pendingRow = nullptr;
+    uint64_t m_droppedRows = 0;
+
+    // Reader state: the sparse time index
+    std::vector<BlockIndex> m_index;
+    size_t m_frameCount = 0;
+    uint32_t m_sourceMask = 0;
+};
+
+// Records decoded tracks and displayed spectra to <base>.tracks and
+// <base>.spectra. Tracks are indexed by the local time they were received,
+// in arrival order; spectra by the time they were displayed (receivedUs).
+class ArchiveWriter
+{
+public:
+    static constexpr uint32_t SPECTRUM_TWO_SIDED = 1;
+
+    ArchiveWriter();
+
+    bool open(const std::string& basePath);
+    void close();
+    bool isOpen() const { return m_tracks.isOpen(); }
+
+    void writeTracks(size_t source, const TargetTrackData& trackData, uint64_t receivedUs);
+    void writeSpectrum(size_t source, uint64_t receivedUs, uint64_t timestampUs, uint32_t frameNumber,
+                       const std::vector<float>& magnitude, bool twoSided);
+
+    size_t bytesUsed() const { return m_tracks.bytesUsed() + m_spectra.bytesUsed(); }
+    uint64_t droppedRows() const { return m_tracks.droppedRows() + m_spectra.droppedRows(); }
+
+private:
+    ArchiveStream m_tracks;
+    ArchiveStream m_spectra;
+};
+
+// Time-window queries over an archive, also while it is being written
+class ArchiveReader
+{
+public:
+    ArchiveReader();
+
+    bool open(const std::string& basePath);
+    void close();
+    bool isOpen() const { return m_tracks.isOpen(); }
+    bool refresh();
+
+    // Range of receive times covered by either stream, 0 when empty
+    uint64_t firstTimestamp() const;
+    uint64_t lastTimestamp() const;
+
+    // Latest frame of every source received no earlier than maxAgeUs before
+    // timestampUs.
+    // Target ids carry the source (TrackMerger::mergedId) when the archive
+    // holds more than one source. False if no source had a frame.
+    bool tracksAt(uint64_t timestampUs, uint64_t maxAgeUs, TargetTrackData& trackData) const;
+    // Last spectrum at or before timestampUs; column<float>(0) holds the
+    // magnitude, flags & ArchiveWriter::SPECTRUM_TWO_SIDED the layout
+    bool spectrumAt(uint64_t timestampUs, ArchiveStream::Frame& spectrum) const;
+
+    const ArchiveStream& tracks() const { return m_tracks; }
+    const ArchiveStream& spectra() const { return m_spectra; }
+
+private:
+    ArchiveStream m_tracks;
+    ArchiveStream m_spectra;
+    mutable std::vector<ArchiveStream::Frame> m_latestPerSource;  // tracksAt() scratch
+};
@@ -18,14 +18,76 @@ SOURCES += \
     main.cpp \
     MainWindow.cpp \
     PPIWidget.cpp \
-    FFTWidget.cpp
+    FFTWidget.cpp \
+    AdcKernels.cpp \
+    ThreadPool.cpp \
+    BufferPool.cpp \
+    AllocationCounter.cpp \
+    TextProtocolParser.cpp \
+    Instrumentation.cpp \
+    StatsOverlay.cpp \
+    TrackTableWidget.cpp \
+    RefreshScheduler.cpp \
+    SourceReceiver.cpp \
+    BinaryProtocol.cpp \
+    TrackCodec.cpp \
+    CfarDetector.cpp \
+    ClutterFilter.cpp \
+    DegradationController.cpp \
+    FftKernels.cpp \
+    TrackGridIndex.cpp \
+    TrackHistory.cpp \
+    TrackMerger.cpp \
+    RasterKernels.cpp \
+    RangeAzimuthMap.cpp \
+    PolarRasterLut.cpp \
+    LabelPlacer.cpp \
+    MappedFile.cpp \
+    RadarArchive.cpp \
+    SharedFrameRing.cpp \
+    Simulator.cpp \
+    SpectrumProcessor.cpp
 
 # Headers
 HEADERS += \
     MainWindow.h \
     PPIWidget.h \
     FFTWidget.h \
-    DataStructures.h
+    DataStructures.h \
+    AdcKernels.h \
+    ThreadPool.h \
+    BufferPool.h \
+    AllocationCounter.h \
+    TextProtocolParser.h \
+    Instrumentation.h \
+    StatsOverlay.h \
+    TrackTableWidget.h \
+    RefreshScheduler.h \
+    SourceReceiver.h \
+    BinaryProtocol.h \
+    TrackCodec.h \
+    CfarDetector.h \
+    ClutterFilter.h \
+    DegradationController.h \
+    FftKernels.h \
+    TrackGridIndex.h \
+    TrackHistory.h \
+    TrackMerger.h \
+    JitterBuffer.h \
+    RasterKernels.h \
+    RangeAzimuthMap.h \
+    PolarRasterLut.h \
+    LabelPlacer.h \
+    MappedFile.h \
+    RadarArchive.h \
+    SharedFrameRing.h \
+    Simulator.h \
+    SpectrumProcessor.h
+
+# Allocation-counting test hook: qmake CONFIG+=count_allocations
+count_allocations {
+    DEFINES += RADAR_COUNT_ALLOCATIONS
+}
 
 # Platform-specific configurations
 win32 {
@@ -37,6 +99,8 @@ unix:!macx {
     # Linux-specific settings
     target.path = /usr/local/bin
     INSTALLS += target
+    # shm_open for the shared-memory frame ring
+    LIBS += -lrt
 }
 
 macx {
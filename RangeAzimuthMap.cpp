@@ -0,0 +1,101 @@
+#include "RangeAzimuthMap.h"
+#include "AdcKernels.h"
+#include "FftKernels.h"
+#include "SpectrumProcessor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+RangeAzimuthMap::RangeAzimuthMap()
+    : m_rangeBins(0)
+    , m_maxPower(0.0f)
+{
+}
+
+bool RangeAzimuthMap::process(const RawADCFrame& frame)
+{
+    m_channels.clear();
+    for (int channel = 0; channel < frame.num_rx_antennas && channel < 8; ++channel) {
+        if (frame.rx_mask & (1u << channel)) {
+            m_channels.push_back(channel);
+        }
+    }
+    if (m_channels.empty()) {
+        return false;
+    }
+
+    const size_t count = adcChannelView(frame, 0, m_channels[0]).count;
+    if (count == 0) {
+        return false;
+    }
+
+    // Chirps missing from the payload would only pull the average down
+    const size_t numChirps = adcChirpsPresent(frame);
+    if (numChirps == 0) {
+        return false;
+    }
+    const size_t numChannels = std::min(m_channels.size(), AZIMUTH_BINS);
+    const size_t n = SpectrumProcessor::fftSize(count);
+    m_rangeBins = n / 2;
+    if (m_window.size() != count) {
+        makeHannWindow(m_window, count);
+    }
+    m_rangeSpectra.resize(numChirps * numChannels * n);
+
+    ThreadPool& pool = ThreadPool::instance();
+    pool.parallelFor(numChirps * numChannels, [&](size_t task) {
+        const size_t chirp = task / numChannels;
+        const size_t c = task % numChannels;
+        std::complex<float>* buffer = &m_rangeSpectra[task * n];
+        packChannel(frame, adcChannelView(frame, static_cast<uint32_t>(chirp), m_channels[c]),
+                    m_window.data(), buffer, n);
+        SpectrumProcessor::fft(buffer, n);
+    });
+
+    // Angle FFT per range bin, in blocks of bins so each task keeps its
+    // scratch buffer on the stack
+    m_powerDb.resize(AZIMUTH_BINS * m_rangeBins);
+    const size_t binsPerTask = 16;
+    const size_t tasks = (m_rangeBins + binsPerTask - 1) / binsPerTask;
+    pool.parallelFor(tasks, [&](size_t task) {
+        std::complex<float> angle[AZIMUTH_BINS];
+        float power[AZIMUTH_BINS];
+        const size_t lastBin = std::min(m_rangeBins, (task + 1) * binsPerTask);
+        for (size_t bin = task * binsPerTask; bin < lastBin; ++bin) {
+            std::fill(power, power + AZIMUTH_BINS, 0.0f);
+            for (size_t chirp = 0; chirp < numChirps; ++chirp) {
+                const std::complex<float>* spectra = &m_rangeSpectra[chirp * numChannels * n];
+                for (size_t c = 0; c < numChannels; ++c) {
+                    angle[c] = spectra[c * n + bin];
+                }
+                std::fill(angle + numChannels, angle + AZIMUTH_BINS, std::complex<float>(0.0f, 0.0f));
+                FixedFFT<AZIMUTH_BINS>::transform(angle);
+                for (size_t k = 0; k < AZIMUTH_BINS; ++k) {
+                    power[k] += std::norm(angle[k]);
+                }
+            }
+            // fftshift so broadside (zero spatial frequency) is the middle bin
+            for (size_t k = 0; k < AZIMUTH_BINS; ++k) {
+                const size_t shifted = (k + AZIMUTH_BINS / 2) % AZIMUTH_BINS;
+                m_powerDb[k * m_rangeBins + bin] =
+                    10.0f * std::log10(power[shifted] / numChirps + 1e-20f);
+            }
+        }
+    });
+
+    m_maxPower = *std::max_element(m_powerDb.begin(), m_powerDb.end());
+    return true;
+}
+
+float RangeAzimuthMap::binForAzimuth(float degrees)
+{
+    // Spatial frequency sin(azimuth) / 2 cycles per element
+    const float s = std::sin(degrees * float(M_PI) / 180.0f);
+    return AZIMUTH_BINS / 2.0f + s * AZIMUTH_BINS / 2.0f;
+}
+
+float RangeAzimuthMap::azimuthForBin(float bin)
+{
+    const float s = std::max(-1.0f, std::min(1.0f, 2.0f * bin / AZIMUTH_BINS - 1.0f));
+    return std::asin(s) * 180.0f / float(M_PI);
+}
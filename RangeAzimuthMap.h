@@ -0,0 +1,41 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "DataStructures.h"
+
+// Range-azimuth power map of one ADC frame: a range FFT per RX channel and
+// chirp, then an angle FFT across the enabled channels of every range bin,
+// with power averaged over the chirps present in the payload (see
+// adcChirpsPresent). Assumes half-wavelength RX spacing, so
+// azimuth bins are uniform in sin(azimuth) with broadside in the middle.
+class RangeAzimuthMap
+{
+public:
+    static constexpr size_t AZIMUTH_BINS = 64;
+
+    RangeAzimuthMap();
+
+    // False when the frame has no enabled channel, no samples or no whole chirp
+    bool process(const RawADCFrame& frame);
+
+    // Positive-frequency half of the range FFT
+    size_t rangeBins() const { return m_rangeBins; }
+    size_t azimuthBins() const { return AZIMUTH_BINS; }
+    // Power in dB, row-major [azimuth bin][range bin]
+    const std::vector<float>& power() const { return m_powerDb; }
+    float maxPower() const { return m_maxPower; }
+
+    // Azimuth bin (fractional) for an angle in degrees, and back
+    static float binForAzimuth(float degrees);
+    static float azimuthForBin(float bin);
+
+private:
+    std::vector<std::complex<float>> m_rangeSpectra;  // [chirp][channel][n]
+    std::vector<float> m_window;
+    std::vector<float> m_powerDb;
+    std::vector<int> m_channels;
+    size_t m_rangeBins;
+    float m_maxPower;
+};
@@ -0,0 +1,44 @@
+#include "RasterKernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RADAR_HAVE_SSE2 1
+#endif
+
+void decayPixels(uint32_t* pixels, size_t count, uint32_t factor)
+{
+    factor = std::min<uint32_t>(factor, 256);
+    size_t i = 0;
+
+#ifdef RADAR_HAVE_SSE2
+    // Four pixels per step: widen bytes to 16 bits, multiply, keep the high byte
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vfactor = _mm_set1_epi16(static_cast<short>(factor));
+    for (; i + 4 <= count; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+        __m128i raw = _mm_loadu_si128(p);
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(raw, zero), vfactor), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(raw, zero), vfactor), 8);
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const uint32_t pixel = pixels[i];
+        // Red/blue and alpha/green pairs are scaled in parallel in 16-bit lanes
+        const uint32_t rb = (((pixel & 0x00FF00FFu) * factor) >> 8) & 0x00FF00FFu;
+        const uint32_t ag = (((pixel >> 8) & 0x00FF00FFu) * factor) & 0xFF00FF00u;
+        pixels[i] = rb | ag;
+    }
+}
+
+uint32_t decayFactorForHalfLife(double halfLifeFrames)
+{
+    if (halfLifeFrames <= 0.0) {
+        return 0;
+    }
+    const double factor = 256.0 * std::pow(0.5, 1.0 / halfLifeFrames);
+    return static_cast<uint32_t>(std::min(255.0, std::round(factor)));
+}
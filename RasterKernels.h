@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel kernels for display buffers in 32-bit (A)RGB layout. They work on
+// raw memory so they stay free of Qt; QImage::bits() can be passed directly.
+
+// Multiply every 8-bit channel of `count` pixels by factor / 256.
+// Scaling alpha together with colour keeps premultiplied pixels valid,
+// and because the result is truncated every channel reaches zero.
+void decayPixels(uint32_t* pixels, size_t count, uint32_t factor);
+
+// Per-frame factor (0..255) that halves intensity every `halfLifeFrames` frames
+uint32_t decayFactorForHalfLife(double halfLifeFrames);
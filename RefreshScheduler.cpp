@@ -0,0 +1,58 @@
+#include "RefreshScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+RefreshScheduler::RefreshScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_framePolicy(FramePolicy::Latest)
+    , m_maxFps(0)
+    , m_displayRefreshRate(DEFAULT_REFRESH_RATE)
+    , m_dirty(false)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &RefreshScheduler::onTimeout);
+}
+
+void RefreshScheduler::setMaxFps(int fps)
+{
+    m_maxFps = std::max(0, fps);
+}
+
+void RefreshScheduler::setDisplayRefreshRate(double hz)
+{
+    m_displayRefreshRate = hz > 1.0 ? hz : DEFAULT_REFRESH_RATE;
+}
+
+int RefreshScheduler::intervalMs() const
+{
+    double fps = m_maxFps > 0 ? m_maxFps : m_displayRefreshRate;
+    return std::max(1, static_cast<int>(std::floor(1000.0 / fps)));
+}
+
+void RefreshScheduler::markDirty()
+{
+    m_dirty = true;
+    if (m_timer->isActive()) {
+        return;
+    }
+
+    // Refresh right away (after the current burst of events) if the last
+    // refresh is at least one interval old, otherwise at the next slot
+    int delay = 0;
+    if (m_sinceRefresh.isValid()) {
+        delay = static_cast<int>(std::max<qint64>(0, intervalMs() - m_sinceRefresh.elapsed()));
+    }
+    m_timer->start(delay);
+}
+
+void RefreshScheduler::onTimeout()
+{
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+    m_sinceRefresh.start();
+    emit refresh();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Coalesces display updates. Data arrival marks the display dirty; at most
+// one refresh() is emitted per frame interval, and none at all while no new
+// data arrives. The interval comes from the max FPS setting, or from the
+// display refresh rate when max FPS is 0.
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Which data a refresh shows when several frames arrived since the last one
+    enum class FramePolicy {
+        Latest,    // the most recent frame; older ones are dropped
+        Aggregate  // tracks merged by id, spectra power-averaged
+    };
+
+    explicit RefreshScheduler(QObject *parent = nullptr);
+
+    void setFramePolicy(FramePolicy policy) { m_framePolicy = policy; }
+    FramePolicy framePolicy() const { return m_framePolicy; }
+
+    // 0 follows the display refresh rate
+    void setMaxFps(int fps);
+    int maxFps() const { return m_maxFps; }
+    void setDisplayRefreshRate(double hz);
+
+    // New data is ready; schedules a refresh unless one is already pending
+    void markDirty();
+    int intervalMs() const;
+
+signals:
+    void refresh();
+
+private slots:
+    void onTimeout();
+
+private:
+    QTimer* m_timer;
+    QElapsedTimer m_sinceRefresh;
+    FramePolicy m_framePolicy;
+    int m_maxFps;
+    double m_displayRefreshRate;
+    bool m_dirty;
+
+    static constexpr double DEFAULT_REFRESH_RATE = 60.0;
+};
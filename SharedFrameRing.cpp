@@ -0,0 +1,348 @@
+#include "SharedFrameRing.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring versions must be lock-free across processes");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ring flags must be lock-free across processes");
+
+namespace shm {
+
+constexpr uint32_t RING_MAGIC = 0x474E5252;  // "RRNG"
+constexpr uint32_t RING_VERSION = 1;
+constexpr size_t RING_HEADER_BYTES = 64;
+
+struct RingHeader {
+    std::atomic<uint32_t> magic;  // written last by the publisher
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slotStride;          // SlotHeader + payload, cache-line multiple
+    uint32_t payloadBytes;
+    std::atomic<uint32_t> closed;
+    std::atomic<uint64_t> published;  // frames completed so far
+};
+
+static_assert(sizeof(RingHeader) <= RING_HEADER_BYTES, "ring header too large");
+
+namespace {
+
+uint8_t* slotAt(RingHeader* ring, uint64_t sequence)
+{
+    return reinterpret_cast<uint8_t*>(ring) + RING_HEADER_BYTES + (sequence % ring->slots) * ring->slotStride;
+}
+
+const uint8_t* slotAt(const RingHeader* ring, uint64_t sequence)
+{
+    return reinterpret_cast<const uint8_t*>(ring) + RING_HEADER_BYTES +
+           (sequence % ring->slots) * ring->slotStride;
+}
+
+} // namespace
+
+Segment::~Segment()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool Segment::create(const std::string& name, size_t size)
+{
+    close();
+    const std::string mappingName = "Local\\" + name;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), mappingName.c_str());
+    if (!mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+bool Segment::open(const std::string& name)
+{
+    close();
+    const std::string mappingName = "Local\\" + name;
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+    if (!mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view);
+    m_size = info.RegionSize;
+    return true;
+}
+
+void Segment::close()
+{
+    // The mapping disappears with its last handle, so there is no name to remove
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_size = 0;
+    m_unlinkName.clear();
+}
+
+#else
+
+bool Segment::create(const std::string& name, size_t size)
+{
+    close();
+    const std::string path = "/" + name;
+    // A segment left behind by a crashed publisher is replaced, not reused
+    ::shm_unlink(path.c_str());
+    const int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void* view = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        ::shm_unlink(path.c_str());
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(view);
+    m_size = size;
+    m_unlinkName = path;
+    return true;
+}
+
+bool Segment::open(const std::string& name)
+{
+    close();
+    const std::string path = "/" + name;
+    const int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void Segment::close()
+{
+    if (m_data) {
+        ::munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    if (!m_unlinkName.empty()) {
+        ::shm_unlink(m_unlinkName.c_str());
+        m_unlinkName.clear();
+    }
+    m_size = 0;
+}
+
+#endif
+
+} // namespace shm
+
+SharedFramePublisher::~SharedFramePublisher()
+{
+    close();
+}
+
+bool SharedFramePublisher::open(const std::string& name, size_t slots, size_t slotBytes)
+{
+    close();
+    slots = std::max<size_t>(2, slots);
+    const size_t stride = (sizeof(shm::SlotHeader) + slotBytes + 63) / 64 * 64;
+    if (!m_segment.create(name, shm::RING_HEADER_BYTES + slots * stride)) {
+        return false;
+    }
+    // Fresh pages are zero: every slot starts at version 0 (never written)
+    m_ring = reinterpret_cast<shm::RingHeader*>(m_segment.data());
+    m_ring->version = shm::RING_VERSION;
+    m_ring->slots = static_cast<uint32_t>(slots);
+    m_ring->slotStride = static_cast<uint32_t>(stride);
+    m_ring->payloadBytes = static_cast<uint32_t>(stride - sizeof(shm::SlotHeader));
+    m_ring->closed.store(0, std::memory_order_relaxed);
+    m_ring->published.store(0, std::memory_order_relaxed);
+    m_ring->magic.store(shm::RING_MAGIC, std::memory_order_release);
+    m_sequence = 0;
+    return true;
+}
+
+void SharedFramePublisher::close()
+{
+    if (m_ring) {
+        m_ring->closed.store(1, std::memory_order_release);
+        m_ring = nullptr;
+    }
+    m_segment.close();
+}
+
+void SharedFramePublisher::publishTracks(size_t source, const TargetTrackData& trackData)
+{
+    const size_t count = std::min<size_t>(trackData.numTracks, trackData.targets.size());
+    publish(shm::FrameKind::Tracks, source, trackData.timestamp_us, 0, 0, trackData.targets.data(),
+            count, sizeof(TargetTrack));
+}
+
+void SharedFramePublisher::publishSpectrum(size_t source, uint64_t timestampUs, uint32_t frameNumber,
+                                           const std::vector<float>& magnitude, bool twoSided)
+{
+    publish(shm::FrameKind::Spectrum, source, timestampUs, frameNumber,
+            twoSided ? shm::SPECTRUM_TWO_SIDED : 0, magnitude.data(), magnitude.size(), sizeof(float));
+}
+
+void SharedFramePublisher::publish(shm::FrameKind kind, size_t source, uint64_t timestampUs,
+                                   uint32_t frameNumber, uint32_t flags, const void* payload,
+                                   size_t count, size_t elementBytes)
+{
+    if (!m_ring) {
+        return;
+    }
+    const size_t capacity = m_ring->payloadBytes / elementBytes;
+    if (count > capacity) {
+        count = capacity;
+        flags |= shm::FRAME_TRUNCATED;
+    }
+
+    const uint64_t sequence = m_sequence;
+    uint8_t* slot = shm::slotAt(m_ring, sequence);
+    shm::SlotHeader* header = reinterpret_cast<shm::SlotHeader*>(slot);
+    // Odd version: readers of this slot see it as being rewritten
+    header->version.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->sequence = sequence;
+    header->timestampUs = timestampUs;
+    header->publishUs = Instrumentation::wallClockUs();
+    header->kind = static_cast<uint32_t>(kind);
+    header->source = static_cast<uint32_t>(source);
+    header->frameNumber = frameNumber;
+    header->flags = flags;
+    header->count = static_cast<uint32_t>(count);
+    if (count > 0) {
+        std::memcpy(slot + sizeof(shm::SlotHeader), payload, count * elementBytes);
+    }
+
+    header->version.store(2 * sequence + 2, std::memory_order_release);
+    m_ring->published.store(sequence + 1, std::memory_order_release);
+    m_sequence = sequence + 1;
+}
+
+bool SharedFrameSubscriber::open(const std::string& name)
+{
+    close();
+    if (!m_segment.open(name) || m_segment.size() < shm::RING_HEADER_BYTES) {
+        m_segment.close();
+        return false;
+    }
+    const shm::RingHeader* ring = reinterpret_cast<const shm::RingHeader*>(m_segment.data());
+    if (ring->magic.load(std::memory_order_acquire) != shm::RING_MAGIC ||
+        ring->version != shm::RING_VERSION || ring->slots == 0 ||
+        ring->slotStride <= sizeof(shm::SlotHeader) ||
+        shm::RING_HEADER_BYTES + size_t(ring->slots) * ring->slotStride > m_segment.size()) {
+        m_segment.close();
+        return false;
+    }
+    m_ring = ring;
+    // Start with the oldest frame still in the ring
+    const uint64_t published = m_ring->published.load(std::memory_order_acquire);
+    m_next = published > m_ring->slots ? published - m_ring->slots : 0;
+    m_lost = 0;
+    return true;
+}
+
+void SharedFrameSubscriber::close()
+{
+    m_ring = nullptr;
+    m_segment.close();
+}
+
+bool SharedFrameSubscriber::publisherClosed() const
+{
+    return m_ring && m_ring->closed.load(std::memory_order_acquire) != 0;
+}
+
+void SharedFrameSubscriber::skipToLatest()
+{
+    if (m_ring) {
+        const uint64_t published = m_ring->published.load(std::memory_order_acquire);
+        m_next = published > 0 ? published - 1 : 0;
+    }
+}
+
+SharedFrameSubscriber::Result SharedFrameSubscriber::beginRead(const uint8_t*& slot, uint64_t& version)
+{
+    if (!m_ring) {
+        return Result::Empty;
+    }
+    const uint64_t published = m_ring->published.load(std::memory_order_acquire);
+    if (m_next >= published) {
+        return Result::Empty;
+    }
+    if (published - m_next > m_ring->slots) {
+        m_lost += published - m_ring->slots - m_next;
+        m_next = published - m_ring->slots;
+    }
+
+    slot = shm::slotAt(m_ring, m_next);
+    version = reinterpret_cast<const shm::SlotHeader*>(slot)->version.load(std::memory_order_acquire);
+    if (version != 2 * m_next + 2) {
+        // Already being overwritten by a newer frame
+        ++m_lost;
+        ++m_next;
+        return Result::Lapped;
+    }
+    return Result::Frame;
+}
+
+SharedFrameSubscriber::Result SharedFrameSubscriber::endRead(const shm::SlotHeader* header, uint64_t version)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    ++m_next;
+    if (header->version.load(std::memory_order_relaxed) != version) {
+        ++m_lost;
+        return Result::Lapped;
+    }
+    return Result::Frame;
+}
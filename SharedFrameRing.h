@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DataStructures.h"
+
+// Single-producer ring of decoded frames in a named shared-memory segment
+// (POSIX shm_open, a named file mapping on Windows), so other local
+// processes get tracks and spectra without receiving and parsing the UDP
+// stream again. Frame n is written once into slot n % slots. Every slot
+// carries a version: 2n + 1 while frame n is written, 2n + 2 once it is
+// complete. Readers check it before and after looking at the slot
+// (a seqlock), so they never block the publisher. A reader that falls a
+// whole ring behind skips ahead and counts the frames it lost.
+namespace shm {
+
+enum class FrameKind : uint32_t {
+    Tracks = 1,    // payload: count TargetTrack records
+    Spectrum = 2   // payload: count floats, magnitude in dB
+};
+
+constexpr uint32_t SPECTRUM_TWO_SIDED = 1;
+constexpr uint32_t FRAME_TRUNCATED = 2;  // payload cut to the slot size
+
+struct SlotHeader {
+    std::atomic<uint64_t> version;
+    uint64_t sequence;
+    uint64_t timestampUs;  // source timestamp of the frame
+    uint64_t publishUs;    // wall clock when published, for latency
+    uint32_t kind;         // FrameKind
+    uint32_t source;
+    uint32_t frameNumber;
+    uint32_t flags;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+// Read-only view into the segment; only valid while the slot is not reused,
+// which SharedFrameSubscriber::poll() checks after the callback returns
+struct SharedFrame {
+    const SlotHeader* header;
+    const uint8_t* payload;
+
+    FrameKind kind() const { return static_cast<FrameKind>(header->kind); }
+    const TargetTrack* tracks() const { return reinterpret_cast<const TargetTrack*>(payload); }
+    const float* spectrum() const { return reinterpret_cast<const float*>(payload); }
+};
+
+class Segment
+{
+public:
+    Segment() = default;
+    ~Segment();
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    bool create(const std::string& name, size_t size);
+    bool open(const std::string& name);
+    void close();
+
+    uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    std::string m_unlinkName;  // set for the creator, which removes the name on close
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
+
+struct RingHeader;
+
+} // namespace shm
+
+class SharedFramePublisher
+{
+public:
+    static constexpr size_t DEFAULT_SLOTS = 128;
+    static constexpr size_t DEFAULT_SLOT_BYTES = 128 * 1024;  // 4096 tracks or 32768 bins
+
+    SharedFramePublisher() = default;
+    ~SharedFramePublisher();
+
+    // Creates (or takes over) the segment; names are like "radar_frames"
+    bool open(const std::string& name, size_t slots = DEFAULT_SLOTS,
+              size_t slotBytes = DEFAULT_SLOT_BYTES);
+    // Marks the ring closed for readers and removes the name
+    void close();
+    bool isOpen() const { return m_ring != nullptr; }
+
+    void publishTracks(size_t source, const TargetTrackData& trackData);
+    void publishSpectrum(size_t source, uint64_t timestampUs, uint32_t frameNumber,
+                         const std::vector<float>& magnitude, bool twoSided);
+
+    uint64_t published() const { return m_sequence; }
+
+private:
+    void publish(shm::FrameKind kind, size_t source, uint64_t timestampUs, uint32_t frameNumber,
+                 uint32_t flags, const void* payload, size_t count, size_t elementBytes);
+
+    shm::Segment m_segment;
+    shm::RingHeader* m_ring = nullptr;
+    uint64_t m_sequence = 0;
+};
+
+class SharedFrameSubscriber
+{
+public:
+    enum class Result {
+        Frame,   // fn was called with a consistent frame
+        Empty,   // nothing new
+        Lapped   // the publisher overwrote the frame; skipped ahead
+    };
+
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return m_ring != nullptr; }
+    // The publisher closed the ring; reopen to follow a new one
+    bool publisherClosed() const;
+
+    // Start with the newest frame instead of the oldest still in the ring
+    void skipToLatest();
+
+    // Calls fn(const shm::SharedFrame&) for the next frame. The view points
+    // into shared memory (no copy); anything derived from it must be
+    // discarded unless the result is Frame.
+    template <typename Fn>
+    Result poll(Fn&& fn)
+    {
+        const uint8_t* slot = nullptr;
+        uint64_t version = 0;
+        const Result state = beginRead(slot, version);
+        if (state != Result::Frame) {
+            return state;
+        }
+        const shm::SlotHeader* header = reinterpret_cast<const shm::SlotHeader*>(slot);
+        fn(shm::SharedFrame{header, slot + sizeof(shm::SlotHeader)});
+        return endRead(header, version);
+    }
+
+    uint64_t lost() const { return m_lost; }
+    uint64_t nextSequence() const { return m_next; }
+
+private:
+    Result beginRead(const uint8_t*& slot, uint64_t& version);
+    Result endRead(const shm::SlotHeader* header, uint64_t version);
+
+    shm::Segment m_segment;
+    const shm::RingHeader* m_ring = nullptr;
+    uint64_t m_next = 0;
+    uint64_t m_lost = 0;
+};
@@ -0,0 +1,115 @@
+#include "Simulator.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+Simulator::Simulator(uint32_t seed)
+    : m_randomEngine(seed)
+    , m_rangeDist(100.0f, 500.0f)
+    , m_azimuthDist(-90.0f, 90.0f)    // -90 to +90 degrees
+    , m_speedDist(-50.0f, 50.0f)      // -50 to +50 m/s
+    , m_levelDist(10.0f, 100.0f)      // 10-100 dB
+    , m_numTargetsDist(3, 8)          // 3-8 targets
+    , m_frameNumber(0)
+    , m_targetCount(0)
+{
+}
+
+void Simulator::generateTargets(TargetTrackData& tracks)
+{
+    // Generate random number of targets
+    uint32_t numTargets = m_numTargetsDist(m_randomEngine);
+    tracks.resize(numTargets);
+
+    for (uint32_t i = 0; i < numTargets; ++i) {
+        TargetTrack& target = tracks.targets[i];
+
+        target.target_id = i + 1;
+        target.level = m_levelDist(m_randomEngine);
+        target.radius = m_rangeDist(m_randomEngine);
+        target.azimuth = m_azimuthDist(m_randomEngine);
+        target.elevation = std::uniform_real_distribution<float>(-30.0f, 30.0f)(m_randomEngine);
+        target.radial_speed = m_speedDist(m_randomEngine);
+        target.azimuth_speed = std::uniform_real_distribution<float>(-5.0f, 5.0f)(m_randomEngine);
+        target.elevation_speed = std::uniform_real_distribution<float>(-2.0f, 2.0f)(m_randomEngine);
+    }
+
+    m_targetCount += numTargets;
+}
+
+void Simulator::generateADC(RawADCFrameTest& frame, uint32_t numSamples)
+{
+    frame.sample_data.resize(numSamples);
+    frame.msgId = ++m_frameNumber;
+    frame.num_samples_per_chirp = numSamples;
+
+    // Generate signal with multiple frequency components + noise
+    float sampleRate = 100000.0f; // 100 kHz
+    float t_step = 1.0f / sampleRate;
+
+    // Add some dominant frequency components
+    float freq1 = 5000.0f;  // 5 kHz
+    float freq2 = 15000.0f; // 15 kHz
+    float freq3 = 25000.0f; // 25 kHz
+
+    std::uniform_real_distribution<float> noiseDist(-0.1f, 0.1f);
+
+    for (uint32_t i = 0; i < numSamples; ++i) {
+        float t = i * t_step;
+
+        // Sum of sinusoids with different amplitudes
+        float signal = 0.8f * std::sin(2.0f * M_PI * freq1 * t) +
+                      0.5f * std::sin(2.0f * M_PI * freq2 * t) +
+                      0.3f * std::sin(2.0f * M_PI * freq3 * t);
+
+        // Add noise
+        signal += noiseDist(m_randomEngine);
+
+        frame.sample_data[i] = signal;
+    }
+}
+
+void Simulator::generateRawFrame(RawADCFrame& frame, const TargetTrackData& tracks,
+                                 uint8_t numRx, uint32_t numChirps, uint32_t numSamples)
+{
+    numRx = std::max<uint8_t>(1, std::min<uint8_t>(numRx, 8));
+    frame.frame_number = ++m_frameNumber;
+    frame.num_chirps = numChirps;
+    frame.num_rx_antennas = numRx;
+    frame.num_samples_per_chirp = numSamples;
+    frame.rx_mask = static_cast<uint8_t>((1u << numRx) - 1);
+    frame.adc_resolution = 12;
+    frame.interleaved_rx = 0;
+    frame.data_format = Rx_Data_Format_t::COMPLEX_INT16;
+    frame.sample_data.clear();
+    frame.sample_data_i16.assign(size_t(numChirps) * numRx * numSamples * 2, 0);
+
+    // Beat frequency proportional to range (500 m maps to 0.4 cycles/sample),
+    // half-wavelength RX spacing for the per-channel phase step
+    const float fullScale = 2047.0f;
+    std::normal_distribution<float> noise(0.0f, 8.0f);
+    for (uint32_t chirp = 0; chirp < numChirps; ++chirp) {
+        for (uint8_t rx = 0; rx < numRx; ++rx) {
+            int16_t* out = &frame.sample_data_i16[(size_t(chirp) * numRx + rx) * numSamples * 2];
+            for (uint32_t s = 0; s < numSamples; ++s) {
+                float i = noise(m_randomEngine);
+                float q = noise(m_randomEngine);
+                for (uint32_t t = 0; t < tracks.numTracks; ++t) {
+                    const TargetTrack& target = tracks.targets[t];
+                    const float beat = 0.4f * std::min(target.radius, 500.0f) / 500.0f;
+                    const float amplitude = fullScale * 0.1f *
+                        std::pow(10.0f, (target.level - 100.0f) / 40.0f);
+                    const float phase = 2.0f * float(M_PI) * beat * s +
+                        float(M_PI) * std::sin(target.azimuth * float(M_PI) / 180.0f) * rx;
+                    i += amplitude * std::cos(phase);
+                    q += amplitude * std::sin(phase);
+                }
+                out[2 * s] = static_cast<int16_t>(std::max(-fullScale, std::min(fullScale, i)));
+                out[2 * s + 1] = static_cast<int16_t>(std::max(-fullScale, std::min(fullScale, q)));
+            }
+        }
+    }
+}
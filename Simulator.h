@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include "DataStructures.h"
+
+// Synthetic track and ADC data for the GUI's simulation mode and for
+// exercising radar_cli without a recording
+class Simulator
+{
+public:
+    explicit Simulator(uint32_t seed = std::random_device{}());
+
+    // 3-8 random targets with ids 1..n
+    void generateTargets(TargetTrackData& tracks);
+    // Three tones plus noise, as a text-protocol style frame
+    void generateADC(RawADCFrameTest& frame, uint32_t numSamples = 512);
+    // Complex int16 frame in [chirp][rx][sample] layout; each target is a
+    // tone whose phase advances across RX channels with its azimuth
+    void generateRawFrame(RawADCFrame& frame, const TargetTrackData& tracks,
+                          uint8_t numRx = 4, uint32_t numChirps = 8,
+                          uint32_t numSamples = 256);
+
+    uint64_t targetCount() const { return m_targetCount; }
+
+private:
+    std::mt19937 m_randomEngine;
+    std::uniform_real_distribution<float> m_rangeDist;
+    std::uniform_real_distribution<float> m_azimuthDist;
+    std::uniform_real_distribution<float> m_speedDist;
+    std::uniform_real_distribution<float> m_levelDist;
+    std::uniform_int_distribution<int> m_numTargetsDist;
+    uint32_t m_frameNumber;
+    uint64_t m_targetCount;
+};
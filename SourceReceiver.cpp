@@ -0,0 +1,124 @@
+#include "SourceReceiver.h"
+#include "AllocationCounter.h"
+#include "BinaryProtocol.h"
+#include "Instrumentation.h"
+#include "TextProtocolParser.h"
+#include "TrackCodec.h"
+
+SourceReceiver::SourceReceiver(int index, quint16 port, SourceFramePools& pools)
+    : m_index(index)
+    , m_port(port)
+    , m_pools(pools)
+    , m_socket(nullptr)
+    , m_notifyPending(false)
+{
+}
+
+void SourceReceiver::start()
+{
+    m_socket = new QUdpSocket(this);
+    if (!m_socket->bind(QHostAddress::Any, m_port)) {
+        emit bindFailed(m_index, m_port);
+        return;
+    }
+    connect(m_socket, &QUdpSocket::readyRead,
+            this, &SourceReceiver::readPendingDatagrams);
+}
+
+void SourceReceiver::takeFrames(SourceFrames& frames)
+{
+    // Frames left in `frames` are released here, on the GUI thread
+    frames.clear();
+    // Re-arm before collecting: a frame queued after this point sends a new
+    // notification, so nothing waits for the next datagram
+    m_notifyPending.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(frames, m_queued);
+}
+
+void SourceReceiver::readPendingDatagrams()
+{
+    bool decoded = false;
+    while (m_socket->hasPendingDatagrams()) {
+        QByteArray& datagram = m_datagram;
+        {
+            ScopedStageTimer timer(Stage::Receive);
+            datagram.resize(m_socket->pendingDatagramSize());
+            m_socket->readDatagram(datagram.data(), datagram.size());
+        }
+        Instrumentation::instance().countDatagram(datagram.size());
+        m_stats.datagrams.fetch_add(1, std::memory_order_relaxed);
+        m_stats.bytes.fetch_add(datagram.size(), std::memory_order_relaxed);
+
+        ScopedStageTimer timer(Stage::Parse);
+        AllocationCounter::ThreadScope decodeAllocations;
+        if (decode(datagram, Instrumentation::wallClockUs())) {
+            decoded = true;
+        } else {
+            m_stats.decodeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_stats.lastDecodeAllocations.store(decodeAllocations.allocations(), std::memory_order_relaxed);
+    }
+
+    if (decoded && !m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit framesReady(m_index);
+    }
+}
+
+bool SourceReceiver::decode(const QByteArray& datagram, uint64_t receivedUs)
+{
+    FramePool<RawADCFrame>::Ref rawFrame = m_pools.rawFrames.acquire();
+    if (::parseBinaryADCMessage(datagram.constData(), datagram.size(), *rawFrame)) {
+        if (rawFrame->timestamp_us == 0) {
+            rawFrame->timestamp_us = receivedUs;
+        }
+        enqueue(m_queued.rawFrames, std::move(rawFrame));
+        return true;
+    }
+
+    FramePool<TargetTrackData>::Ref tracks = m_pools.tracks.acquire();
+    const TrackDecoder::Result compact = m_trackDecoder.decode(datagram.constData(), datagram.size(), *tracks);
+    if (compact != TrackDecoder::Result::NotTrackMessage) {
+        // Delta frames after a loss are dropped until the next keyframe,
+        // duplicate and late ones without losing the reference
+        if (compact != TrackDecoder::Result::Decoded) {
+            return false;
+        }
+        if (tracks->timestamp_us == 0) {
+            tracks->timestamp_us = receivedUs;
+        }
+        tracks->received_us = receivedUs;
+        enqueue(m_queued.tracks, std::move(tracks));
+        return true;
+    }
+
+    // The text protocol carries no timestamp; frames are stamped on receipt
+    FramePool<RawADCFrameTest>::Ref adcFrame = m_pools.adcFrames.acquire();
+    TextMessageResult result = ::parseTextMessage(datagram.constData(), datagram.size(),
+                                                  *tracks, *adcFrame);
+    if (result.hasTracks) {
+        tracks->timestamp_us = receivedUs;
+        tracks->received_us = receivedUs;
+        enqueue(m_queued.tracks, std::move(tracks));
+    }
+    if (result.hasADC) {
+        adcFrame->timestamp_us = receivedUs;
+        enqueue(m_queued.adcFrames, std::move(adcFrame));
+    }
+    return result.hasTracks || result.hasADC;
+}
+
+template <typename Ref>
+void SourceReceiver::enqueue(std::vector<Ref>& queue, Ref&& frame)
+{
+    m_stats.frames.fetch_add(1, std::memory_order_relaxed);
+    Instrumentation::instance().countFrame();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (queue.size() >= MAX_QUEUED_FRAMES) {
+        // The GUI is behind: keep the newest frames
+        queue.erase(queue.begin());
+        m_stats.droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    queue.push_back(std::move(frame));
+}
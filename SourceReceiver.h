@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QUdpSocket>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "BufferPool.h"
+#include "DataStructures.h"
+#include "TrackCodec.h"
+
+// Frames decoded from one source since the GUI last collected them
+struct SourceFrames {
+    std::vector<FramePool<TargetTrackData>::Ref> tracks;
+    std::vector<FramePool<RawADCFrameTest>::Ref> adcFrames;
+    std::vector<FramePool<RawADCFrame>::Ref> rawFrames;
+
+    bool empty() const { return tracks.empty() && adcFrames.empty() && rawFrames.empty(); }
+    void clear()
+    {
+        tracks.clear();
+        adcFrames.clear();
+        rawFrames.clear();
+    }
+};
+
+// Frame pools shared by all receivers. FramePool is thread-safe; the pools
+// must outlive every receiver and every frame handed out.
+struct SourceFramePools {
+    FramePool<TargetTrackData> tracks;
+    FramePool<RawADCFrameTest> adcFrames;
+    FramePool<RawADCFrame> rawFrames;
+};
+
+// Receives and decodes one UDP port on its own thread (see moveToThread in
+// MainWindow). Decoded frames are queued under a mutex and the GUI is
+// notified with at most one framesReady() in flight, so a busy source cannot
+// flood the GUI event loop. Frames carry their source timestamp, or the
+// receive time when the protocol has none; track frames also carry the
+// receive time itself (received_us).
+class SourceReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        std::atomic<uint64_t> datagrams{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> decodeErrors{0};   // datagrams no decoder accepted
+        std::atomic<uint64_t> droppedFrames{0};  // replaced before the GUI collected them
+        // Heap allocations of the last decode on this source's thread
+        // (test hook only, see AllocationCounter)
+        std::atomic<uint64_t> lastDecodeAllocations{0};
+    };
+
+    // Queue limit per frame kind between two GUI collections
+    static constexpr size_t MAX_QUEUED_FRAMES = 16;
+
+    SourceReceiver(int index, quint16 port, SourceFramePools& pools);
+
+    int index() const { return m_index; }
+    quint16 port() const { return m_port; }
+    const Stats& stats() const { return m_stats; }
+
+    // GUI thread: replaces `frames` with everything decoded since the last call
+    void takeFrames(SourceFrames& frames);
+
+public slots:
+    // Worker thread: creates and binds the socket
+    void start();
+
+signals:
+    void framesReady(int index);
+    void bindFailed(int index, quint16 port);
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    bool decode(const QByteArray& datagram, uint64_t receivedUs);
+    template <typename Ref>
+    void enqueue(std::vector<Ref>& queue, Ref&& frame);
+
+    const int m_index;
+    const quint16 m_port;
+    SourceFramePools& m_pools;
+    QUdpSocket* m_socket;
+    QByteArray m_datagram;  // receive buffer, reused across datagrams
+    TrackDecoder m_trackDecoder;  // delta state of this source's compact track stream
+    Stats m_stats;
+
+    std::mutex m_mutex;  // guards m_queued
+    SourceFrames m_queued;
+    std::atomic<bool> m_notifyPending;
+};
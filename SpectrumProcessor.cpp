@@ -0,0 +1,410 @@
+#include "SpectrumProcessor.h"
+#include "AdcKernels.h"
+#include "FftKernels.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+SpectrumProcessor::SpectrumProcessor()
+    : m_windowFunction(WindowFunction::Rectangular)
+    , m_twoSided(false)
+    , m_sampleCount(0)
+    , m_maxMagnitude(0.0f)
+    , m_mtiMode(MtiMode::Off)
+    , m_clutterMapEnabled(false)
+    , m_clutterMapAlpha(ClutterMap::DEFAULT_ALPHA)
+    , m_haveChannelSpectra(false)
+    , m_channelMask(0)
+    , m_maxChirps(0)
+{
+}
+
+void SpectrumProcessor::setWindowFunction(WindowFunction window)
+{
+    if (m_windowFunction != window) {
+        m_windowFunction = window;
+        m_window.clear();
+    }
+}
+
+void SpectrumProcessor::setClutterMapEnabled(bool enabled)
+{
+    if (m_clutterMapEnabled != enabled) {
+        m_clutterMapEnabled = enabled;
+        // Switching on starts from a fresh background
+        resetClutterMaps();
+    }
+}
+
+void SpectrumProcessor::setClutterMapAlpha(float alpha)
+{
+    m_clutterMap.setAlpha(alpha);
+    m_clutterMapAlpha = m_clutterMap.alpha();
+    for (ClutterMap& map : m_channelClutter) {
+        map.setAlpha(m_clutterMapAlpha);
+    }
+}
+
+void SpectrumProcessor::resetClutterMaps()
+{
+    m_clutterMap.reset();
+    for (ClutterMap& map : m_channelClutter) {
+        map.reset();
+    }
+}
+
+void SpectrumProcessor::process(const std::vector<float>& samples)
+{
+    m_sampleCount = samples.size();
+    m_twoSided = false;
+    m_haveChannelSpectra = false;
+    if (samples.empty()) return;
+
+    size_t n = prepareFFTBuffer(samples.size());
+    packRealFloat(samples.data(), samples.size(), 1, windowCoefficients(samples.size()),
+                  m_fftBuffer.data(), n);
+    computeSpectrum();
+}
+
+bool SpectrumProcessor::process(const RawADCFrame& frame)
+{
+    int channel = firstEnabledChannel(frame);
+    if (channel < 0) {
+        return false;
+    }
+
+    ADCChannelView view = adcChannelView(frame, 0, channel);
+    m_sampleCount = view.count;
+    m_twoSided = isComplexFormat(frame.data_format);
+    m_haveChannelSpectra = false;
+    if (view.count > 0) {
+        size_t n = prepareFFTBuffer(view.count);
+        const float* window = windowCoefficients(view.count);
+        const size_t taps = clutter::mtiTaps(m_mtiMode);
+        if (taps > 1 && adcChirpsPresent(frame) >= taps) {
+            // The canceller is linear, so it runs on the windowed samples
+            // and only its last output chirp is transformed
+            m_mtiRows.resize(taps * n);
+            for (size_t chirp = 0; chirp < taps; ++chirp) {
+                packChannel(frame, adcChannelView(frame, chirp, channel), window, &m_mtiRows[chirp * n], n);
+            }
+            clutter::cancelChirps(m_mtiRows.data(), taps, n, m_mtiMode);
+            std::copy(m_mtiRows.end() - n, m_mtiRows.end(), m_fftBuffer.begin());
+        } else {
+            packChannel(frame, view, window, m_fftBuffer.data(), n);
+        }
+        computeSpectrum();
+    }
+    return true;
+}
+
+bool SpectrumProcessor::processAverage(const std::vector<const RawADCFrame*>& frames)
+{
+    return averageSpectra(frames.size(), [&](size_t i) { return process(*frames[i]); });
+}
+
+bool SpectrumProcessor::processAverage(const std::vector<const RawADCFrameTest*>& frames)
+{
+    return averageSpectra(frames.size(), [&](size_t i) {
+        process(frames[i]->sample_data);
+        return !frames[i]->sample_data.empty();
+    });
+}
+
+bool SpectrumProcessor::averageSpectra(size_t count, const std::function<bool(size_t)>& processFrame)
+{
+    size_t averaged = 0;
+    bool twoSided = false;
+    size_t sampleCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!processFrame(i)) {
+            continue;
+        }
+        const size_t bins = m_magnitudeSpectrum.size();
+        if (averaged == 0) {
+            m_powerSum.assign(bins, 0.0f);
+            twoSided = m_twoSided;
+            sampleCount = m_sampleCount;
+        } else if (bins != m_powerSum.size() || m_twoSided != twoSided) {
+            continue;
+        }
+        for (size_t b = 0; b < bins; ++b) {
+            m_powerSum[b] += std::pow(10.0f, m_magnitudeSpectrum[b] / 10.0f);
+        }
+        ++averaged;
+    }
+    if (averaged == 0) {
+        return false;
+    }
+
+    // The last processed frame may have been a skipped one, so the layout
+    // is restored from the first accumulated frame
+    const size_t bins = m_powerSum.size();
+    m_twoSided = twoSided;
+    m_sampleCount = sampleCount;
+    m_magnitudeSpectrum.resize(bins);
+    updateFrequencyAxis(bins, twoSided ? bins / 2 : 0);
+    m_maxMagnitude = 0.0f;
+    for (size_t b = 0; b < bins; ++b) {
+        m_magnitudeSpectrum[b] = 10.0f * std::log10(m_powerSum[b] / averaged + 1e-20f);
+        m_maxMagnitude = std::max(m_maxMagnitude, m_magnitudeSpectrum[b]);
+    }
+    return true;
+}
+
+void SpectrumProcessor::setSpectrum(const float* magnitude, size_t bins, bool twoSided)
+{
+    m_twoSided = twoSided;
+    m_sampleCount = twoSided ? bins : 2 * bins;
+    m_haveChannelSpectra = false;
+    m_magnitudeSpectrum.assign(magnitude, magnitude + bins);
+    updateFrequencyAxis(bins, twoSided ? bins / 2 : 0);
+    m_maxMagnitude = 0.0f;
+    for (size_t b = 0; b < bins; ++b) {
+        m_maxMagnitude = std::max(m_maxMagnitude, m_magnitudeSpectrum[b]);
+    }
+}
+
+size_t SpectrumProcessor::fftSize(size_t count)
+{
+    size_t n = 1;
+    while (n < count) {
+        n *= 2;
+    }
+    return n;
+}
+
+size_t SpectrumProcessor::prepareFFTBuffer(size_t inputSize)
+{
+    size_t n = fftSize(inputSize);
+    m_fftBuffer.resize(n);
+    return n;
+}
+
+const float* SpectrumProcessor::windowCoefficients(size_t count)
+{
+    if (m_windowFunction == WindowFunction::Rectangular) {
+        return nullptr;
+    }
+    if (m_window.size() != count) {
+        makeHannWindow(m_window, count);
+    }
+    return m_window.data();
+}
+
+void SpectrumProcessor::updateFrequencyAxis(size_t bins, size_t shift)
+{
+    m_frequencyAxis.resize(bins);
+    for (size_t i = 0; i < bins; ++i) {
+        m_frequencyAxis[i] = static_cast<float>(i) - static_cast<float>(shift);
+    }
+}
+
+void SpectrumProcessor::computeSpectrum()
+{
+    std::vector<std::complex<float>>& complexData = m_fftBuffer;
+    size_t n = complexData.size();
+
+    fft(complexData.data(), n);
+
+    // Real input has a mirrored spectrum, so only the positive half is shown.
+    // Complex input keeps all n bins, fftshifted so DC sits in the middle.
+    size_t bins = m_twoSided ? n : n / 2;
+    size_t shift = m_twoSided ? n / 2 : 0;
+
+    m_magnitudeSpectrum.resize(bins);
+    updateFrequencyAxis(bins, shift);
+
+    m_power.resize(bins);
+    for (size_t i = 0; i < bins; ++i) {
+        m_power[i] = std::norm(complexData[(i + shift) % n]);
+    }
+    if (m_clutterMapEnabled) {
+        m_clutterMap.apply(m_power.data(), bins);
+    }
+
+    m_maxMagnitude = 0.0f;
+    for (size_t i = 0; i < bins; ++i) {
+        m_magnitudeSpectrum[i] = 10.0f * std::log10(m_power[i] + 1e-20f);
+
+        if (m_magnitudeSpectrum[i] > m_maxMagnitude) {
+            m_maxMagnitude = m_magnitudeSpectrum[i];
+        }
+    }
+}
+
+bool SpectrumProcessor::processChannels(const RawADCFrame& frame)
+{
+    int firstChannel = firstEnabledChannel(frame);
+    if (firstChannel < 0) {
+        return false;
+    }
+
+    m_channels.clear();
+    uint32_t channelMask = 0;
+    for (int channel = 0; channel < frame.num_rx_antennas && channel < 8; ++channel) {
+        if (frame.rx_mask & (1u << channel)) {
+            m_channels.push_back(channel);
+            channelMask |= 1u << channel;
+        }
+    }
+    if (channelMask != m_channelMask) {
+        // The per-channel backgrounds belong to other antennas now
+        m_channelMask = channelMask;
+        m_channelClutter.assign(m_channels.size(), ClutterMap());
+        for (ClutterMap& map : m_channelClutter) {
+            map.setAlpha(m_clutterMapAlpha);
+        }
+    }
+
+    m_sampleCount = adcChannelView(frame, 0, firstChannel).count;
+    m_twoSided = isComplexFormat(frame.data_format);
+    m_haveChannelSpectra = false;
+    if (m_sampleCount == 0) {
+        return true;
+    }
+
+    // Only chirps the payload holds, whatever the header claims
+    const size_t presentChirps = adcChirpsPresent(frame);
+    if (presentChirps == 0) {
+        return true;
+    }
+    const size_t numChannels = m_channels.size();
+    const size_t numChirps = m_maxChirps > 0 ? std::min(presentChirps, m_maxChirps) : presentChirps;
+    const size_t count = m_sampleCount;
+    const size_t n = fftSize(count);
+
+    // Window and buffers are prepared up front; the tasks only read shared state
+    const float* window = windowCoefficients(count);
+    m_channelBuffers.resize(numChannels * numChirps * n);
+
+    // One task per (channel, chirp batch), with enough batches to occupy every thread
+    ThreadPool& pool = ThreadPool::instance();
+    const size_t batchesPerChannel = std::min(numChirps,
+        std::max<size_t>(1, (pool.concurrency() + numChannels - 1) / numChannels));
+    const size_t chirpsPerBatch = (numChirps + batchesPerChannel - 1) / batchesPerChannel;
+
+    pool.parallelFor(numChannels * batchesPerChannel, [&](size_t task) {
+        const size_t c = task / batchesPerChannel;
+        const size_t firstChirp = (task % batchesPerChannel) * chirpsPerBatch;
+        const size_t lastChirp = std::min(numChirps, firstChirp + chirpsPerBatch);
+        for (size_t chirp = firstChirp; chirp < lastChirp; ++chirp) {
+            std::complex<float>* buffer = &m_channelBuffers[(c * numChirps + chirp) * n];
+            ADCChannelView view = adcChannelView(frame, chirp, m_channels[c]);
+            packChannel(frame, view, window, buffer, n);
+            fft(buffer, n);
+        }
+    });
+
+    // MTI across the chirps of every channel; the reduction then only sees
+    // the canceller outputs
+    const size_t taps = clutter::mtiTaps(m_mtiMode);
+    const size_t firstChirp = taps > 1 && numChirps >= taps ? taps - 1 : 0;
+    if (firstChirp > 0) {
+        pool.parallelFor(numChannels, [&](size_t c) {
+            clutter::cancelChirps(&m_channelBuffers[c * numChirps * n], numChirps, n, m_mtiMode);
+        });
+    }
+    const size_t usedChirps = numChirps - firstChirp;
+
+    // Per-channel reduction over chirps: mean power, and cross-spectrum
+    // against the reference (first enabled) channel for phase and coherence
+    const size_t bins = m_twoSided ? n : n / 2;
+    const size_t shift = m_twoSided ? n / 2 : 0;
+    m_channelMagnitudes.resize(numChannels);
+    m_channelPhase.resize(numChannels);
+    m_channelCoherence.resize(numChannels);
+
+    pool.parallelFor(numChannels, [&](size_t c) {
+        std::vector<float>& magnitude = m_channelMagnitudes[c];
+        std::vector<float>& phase = m_channelPhase[c];
+        std::vector<float>& coherence = m_channelCoherence[c];
+        magnitude.resize(bins);
+        phase.resize(bins);
+        coherence.resize(bins);
+
+        const std::complex<float>* channel = &m_channelBuffers[c * numChirps * n];
+        const std::complex<float>* reference = &m_channelBuffers[0];
+        for (size_t i = 0; i < bins; ++i) {
+            const size_t bin = (i + shift) % n;
+            float power = 0.0f;
+            float referencePower = 0.0f;
+            std::complex<float> cross(0.0f, 0.0f);
+            for (size_t chirp = firstChirp; chirp < numChirps; ++chirp) {
+                const std::complex<float> x = channel[chirp * n + bin];
+                const std::complex<float> r = reference[chirp * n + bin];
+                power += std::norm(x);
+                referencePower += std::norm(r);
+                cross += x * std::conj(r);
+            }
+            magnitude[i] = power / usedChirps;
+            phase[i] = std::arg(cross) * 180.0f / float(M_PI);
+            coherence[i] = std::norm(cross) / (power * referencePower + 1e-30f);
+        }
+        if (m_clutterMapEnabled) {
+            m_channelClutter[c].apply(magnitude.data(), bins);
+        }
+        for (size_t i = 0; i < bins; ++i) {
+            magnitude[i] = 10.0f * std::log10(magnitude[i] + 1e-20f);
+        }
+    });
+
+    // Keep the single-spectrum results in sync for the axes and labels
+    m_magnitudeSpectrum = m_channelMagnitudes[0];
+    updateFrequencyAxis(bins, shift);
+    m_maxMagnitude = 0.0f;
+    for (size_t i = 0; i < bins; ++i) {
+        m_maxMagnitude = std::max(m_maxMagnitude, m_magnitudeSpectrum[i]);
+    }
+    m_haveChannelSpectra = true;
+    return true;
+}
+
+void SpectrumProcessor::fft(std::complex<float>* data, size_t n)
+{
+    if (!fixedSizeFFT(data, n)) {
+        fftRuntime(data, n);
+    }
+}
+
+void SpectrumProcessor::fftRuntime(std::complex<float>* data, size_t n)
+{
+    if (n <= 1) return;
+
+    bit_reverse(data, n);
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        float angle = -2.0f * M_PI / len;
+        std::complex<float> wlen(std::cos(angle), std::sin(angle));
+
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<float> w(1.0f, 0.0f);
+            for (size_t j = 0; j < len / 2; ++j) {
+                std::complex<float> u = data[i + j];
+                std::complex<float> v = data[i + j + len / 2] * w;
+                data[i + j] = u + v;
+                data[i + j + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+void SpectrumProcessor::bit_reverse(std::complex<float>* data, size_t n)
+{
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "DataStructures.h"
+#include "BufferPool.h"
+#include "ClutterFilter.h"
+
+// Range FFT of ADC frames: windowing, FFT and magnitude/cross-spectrum
+// reduction. No Qt dependency, so the same code runs in the GUI, radar_cli
+// and the benchmarks.
+class SpectrumProcessor
+{
+public:
+    enum class WindowFunction {
+        Rectangular,
+        Hann
+    };
+
+    SpectrumProcessor();
+
+    void setWindowFunction(WindowFunction window);
+    WindowFunction windowFunction() const { return m_windowFunction; }
+
+    // Stationary clutter suppression (ClutterFilter.h), both off by default.
+    // MTI applies to ADC frames with enough chirps: the single spectrum then
+    // comes from chirps 0 .. taps - 1, the channel spectra average the
+    // canceller outputs. The clutter map applies to every computed spectrum
+    // except setSpectrum(), with its own background per RX channel.
+    using MtiMode = clutter::MtiMode;
+    void setMtiMode(MtiMode mode) { m_mtiMode = mode; }
+    MtiMode mtiMode() const { return m_mtiMode; }
+    void setClutterMapEnabled(bool enabled);
+    bool clutterMapEnabled() const { return m_clutterMapEnabled; }
+    void setClutterMapAlpha(float alpha);
+    // Chirps per frame that processChannels() uses, from the first; 0 = all
+    void setMaxChirps(size_t chirps) { m_maxChirps = chirps; }
+    size_t maxChirps() const { return m_maxChirps; }
+
+    // Single spectrum of a block of real samples
+    void process(const std::vector<float>& samples);
+    // Single spectrum of the first chirp of the first enabled RX channel;
+    // false when the frame has no enabled channel
+    bool process(const RawADCFrame& frame);
+    // Per-channel power averaged over all chirps, plus phase and coherence
+    // against the first enabled channel; false when no channel is enabled
+    bool processChannels(const RawADCFrame& frame);
+    // Linear-power average of the single spectra of several frames. Frames
+    // whose bin count differs from the first are skipped.
+    bool processAverage(const std::vector<const RawADCFrame*>& frames);
+    bool processAverage(const std::vector<const RawADCFrameTest*>& frames);
+    // Loads an already computed magnitude spectrum (dB), e.g. from an archive.
+    // The sample count is inferred as the FFT size of that layout.
+    void setSpectrum(const float* magnitude, size_t bins, bool twoSided);
+
+    // Magnitude in dB per displayed bin. Real input keeps the positive half;
+    // complex input keeps all bins, shifted so DC sits in the middle.
+    const std::vector<float>& magnitude() const { return m_magnitudeSpectrum; }
+    // Bin index of each displayed bin (negative bins first when two-sided)
+    const std::vector<float>& frequencyAxis() const { return m_frequencyAxis; }
+    float maxMagnitude() const { return m_maxMagnitude; }
+    bool twoSided() const { return m_twoSided; }
+    size_t sampleCount() const { return m_sampleCount; }
+
+    // Multi-channel results, valid after processChannels()
+    bool hasChannelSpectra() const { return m_haveChannelSpectra; }
+    const std::vector<int>& channels() const { return m_channels; }
+    const std::vector<std::vector<float>>& channelMagnitudes() const { return m_channelMagnitudes; }
+    const std::vector<std::vector<float>>& channelPhase() const { return m_channelPhase; }
+    const std::vector<std::vector<float>>& channelCoherence() const { return m_channelCoherence; }
+
+    // In-place radix-2 FFT (stateless, safe to call from worker threads).
+    // Sizes with a compile-time kernel (FftKernels.h) use it, the rest
+    // fftRuntime().
+    static void fft(std::complex<float>* data, size_t n);
+    static void fftRuntime(std::complex<float>* data, size_t n);
+    // Smallest power of two >= count
+    static size_t fftSize(size_t count);
+
+private:
+    size_t prepareFFTBuffer(size_t inputSize);
+    const float* windowCoefficients(size_t count);
+    void computeSpectrum();
+    void resetClutterMaps();
+    void updateFrequencyAxis(size_t bins, size_t shift);
+    bool averageSpectra(size_t count, const std::function<bool(size_t)>& processFrame);
+    static void bit_reverse(std::complex<float>* data, size_t n);
+
+    std::vector<float> m_magnitudeSpectrum;
+    std::vector<float> m_frequencyAxis;
+    std::vector<std::complex<float>> m_fftBuffer;
+    std::vector<float> m_window;
+    WindowFunction m_windowFunction;
+    bool m_twoSided;  // complex input: full fftshifted spectrum
+    size_t m_sampleCount;
+    float m_maxMagnitude;
+    std::vector<float> m_powerSum;  // processAverage() accumulator
+
+    // Clutter suppression
+    MtiMode m_mtiMode;
+    bool m_clutterMapEnabled;
+    float m_clutterMapAlpha;
+    ClutterMap m_clutterMap;
+    std::vector<ClutterMap> m_channelClutter;
+    std::vector<std::complex<float>> m_mtiRows;  // chirps fed to the canceller
+    std::vector<float> m_power;                  // linear power per displayed bin
+
+    // Multi-channel state: per-(channel, chirp) FFT buffers and per-channel results
+    bool m_haveChannelSpectra;
+    std::vector<int> m_channels;
+    uint32_t m_channelMask;  // channels the per-channel clutter maps belong to
+    size_t m_maxChirps;
+    PooledBuffer<std::complex<float>> m_channelBuffers;
+    std::vector<std::vector<float>> m_channelMagnitudes;
+    std::vector<std::vector<float>> m_channelPhase;
+    std::vector<std::vector<float>> m_channelCoherence;
+};
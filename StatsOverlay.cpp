@@ -0,0 +1,106 @@
+#include "StatsOverlay.h"
+#include "Instrumentation.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFont>
+#include <QFontMetrics>
+#include <algorithm>
+
+StatsOverlay::StatsOverlay(QWidget *parent)
+    : QWidget(parent)
+    , m_refreshTimer(new QTimer(this))
+    , m_lastSampleNs(0)
+    , m_lastDatagrams(0)
+    , m_lastBytes(0)
+    , m_lastFrames(0)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    connect(m_refreshTimer, &QTimer::timeout, this, &StatsOverlay::refresh);
+}
+
+void StatsOverlay::refresh()
+{
+    const Instrumentation& stats = Instrumentation::instance();
+
+    const uint64_t now = Instrumentation::nowNs();
+    const uint64_t datagrams = stats.datagrams();
+    const uint64_t bytes = stats.bytes();
+    const uint64_t frames = stats.frames();
+    double seconds = m_lastSampleNs ? (now - m_lastSampleNs) * 1e-9 : 0.0;
+    // Counters go backwards after Instrumentation::reset()
+    if (seconds <= 0.0 || datagrams < m_lastDatagrams || frames < m_lastFrames) {
+        seconds = 0.0;
+    }
+
+    m_lines.clear();
+    m_lines << QString("%1 %2 %3 %4 %5")
+               .arg("stage", -12).arg("n", 8).arg("p50 us", 9).arg("p99 us", 9).arg("max us", 9);
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+        const LatencyHistogram& h = stats.histogram(static_cast<Stage>(i));
+        m_lines << QString("%1 %2 %3 %4 %5")
+                   .arg(stageName(static_cast<Stage>(i)), -12)
+                   .arg(h.count(), 8)
+                   .arg(h.percentile(0.50) / 1e3, 9, 'f', 1)
+                   .arg(h.percentile(0.99) / 1e3, 9, 'f', 1)
+                   .arg(h.max() / 1e3, 9, 'f', 1);
+    }
+    if (seconds > 0.0) {
+        m_lines << QString("rx %1 pkt/s  %2 MB/s  %3 frames/s")
+                   .arg((datagrams - m_lastDatagrams) / seconds, 0, 'f', 0)
+                   .arg((bytes - m_lastBytes) / seconds / 1e6, 0, 'f', 2)
+                   .arg((frames - m_lastFrames) / seconds, 0, 'f', 1);
+    } else {
+        m_lines << QString("rx -");
+    }
+
+    m_lastSampleNs = now;
+    m_lastDatagrams = datagrams;
+    m_lastBytes = bytes;
+    m_lastFrames = frames;
+
+    // Size to the text so the overlay covers as little of the parent as possible
+    QFont font("Monospace", 8);
+    font.setStyleHint(QFont::TypeWriter);
+    setFont(font);
+    QFontMetrics metrics(font);
+    int textWidth = 0;
+    for (const QString& line : m_lines) {
+        textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+    }
+    resize(textWidth + 16, metrics.height() * m_lines.size() + 12);
+    update();
+}
+
+void StatsOverlay::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    m_lastSampleNs = 0;
+    refresh();
+    raise();
+    m_refreshTimer->start(REFRESH_INTERVAL_MS);
+}
+
+void StatsOverlay::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+void StatsOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 170));
+    painter.drawRoundedRect(rect(), 4, 4);
+
+    painter.setPen(QColor(0, 255, 0));
+    painter.setFont(font());
+    QFontMetrics metrics(font());
+    int y = 6 + metrics.ascent();
+    for (const QString& line : m_lines) {
+        painter.drawText(8, y, line);
+        y += metrics.height();
+    }
+}
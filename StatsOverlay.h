@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QWidget>
+#include <QStringList>
+#include <QTimer>
+#include <cstdint>
+
+// Translucent panel with per-stage latency percentiles and throughput,
+// sampled from Instrumentation while visible
+class StatsOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StatsOverlay(QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QTimer* m_refreshTimer;
+    QStringList m_lines;
+
+    // Previous counter sample for rate computation
+    uint64_t m_lastSampleNs;
+    uint64_t m_lastDatagrams;
+    uint64_t m_lastBytes;
+    uint64_t m_lastFrames;
+
+    static constexpr int REFRESH_INTERVAL_MS = 500;
+};
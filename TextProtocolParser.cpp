@@ -0,0 +1,309 @@
+#include "TextProtocolParser.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Floating-point std::from_chars needs libstdc++ 11 or MSVC 2019 16.4;
+// older toolchains (GCC 7.3 of the MinGW Qt 5.12 kit has no <charconv> at
+// all) use the parser below
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define RADAR_HAVE_FLOAT_FROM_CHARS 1
+#endif
+
+namespace {
+
+enum class Keyword {
+    None,
+    NumTargets,
+    TgtId,
+    Level,
+    Range,
+    Azimuth,
+    Elevation,
+    RadialSpeed,
+    AzimuthSpeed,
+    ElevationSpeed,
+    MsgId,
+    NumSamples,
+    ADC
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+inline bool equals(const char* token, const char* keyword, size_t length)
+{
+    return std::memcmp(token, keyword, length) == 0;
+}
+
+// Keywords are unique by (length, first character) apart from a few
+// pairs that one extra comparison separates
+Keyword classify(const char* token, size_t length)
+{
+    if (length < 4 || token[length - 1] != ':') {
+        return Keyword::None;
+    }
+    switch (length) {
+    case 4:
+        return equals(token, "ADC:", 4) ? Keyword::ADC : Keyword::None;
+    case 6:
+        switch (token[0]) {
+        case 'T': return equals(token, "TgtId:", 6) ? Keyword::TgtId : Keyword::None;
+        case 'L': return equals(token, "Level:", 6) ? Keyword::Level : Keyword::None;
+        case 'R': return equals(token, "Range:", 6) ? Keyword::Range : Keyword::None;
+        case 'M': return equals(token, "MsgId:", 6) ? Keyword::MsgId : Keyword::None;
+        default:  return Keyword::None;
+        }
+    case 8:
+        return equals(token, "Azimuth:", 8) ? Keyword::Azimuth : Keyword::None;
+    case 10:
+        return equals(token, "Elevation:", 10) ? Keyword::Elevation : Keyword::None;
+    case 11:
+        if (equals(token, "NumTargets:", 11)) return Keyword::NumTargets;
+        if (equals(token, "NumSamples:", 11)) return Keyword::NumSamples;
+        return Keyword::None;
+    case 12:
+        return equals(token, "RadialSpeed:", 12) ? Keyword::RadialSpeed : Keyword::None;
+    case 13:
+        return equals(token, "AzimuthSpeed:", 13) ? Keyword::AzimuthSpeed : Keyword::None;
+    case 15:
+        return equals(token, "ElevationSpeed:", 15) ? Keyword::ElevationSpeed : Keyword::None;
+    default:
+        return Keyword::None;
+    }
+}
+
+// Malformed numbers parse as 0, matching QString::toFloat()/toUInt()
+#ifdef RADAR_HAVE_FLOAT_FROM_CHARS
+
+template <typename T>
+T parseNumber(const char* begin, const char* end)
+{
+    if (begin != end && *begin == '+') {
+        ++begin;
+    }
+    T value{};
+    if (std::from_chars(begin, end, value).ec != std::errc()) {
+        return T{};
+    }
+    return value;
+}
+
+#else
+
+// Same results as std::from_chars on the decimal numbers senders produce;
+// locale independent, unlike strtof (Qt sets LC_NUMERIC from the environment).
+// inf/nan and hex floats parse as 0.
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+template <typename T>
+T parseNumber(const char* begin, const char* end);
+
+template <>
+uint32_t parseNumber<uint32_t>(const char* begin, const char* end)
+{
+    if (begin != end && *begin == '+') {
+        ++begin;
+    }
+    uint64_t value = 0;
+    for (const char* p = begin; p != end && isDigit(*p); ++p) {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        if (value > std::numeric_limits<uint32_t>::max()) {
+            return 0;
+        }
+    }
+    return static_cast<uint32_t>(value);
+}
+
+template <>
+float parseNumber<float>(const char* begin, const char* end)
+{
+    const char* p = begin;
+    if (p != end && *p == '+') {
+        ++p;
+    }
+    const bool negative = p != end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    // Up to 18 significant digits in the mantissa, the rest shift the exponent
+    const uint64_t mantissaLimit = 100000000000000000ull;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool digits = false;
+    for (; p != end && isDigit(*p); ++p) {
+        digits = true;
+        if (mantissa < mantissaLimit) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        } else {
+            ++exponent;
+        }
+    }
+    if (p != end && *p == '.') {
+        for (++p; p != end && isDigit(*p); ++p) {
+            digits = true;
+            if (mantissa < mantissaLimit) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (!digits) {
+        return 0.0f;
+    }
+    // An exponent without digits is not part of the number
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        const bool negativeExponent = q != end && *q == '-';
+        if (q != end && (*q == '+' || *q == '-')) {
+            ++q;
+        }
+        const char* digitsBegin = q;
+        int value = 0;
+        for (; q != end && isDigit(*q); ++q) {
+            value = std::min(value * 10 + (*q - '0'), 100000);
+        }
+        if (q != digitsBegin) {
+            exponent += negativeExponent ? -value : value;
+        }
+    }
+
+    // Powers of ten up to 1e22 are exact in double, so one multiplication or
+    // division rounds once; the rest are beyond float range anyway
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    double value = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        // Far outside float range: from_chars reports these as out of range
+        if (exponent > 40 || exponent < -85) {
+            return 0.0f;
+        }
+        for (; exponent > 22; exponent -= 22) {
+            value *= powers[22];
+        }
+        for (; exponent < -22; exponent += 22) {
+            value /= powers[22];
+        }
+        value = exponent >= 0 ? value * powers[exponent] : value / powers[-exponent];
+    }
+    const float result = static_cast<float>(value);
+    if ((mantissa != 0 && result == 0.0f) || result > std::numeric_limits<float>::max()) {
+        return 0.0f;
+    }
+    return negative ? -result : result;
+}
+
+#endif
+
+} // namespace
+
+TextMessageResult parseTextMessage(const char* data, size_t size,
+                                   TargetTrackData& tracks, RawADCFrameTest& adc)
+{
+    TextMessageResult result{false, false};
+    bool adcTouched = false;
+    TargetTrack* target = nullptr;
+
+    const char* p = data;
+    const char* end = data + size;
+
+    auto nextToken = [&](const char*& tokenBegin, const char*& tokenEnd) {
+        while (p < end && isSpace(*p)) ++p;
+        tokenBegin = p;
+        while (p < end && !isSpace(*p)) ++p;
+        tokenEnd = p;
+        return tokenBegin != tokenEnd;
+    };
+
+    const char* tokenBegin;
+    const char* tokenEnd;
+    while (nextToken(tokenBegin, tokenEnd)) {
+        Keyword keyword = classify(tokenBegin, tokenEnd - tokenBegin);
+        if (keyword == Keyword::None) {
+            continue;
+        }
+
+        // Every keyword takes the following token as its value
+        const char* valueBegin;
+        const char* valueEnd;
+        if (!nextToken(valueBegin, valueEnd)) {
+            break;
+        }
+
+        if (keyword == Keyword::ADC || keyword == Keyword::MsgId || keyword == Keyword::NumSamples) {
+            if (!adcTouched) {
+                adc.msgId = 0;
+                adc.num_samples_per_chirp = 0;
+                adc.sample_data.clear();
+                adcTouched = true;
+            }
+            switch (keyword) {
+            case Keyword::MsgId:
+                adc.msgId = parseNumber<uint32_t>(valueBegin, valueEnd);
+                break;
+            case Keyword::NumSamples:
+                adc.num_samples_per_chirp = parseNumber<uint32_t>(valueBegin, valueEnd);
+                // Each sample takes at least "ADC: 0 " in the remaining bytes
+                adc.sample_data.reserve(std::min<size_t>(adc.num_samples_per_chirp, (end - p) / 7 + 1));
+                break;
+            default:
+                adc.sample_data.push_back(parseNumber<float>(valueBegin, valueEnd));
+                result.hasADC = true;
+                break;
+            }
+            continue;
+        }
+
+        if (keyword == Keyword::NumTargets) {
+            uint32_t numTargets = parseNumber<uint32_t>(valueBegin, valueEnd);
+            tracks.targets.clear();
+            tracks.targets.reserve(std::min<size_t>(numTargets, (end - p) / 8 + 1));
+            tracks.numTracks = 0;
+            target = nullptr;
+            result.hasTracks = true;
+            continue;
+        }
+        if (!result.hasTracks) {
+            continue;
+        }
+
+        if (keyword == Keyword::TgtId) {
+            tracks.targets.push_back(TargetTrack());
+            target = &tracks.targets.back();
+            target->target_id = parseNumber<uint32_t>(valueBegin, valueEnd);
+            continue;
+        }
+        if (!target) {
+            continue;
+        }
+
+        float value = parseNumber<float>(valueBegin, valueEnd);
+        switch (keyword) {
+        case Keyword::Level:          target->level = value; break;
+        case Keyword::Range:          target->radius = value; break;
+        case Keyword::Azimuth:        target->azimuth = value; break;
+        case Keyword::Elevation:      target->elevation = value; break;
+        case Keyword::RadialSpeed:    target->radial_speed = value; break;
+        case Keyword::AzimuthSpeed:   target->azimuth_speed = value; break;
+        case Keyword::ElevationSpeed: target->elevation_speed = value; break;
+        default: break;
+        }
+    }
+
+    if (result.hasTracks) {
+        tracks.numTracks = static_cast<uint32_t>(tracks.targets.size());
+    }
+    return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include "DataStructures.h"
+
+// Single-pass parser for the legacy whitespace-separated text protocol:
+//
+//   NumTargets: 2 TgtId: 1 Level: 40 Range: 120.5 Azimuth: -12 ...
+//   MsgId: 7 NumSamples: 512 ADC: 0.12 ADC: -0.03 ...
+//
+// Works directly on the datagram bytes: keywords are matched with a switch
+// on token length, numbers are converted with std::from_chars (or an
+// equivalent locale-independent parser where the standard library lacks
+// floating-point from_chars), and no intermediate strings are created. Output containers are cleared and
+// refilled, so reusing the same outputs does not allocate once their
+// capacity has grown to the message size.
+struct TextMessageResult {
+    bool hasTracks;  // a NumTargets: keyword was present
+    bool hasADC;     // at least one ADC: sample was present
+};
+
+// Track fields are taken after NumTargets:, each TgtId: starts a new target.
+// `tracks` is only modified if the message contains NumTargets:, and
+// `adc` only if it contains MsgId:, NumSamples: or ADC:.
+TextMessageResult parseTextMessage(const char* data, size_t size,
+                                   TargetTrackData& tracks, RawADCFrameTest& adc);
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned numWorkers)
+    : m_generation(0)
+    , m_active(0)
+    , m_stop(false)
+    , m_task(nullptr)
+    , m_count(0)
+    , m_next(0)
+    , m_done(0)
+{
+    m_workers.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::run(size_t count, const TaskRef& task)
+{
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> busy(m_submitMutex, std::try_to_lock);
+    if (!busy.owns_lock() || m_workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task.invoke(task.object, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_done = 0;
+        m_next = 0;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    runTasks();
+
+    // Wait for the last index and for every worker to leave runTasks(),
+    // so no straggler can pick up an index of the next loop
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_done == m_count && m_active == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+        if (m_stop) return;
+
+        seenGeneration = m_generation;
+        if (!m_task) continue;
+
+        ++m_active;
+        lock.unlock();
+        runTasks();
+        lock.lock();
+        --m_active;
+        if (m_active == 0 && m_done == m_count) {
+            m_finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::runTasks()
+{
+    size_t index;
+    while ((index = m_next.fetch_add(1)) < m_count) {
+        m_task->invoke(m_task->object, index);
+        if (m_done.fetch_add(1) + 1 == m_count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished.notify_all();
+        }
+    }
+}
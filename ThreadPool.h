@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running data-parallel loops.
+// parallelFor() blocks until every index has been processed; the calling
+// thread takes part in the work. If the pool is already running a loop
+// (e.g. a nested call from inside a task) the loop runs inline instead.
+// The task is referenced, not copied, so starting a loop does not allocate.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned numWorkers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename Task>
+    void parallelFor(size_t count, const Task& task)
+    {
+        run(count, TaskRef{&task, [](const void* object, size_t index) {
+                               (*static_cast<const Task*>(object))(index);
+                           }});
+    }
+
+    // Threads that work on a loop, including the caller
+    unsigned concurrency() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // Process-wide pool sized to the machine (hardware threads - 1 workers)
+    static ThreadPool& instance();
+
+private:
+    struct TaskRef {
+        const void* object;
+        void (*invoke)(const void* object, size_t index);
+    };
+
+    void run(size_t count, const TaskRef& task);
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_submitMutex;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    uint64_t m_generation;
+    unsigned m_active;
+    bool m_stop;
+
+    const TaskRef* m_task;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+    std::atomic<size_t> m_done;
+};
@@ -0,0 +1,386 @@
+#include "TrackCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+// The seven float fields are read and written as one block
+static_assert(offsetof(TargetTrack, elevation_speed) - offsetof(TargetTrack, level) ==
+              (trackcodec::FIELDS - 1) * sizeof(float), "TargetTrack fields are not contiguous");
+
+namespace {
+
+constexpr size_t FIELD_OFFSET = offsetof(TargetTrack, level);
+constexpr uint32_t MAX_TRACKS = 1u << 20;  // sanity limit for malformed counts
+constexpr float QUANTIZE_LIMIT = 1073741824.0f;  // 2^30: deltas stay within 32 bits
+
+// Deltas are taken modulo 2^32, so decoding is exact even where the
+// difference of two quantised values would overflow int32
+inline uint32_t zigzag(uint32_t delta)
+{
+    return (delta << 1) ^ (0u - (delta >> 31));
+}
+
+inline uint32_t unzigzag(uint32_t value)
+{
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+inline int32_t quantize(float value, float inverseStep)
+{
+    const float scaled = value * inverseStep;
+    if (std::isnan(scaled)) {
+        return 0;
+    }
+    const float clamped = std::min(std::max(scaled, -QUANTIZE_LIMIT), QUANTIZE_LIMIT);
+    return static_cast<int32_t>(clamped + (clamped >= 0.0f ? 0.5f : -0.5f));
+}
+
+void putVarint(std::vector<char>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 35 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Bit width byte, then `count` values of that width, LSB first
+void putColumn(std::vector<char>& out, const uint32_t* values, size_t count)
+{
+    uint32_t all = 0;
+    for (size_t i = 0; i < count; ++i) {
+        all |= values[i];
+    }
+    unsigned bits = 0;
+    while (bits < 32 && (all >> bits) != 0) {
+        ++bits;
+    }
+    out.push_back(static_cast<char>(bits));
+    if (bits == 0) {
+        return;
+    }
+
+    const size_t start = out.size();
+    out.resize(start + (count * bits + 7) / 8);
+    char* dst = out.data() + start;
+    uint64_t accumulator = 0;
+    unsigned pending = 0;
+    for (size_t i = 0; i < count; ++i) {
+        accumulator |= static_cast<uint64_t>(values[i]) << pending;
+        pending += bits;
+        while (pending >= 8) {
+            *dst++ = static_cast<char>(accumulator);
+            accumulator >>= 8;
+            pending -= 8;
+        }
+    }
+    if (pending > 0) {
+        *dst = static_cast<char>(accumulator);
+    }
+}
+
+bool getColumn(const uint8_t*& p, const uint8_t* end, size_t count, std::vector<uint32_t>& values)
+{
+    if (p >= end) {
+        return false;
+    }
+    const unsigned bits = *p++;
+    values.resize(count);
+    if (bits == 0) {
+        std::fill(values.begin(), values.end(), 0u);
+        return true;
+    }
+    const size_t bytes = (count * bits + 7) / 8;
+    if (bits > 32 || bytes > static_cast<size_t>(end - p)) {
+        return false;
+    }
+
+    // Unaligned 64-bit loads while they stay inside the datagram: no
+    // branches and no dependency between values
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    const size_t available = static_cast<size_t>(end - p);
+    const size_t fast = available >= 8 ? std::min(count, ((available - 8) * 8) / bits + 1) : 0;
+    uint32_t* out = values.data();
+    for (size_t i = 0; i < fast; ++i) {
+        const size_t bit = i * bits;
+        uint64_t word;
+        std::memcpy(&word, p + (bit >> 3), sizeof(word));
+        out[i] = static_cast<uint32_t>((word >> (bit & 7)) & mask);
+    }
+    for (size_t i = fast; i < count; ++i) {
+        const size_t bit = i * bits;
+        uint64_t word = 0;
+        for (size_t b = bit >> 3, shift = 0; b < bytes && shift < 64; ++b, shift += 8) {
+            word |= static_cast<uint64_t>(p[b]) << shift;
+        }
+        out[i] = static_cast<uint32_t>((word >> (bit & 7)) & mask);
+    }
+    p += bytes;
+    return true;
+}
+
+} // namespace
+
+namespace trackcodec {
+
+void Frame::clear()
+{
+    resize(0);
+    index();
+}
+
+void Frame::resize(size_t count)
+{
+    ids.resize(count);
+    for (std::vector<int32_t>& column : values) {
+        column.resize(count);
+    }
+}
+
+void Frame::index()
+{
+    size_t capacity = 16;
+    while (capacity < 2 * ids.size()) {
+        capacity *= 2;
+    }
+    m_table.assign(capacity, 0);
+    m_mask = capacity - 1;
+    for (size_t row = 0; row < ids.size(); ++row) {
+        // Fibonacci hashing spreads sequential ids across the table
+        size_t slot = (ids[row] * 2654435769u) & m_mask;
+        while (m_table[slot] != 0) {
+            if (ids[m_table[slot] - 1] == ids[row]) {
+                break;  // duplicate id: the first row wins
+            }
+            slot = (slot + 1) & m_mask;
+        }
+        if (m_table[slot] == 0) {
+            m_table[slot] = static_cast<uint32_t>(row + 1);
+        }
+    }
+}
+
+int32_t Frame::find(uint32_t id, size_t hint) const
+{
+    // Encoder and decoder look up with the same hints in the same frame, so
+    // they agree even when an id appears twice
+    if (hint < ids.size() && ids[hint] == id) {
+        return static_cast<int32_t>(hint);
+    }
+    if (m_table.empty()) {
+        return -1;
+    }
+    for (size_t slot = (id * 2654435769u) & m_mask; m_table[slot] != 0; slot = (slot + 1) & m_mask) {
+        if (ids[m_table[slot] - 1] == id) {
+            return static_cast<int32_t>(m_table[slot] - 1);
+        }
+    }
+    return -1;
+}
+
+} // namespace trackcodec
+
+TrackEncoder::TrackEncoder(uint32_t keyframeInterval)
+    : m_keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1)
+    , m_framesSinceKeyframe(0)
+    , m_sequence(0)
+{
+}
+
+void TrackEncoder::encode(const TargetTrackData& tracks, std::vector<char>& out)
+{
+    using namespace trackcodec;
+    const size_t count = std::min<size_t>({tracks.numTracks, tracks.targets.size(), MAX_TRACKS});
+    const bool keyframe = m_framesSinceKeyframe == 0;
+    m_framesSinceKeyframe = (m_framesSinceKeyframe + 1) % m_keyframeInterval;
+    if (keyframe) {
+        m_reference.clear();
+    }
+
+    float inverseSteps[FIELDS];
+    for (size_t f = 0; f < FIELDS; ++f) {
+        inverseSteps[f] = 1.0f / STEPS[f];
+    }
+    m_current.resize(count);
+    m_referenceRows.resize(count);
+    m_known.clear();
+    m_new.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const TargetTrack& target = tracks.targets[i];
+        float fields[FIELDS];
+        std::memcpy(fields, reinterpret_cast<const char*>(&target) + FIELD_OFFSET, sizeof(fields));
+        m_current.ids[i] = target.target_id;
+        for (size_t f = 0; f < FIELDS; ++f) {
+            m_current.values[f][i] = quantize(fields[f], inverseSteps[f]);
+        }
+        m_referenceRows[i] = m_reference.find(target.target_id, i);
+        (m_referenceRows[i] >= 0 ? m_known : m_new).push_back(static_cast<uint32_t>(i));
+    }
+
+    out.resize(sizeof(MessageHeader));
+    out.push_back(static_cast<char>(FORMAT_VERSION));
+    out.push_back(static_cast<char>(keyframe ? FLAG_KEYFRAME : 0));
+    out.push_back(static_cast<char>(m_sequence & 0xFF));
+    out.push_back(static_cast<char>(m_sequence >> 8));
+    putVarint(out, static_cast<uint32_t>(count));
+
+    m_column.resize(count);
+    uint32_t previousId = 0;
+    for (size_t i = 0; i < count; ++i) {
+        m_column[i] = zigzag(m_current.ids[i] - previousId);
+        previousId = m_current.ids[i];
+    }
+    putColumn(out, m_column.data(), count);
+
+    for (size_t f = 0; f < FIELDS; ++f) {
+        const std::vector<int32_t>& values = m_current.values[f];
+        const std::vector<int32_t>& reference = m_reference.values[f];
+        for (size_t k = 0; k < m_known.size(); ++k) {
+            const uint32_t row = m_known[k];
+            m_column[k] = zigzag(static_cast<uint32_t>(values[row]) -
+                                 static_cast<uint32_t>(reference[m_referenceRows[row]]));
+        }
+        putColumn(out, m_column.data(), m_known.size());
+        for (size_t k = 0; k < m_new.size(); ++k) {
+            m_column[k] = zigzag(static_cast<uint32_t>(values[m_new[k]]));
+        }
+        putColumn(out, m_column.data(), m_new.size());
+    }
+
+    MessageHeader header;
+    header.type = MessageType::TRACK_DELTA_DATA;
+    header.data_size = static_cast<uint32_t>(out.size() - sizeof(header));
+    header.timestamp = tracks.timestamp_us;
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::swap(m_reference, m_current);
+    m_reference.index();
+    ++m_sequence;
+}
+
+TrackDecoder::Result TrackDecoder::decode(const char* data, size_t size, TargetTrackData& tracks)
+{
+    using namespace trackcodec;
+    MessageHeader header;
+    if (size < sizeof(header)) {
+        return Result::NotTrackMessage;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.type != MessageType::TRACK_DELTA_DATA) {
+        return Result::NotTrackMessage;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data) + sizeof(header);
+    const uint8_t* end = reinterpret_cast<const uint8_t*>(data) + size;
+    if (header.data_size != size - sizeof(header) || end - p < 4 || p[0] != FORMAT_VERSION) {
+        return fail(Result::Malformed);
+    }
+    const bool keyframe = (p[1] & FLAG_KEYFRAME) != 0;
+    const uint16_t sequence = static_cast<uint16_t>(p[2] | (p[3] << 8));
+    p += 4;
+    if (!keyframe && m_haveReference && static_cast<int16_t>(sequence - m_sequence) <= 0) {
+        // Already decoded or older: a reordering link must not cost the reference
+        ++m_stats.stale;
+        return Result::Stale;
+    }
+    if (!keyframe && (!m_haveReference || sequence != static_cast<uint16_t>(m_sequence + 1))) {
+        m_haveReference = false;
+        ++m_stats.skipped;
+        return Result::NeedKeyframe;
+    }
+    if (keyframe) {
+        m_reference.clear();
+    }
+
+    uint32_t count = 0;
+    if (!getVarint(p, end, count) || count > MAX_TRACKS || !getColumn(p, end, count, m_column)) {
+        return fail(Result::Malformed);
+    }
+    m_current.resize(count);
+    m_known.clear();
+    m_knownRows.clear();
+    m_new.clear();
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        id += unzigzag(m_column[i]);
+        m_current.ids[i] = id;
+        const int32_t row = m_reference.find(id, i);
+        if (row >= 0) {
+            m_known.push_back(i);
+            m_knownRows.push_back(row);
+        } else {
+            m_new.push_back(i);
+        }
+    }
+
+    for (size_t f = 0; f < FIELDS; ++f) {
+        int32_t* values = m_current.values[f].data();
+        if (!getColumn(p, end, m_known.size(), m_column)) {
+            return fail(Result::Malformed);
+        }
+        const int32_t* reference = m_reference.values[f].data();
+        for (size_t k = 0; k < m_known.size(); ++k) {
+            values[m_known[k]] = static_cast<int32_t>(
+                static_cast<uint32_t>(reference[m_knownRows[k]]) + unzigzag(m_column[k]));
+        }
+        if (!getColumn(p, end, m_new.size(), m_column)) {
+            return fail(Result::Malformed);
+        }
+        for (size_t k = 0; k < m_new.size(); ++k) {
+            values[m_new[k]] = static_cast<int32_t>(unzigzag(m_column[k]));
+        }
+    }
+    if (p != end) {
+        return fail(Result::Malformed);
+    }
+
+    tracks.resize(count);
+    tracks.timestamp_us = header.timestamp;
+    for (uint32_t i = 0; i < count; ++i) {
+        TargetTrack& target = tracks.targets[i];
+        target.target_id = m_current.ids[i];
+        float fields[FIELDS];
+        for (size_t f = 0; f < FIELDS; ++f) {
+            fields[f] = static_cast<float>(m_current.values[f][i]) * STEPS[f];
+        }
+        std::memcpy(reinterpret_cast<char*>(&target) + FIELD_OFFSET, fields, sizeof(fields));
+    }
+
+    std::swap(m_reference, m_current);
+    m_reference.index();
+    m_sequence = sequence;
+    m_haveReference = true;
+    if (keyframe) {
+        ++m_stats.keyframes;
+    } else {
+        ++m_stats.deltaFrames;
+    }
+    return Result::Decoded;
+}
+
+void TrackDecoder::reset()
+{
+    m_haveReference = false;
+    m_reference.clear();
+}
+
+TrackDecoder::Result TrackDecoder::fail(Result result)
+{
+    m_haveReference = false;
+    ++m_stats.malformed;
+    return result;
+}
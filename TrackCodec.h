@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DataStructures.h"
+
+// Compact binary track datagrams (TRACK_DELTA_DATA) for low-bandwidth
+// links: MessageHeader, then
+//   u8 format version, u8 flags (bit 0: keyframe), u16 sequence,
+//   varint track count,
+//   target ids: zigzag delta to the previous id in the frame,
+//   per field: values of tracks present in the previous frame, then of new
+//   tracks.
+// Fields are quantised to fixed point (STEPS). Tracks already in the
+// previous frame are sent as deltas to their previous quantised value,
+// keyed by target_id; new tracks and every track of a keyframe are sent
+// as absolute values. Each of these columns is zigzag coded and bit-packed
+// at the width of its largest value. A delta frame only decodes when the
+// frame before it did, so after a loss the decoder waits for the next
+// keyframe (every `keyframeInterval` frames).
+namespace trackcodec {
+
+constexpr uint8_t FORMAT_VERSION = 1;
+constexpr uint8_t FLAG_KEYFRAME = 1;
+constexpr size_t FIELDS = 7;
+
+// Quantisation step per field, in the units of TargetTrack: level,
+// radius, azimuth, elevation, radial_speed, azimuth_speed, elevation_speed
+constexpr float STEPS[FIELDS] = {0.01f, 0.01f, 0.01f, 0.01f, 0.01f, 0.01f, 0.01f};
+
+// Quantised tracks of one frame (the reference for the next), with an
+// open-addressing index by target id
+class Frame
+{
+public:
+    void clear();
+    void resize(size_t count);
+    size_t size() const { return ids.size(); }
+    // Rebuilds the id index after ids changed
+    void index();
+    // Row of `id`, or -1. `hint` is tried first: tracks usually keep their
+    // position from frame to frame.
+    int32_t find(uint32_t id, size_t hint) const;
+
+    std::vector<uint32_t> ids;
+    std::vector<int32_t> values[FIELDS];
+
+private:
+    std::vector<uint32_t> m_table;  // row + 1, 0 = empty
+    size_t m_mask = 0;
+};
+
+} // namespace trackcodec
+
+class TrackEncoder
+{
+public:
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 16;
+
+    explicit TrackEncoder(uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Encodes `tracks` as a TRACK_DELTA_DATA datagram into `out` (replacing
+    // its contents). The message timestamp is tracks.timestamp_us.
+    void encode(const TargetTrackData& tracks, std::vector<char>& out);
+    // The next frame is a keyframe, e.g. when a receiver (re)joins
+    void requestKeyframe() { m_framesSinceKeyframe = 0; }
+    void setKeyframeInterval(uint32_t frames) { m_keyframeInterval = frames > 0 ? frames : 1; }
+
+private:
+    uint32_t m_keyframeInterval;
+    uint32_t m_framesSinceKeyframe;
+    uint16_t m_sequence;
+    trackcodec::Frame m_reference;
+    trackcodec::Frame m_current;
+    std::vector<int32_t> m_referenceRows;
+    std::vector<uint32_t> m_known;     // rows coded as deltas
+    std::vector<uint32_t> m_new;       // rows coded as absolute values
+    std::vector<uint32_t> m_column;    // zigzag values being packed
+};
+
+class TrackDecoder
+{
+public:
+    enum class Result {
+        Decoded,
+        NotTrackMessage,   // some other message type: try the next decoder
+        Malformed,
+        NeedKeyframe,      // a frame before this delta frame was lost
+        Stale              // duplicate or late delta frame, the reference is kept
+    };
+
+    struct Stats {
+        uint64_t keyframes = 0;
+        uint64_t deltaFrames = 0;
+        uint64_t skipped = 0;   // delta frames dropped while waiting for a keyframe
+        uint64_t stale = 0;     // delta frames not newer than the reference
+        uint64_t malformed = 0;
+    };
+
+    // Decodes a TRACK_DELTA_DATA datagram into `tracks`, reusing its
+    // storage. tracks.timestamp_us is set from the message header.
+    Result decode(const char* data, size_t size, TargetTrackData& tracks);
+    void reset();
+    const Stats& stats() const { return m_stats; }
+
+private:
+    Result fail(Result result);
+
+    bool m_haveReference = false;
+    uint16_t m_sequence = 0;    // of the reference frame
+    trackcodec::Frame m_reference;
+    trackcodec::Frame m_current;
+    std::vector<uint32_t> m_known;
+    std::vector<int32_t> m_knownRows;  // reference row of each known track
+    std::vector<uint32_t> m_new;
+    std::vector<uint32_t> m_column;
+    Stats m_stats;
+};
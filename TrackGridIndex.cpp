@@ -0,0 +1,134 @@
+#include "TrackGridIndex.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void TrackGridIndex::clear()
+{
+    m_columns = 0;
+    m_rows = 0;
+    m_cellStart.clear();
+    m_x.clear();
+    m_y.clear();
+    m_track.clear();
+}
+
+void TrackGridIndex::build(const std::vector<TargetTrack>& tracks, float maxRange, float minAzimuth,
+                           float maxAzimuth)
+{
+    // Positions of the tracks in view, and their bounding box
+    m_scratchX.clear();
+    m_scratchY.clear();
+    m_scratchTrack.clear();
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    const float degreesToRadians = float(M_PI) / 180.0f;
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const float radius = tracks[i].radius;
+        const float azimuth = tracks[i].azimuth;
+        // Written so that NaN fields are rejected too
+        if (!(azimuth >= minAzimuth && azimuth <= maxAzimuth && radius <= maxRange)) {
+            continue;
+        }
+        const float radians = azimuth * degreesToRadians;
+        const float x = radius * std::sin(radians);
+        const float y = radius * std::cos(radians);
+        if (m_scratchX.empty()) {
+            minX = maxX = x;
+            minY = maxY = y;
+        } else {
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        m_scratchX.push_back(x);
+        m_scratchY.push_back(y);
+        m_scratchTrack.push_back(static_cast<uint32_t>(i));
+    }
+
+    const size_t count = m_scratchX.size();
+    if (count == 0) {
+        clear();
+        return;
+    }
+
+    // Roughly square cells holding TRACKS_PER_CELL tracks on average
+    const float width = std::max(maxX - minX, 1e-3f);
+    const float height = std::max(maxY - minY, 1e-3f);
+    const float targetCells = std::max<float>(1.0f, float(count) / TRACKS_PER_CELL);
+    const float cellSize = std::sqrt(width * height / targetCells);
+    m_columns = std::min<size_t>(MAX_CELLS_PER_SIDE, std::max<size_t>(1, size_t(std::ceil(width / cellSize))));
+    m_rows = std::min<size_t>(MAX_CELLS_PER_SIDE, std::max<size_t>(1, size_t(std::ceil(height / cellSize))));
+    m_minX = minX;
+    m_minY = minY;
+    // Slightly below columns / width, so the far edge still lands in the last cell
+    m_cellsPerMeterX = m_columns / width * 0.9999f;
+    m_cellsPerMeterY = m_rows / height * 0.9999f;
+
+    // Counting sort by cell
+    m_cellOf.resize(count);
+    m_cellStart.assign(m_columns * m_rows + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t column = std::min(m_columns - 1, size_t((m_scratchX[i] - minX) * m_cellsPerMeterX));
+        const size_t row = std::min(m_rows - 1, size_t((m_scratchY[i] - minY) * m_cellsPerMeterY));
+        m_cellOf[i] = static_cast<uint32_t>(row * m_columns + column);
+        ++m_cellStart[m_cellOf[i] + 1];
+    }
+    for (size_t cell = 1; cell < m_cellStart.size(); ++cell) {
+        m_cellStart[cell] += m_cellStart[cell - 1];
+    }
+    m_x.resize(count);
+    m_y.resize(count);
+    m_track.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t slot = m_cellStart[m_cellOf[i]]++;
+        m_x[slot] = m_scratchX[i];
+        m_y[slot] = m_scratchY[i];
+        m_track[slot] = m_scratchTrack[i];
+    }
+    // The fill advanced every start to the next cell's; shift them back
+    for (size_t cell = m_cellStart.size() - 1; cell > 0; --cell) {
+        m_cellStart[cell] = m_cellStart[cell - 1];
+    }
+    m_cellStart[0] = 0;
+}
+
+void TrackGridIndex::query(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    if (m_columns == 0 || !(minX <= maxX && minY <= maxY)) {
+        return;
+    }
+    const auto cellRange = [](float low, float high, float origin, float scale, size_t cells,
+                              size_t& first, size_t& last) {
+        const float a = (low - origin) * scale;
+        const float b = (high - origin) * scale;
+        if (b < 0.0f || a >= float(cells)) {
+            return false;
+        }
+        first = a > 0.0f ? size_t(a) : 0;
+        last = b < float(cells) ? size_t(b) : cells - 1;
+        return true;
+    };
+    size_t column0, column1, row0, row1;
+    if (!cellRange(minX, maxX, m_minX, m_cellsPerMeterX, m_columns, column0, column1) ||
+        !cellRange(minY, maxY, m_minY, m_cellsPerMeterY, m_rows, row0, row1)) {
+        return;
+    }
+
+    // The cells of one grid row are consecutive, and so are their slots
+    for (size_t row = row0; row <= row1; ++row) {
+        const uint32_t begin = m_cellStart[row * m_columns + column0];
+        const uint32_t end = m_cellStart[row * m_columns + column1 + 1];
+        for (uint32_t slot = begin; slot < end; ++slot) {
+            const float x = m_x[slot];
+            const float y = m_y[slot];
+            if (x >= minX && x <= maxX && y >= minY && y <= maxY) {
+                out.push_back(slot);
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DataStructures.h"
+
+// Uniform grid over the plane positions of one frame of tracks, for culling
+// against a zoomed PPI viewport. build() converts every track to x (east) /
+// y (north) metres once and counting-sorts them by cell into SoA arrays, so
+// a query only reads the cells overlapping its rectangle, contiguously, and
+// painting needs no trigonometry.
+class TrackGridIndex
+{
+public:
+    static constexpr size_t TRACKS_PER_CELL = 4;     // average the cell size aims for
+    static constexpr size_t MAX_CELLS_PER_SIDE = 256;
+
+    // Tracks beyond maxRange or outside [minAzimuth, maxAzimuth] (degrees,
+    // 0 = north, positive clockwise) are left out
+    void build(const std::vector<TargetTrack>& tracks, float maxRange, float minAzimuth, float maxAzimuth);
+    void clear();
+
+    // Slots of the tracks inside [minX, maxX] x [minY, maxY], in cell order
+    void query(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const;
+
+    // Indexed tracks; per slot: position and index into the built tracks
+    size_t size() const { return m_track.size(); }
+    const float* x() const { return m_x.data(); }
+    const float* y() const { return m_y.data(); }
+    const uint32_t* track() const { return m_track.data(); }
+
+private:
+    float m_minX = 0.0f;
+    float m_minY = 0.0f;
+    float m_cellsPerMeterX = 0.0f;
+    float m_cellsPerMeterY = 0.0f;
+    size_t m_columns = 0;
+    size_t m_rows = 0;
+    std::vector<uint32_t> m_cellStart;  // first slot per cell, one extra entry at the end
+    std::vector<uint32_t> m_cellOf;     // build scratch: cell per candidate track
+    std::vector<float> m_scratchX;      // build scratch: positions in track order
+    std::vector<float> m_scratchY;
+    std::vector<uint32_t> m_scratchTrack;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<uint32_t> m_track;
+};
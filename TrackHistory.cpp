@@ -0,0 +1,180 @@
+#include "TrackHistory.h"
+#include <algorithm>
+
+TrackHistory::TrackHistory(size_t maxTracks, size_t trailLength, uint32_t maxMissedUpdates)
+    : m_slots(std::max<size_t>(1, maxTracks))
+    , m_trailLength(std::max<size_t>(2, trailLength))
+    , m_bucketMask(0)
+    , m_maxMissedUpdates(maxMissedUpdates)
+    , m_updateCount(0)
+    , m_droppedTracks(0)
+{
+    size_t buckets = 1;
+    while (buckets < 2 * m_slots.size()) {
+        buckets <<= 1;
+    }
+    m_buckets.resize(buckets);
+    m_bucketMask = buckets - 1;
+    m_freeSlots.reserve(m_slots.size());
+    m_active.reserve(m_slots.size());
+    m_arena.resize(m_slots.size() * m_trailLength);
+    clear();
+}
+
+void TrackHistory::clear()
+{
+    for (Bucket& bucket : m_buckets) {
+        bucket.slot = EMPTY;
+    }
+    m_active.clear();
+    m_freeSlots.clear();
+    // Hand out low slots first so a small track set stays in a compact part of the arena
+    for (size_t i = m_slots.size(); i-- > 0;) {
+        m_freeSlots.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+void TrackHistory::setTrailLength(size_t trailLength)
+{
+    trailLength = std::max<size_t>(2, trailLength);
+    if (trailLength == m_trailLength) {
+        return;
+    }
+    m_trailLength = trailLength;
+    m_arena.assign(m_slots.size() * m_trailLength, Point());
+    clear();
+}
+
+void TrackHistory::update(const TargetTrackData& trackData)
+{
+    ++m_updateCount;
+
+    const size_t count = std::min<size_t>(trackData.numTracks, trackData.targets.size());
+    for (size_t i = 0; i < count; ++i) {
+        const TargetTrack& target = trackData.targets[i];
+        int32_t slotIndex = find(target.target_id);
+        if (slotIndex == EMPTY) {
+            slotIndex = insert(target.target_id);
+            if (slotIndex == EMPTY) {
+                ++m_droppedTracks;
+                continue;
+            }
+        }
+
+        Slot& slot = m_slots[slotIndex];
+        m_arena[slotIndex * m_trailLength + slot.head] = Point{target.radius, target.azimuth};
+        slot.head = slot.head + 1 == m_trailLength ? 0 : slot.head + 1;
+        slot.count = std::min<uint32_t>(slot.count + 1, static_cast<uint32_t>(m_trailLength));
+        slot.lastSeen = m_updateCount;
+    }
+
+    // Eviction sweep: linear in live tracks, i.e. O(1) amortised per track
+    for (size_t i = 0; i < m_active.size();) {
+        const uint32_t slotIndex = m_active[i];
+        if (m_updateCount - m_slots[slotIndex].lastSeen > m_maxMissedUpdates) {
+            erase(m_slots[slotIndex].targetId);
+            release(slotIndex);  // moves the last active slot into position i
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool TrackHistory::findTrail(uint32_t targetId, Trail& trail) const
+{
+    const int32_t slotIndex = find(targetId);
+    if (slotIndex == EMPTY) {
+        return false;
+    }
+    trail = trailOf(slotIndex);
+    return true;
+}
+
+size_t TrackHistory::bucketOf(uint32_t targetId) const
+{
+    // Fibonacci hashing spreads sequential ids across the table
+    return static_cast<size_t>((targetId * 0x9E3779B97F4A7C15ull) >> 32) & m_bucketMask;
+}
+
+int32_t TrackHistory::find(uint32_t targetId) const
+{
+    for (size_t i = bucketOf(targetId);; i = (i + 1) & m_bucketMask) {
+        const Bucket& bucket = m_buckets[i];
+        if (bucket.slot == EMPTY) {
+            return EMPTY;
+        }
+        if (bucket.targetId == targetId) {
+            return bucket.slot;
+        }
+    }
+}
+
+int32_t TrackHistory::insert(uint32_t targetId)
+{
+    if (m_freeSlots.empty()) {
+        return EMPTY;
+    }
+    const uint32_t slotIndex = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    Slot& slot = m_slots[slotIndex];
+    slot.targetId = targetId;
+    slot.head = 0;
+    slot.count = 0;
+    slot.lastSeen = m_updateCount;
+    slot.activeIndex = static_cast<uint32_t>(m_active.size());
+    m_active.push_back(slotIndex);
+
+    // The table is at most half full, so probing always finds a free bucket
+    size_t i = bucketOf(targetId);
+    while (m_buckets[i].slot != EMPTY) {
+        i = (i + 1) & m_bucketMask;
+    }
+    m_buckets[i] = Bucket{targetId, static_cast<int32_t>(slotIndex)};
+    return static_cast<int32_t>(slotIndex);
+}
+
+void TrackHistory::erase(uint32_t targetId)
+{
+    size_t i = bucketOf(targetId);
+    while (m_buckets[i].targetId != targetId || m_buckets[i].slot == EMPTY) {
+        i = (i + 1) & m_bucketMask;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    for (;;) {
+        m_buckets[i].slot = EMPTY;
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & m_bucketMask;
+            if (m_buckets[j].slot == EMPTY) {
+                return;
+            }
+            // Move bucket j back unless its home lies cyclically in (i, j]
+            const size_t home = bucketOf(m_buckets[j].targetId);
+            const bool between = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!between) {
+                break;
+            }
+        }
+        m_buckets[i] = m_buckets[j];
+        i = j;
+    }
+}
+
+void TrackHistory::release(uint32_t slotIndex)
+{
+    const uint32_t activeIndex = m_slots[slotIndex].activeIndex;
+    const uint32_t last = m_active.back();
+    m_active[activeIndex] = last;
+    m_slots[last].activeIndex = activeIndex;
+    m_active.pop_back();
+    m_freeSlots.push_back(slotIndex);
+}
+
+TrackHistory::Trail TrackHistory::trailOf(uint32_t slotIndex) const
+{
+    const Slot& slot = m_slots[slotIndex];
+    return Trail(&m_arena[slotIndex * m_trailLength], slot.head, slot.count,
+                 static_cast<uint32_t>(m_trailLength));
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DataStructures.h"
+
+// Last N positions of every track, for drawing trails.
+// All trails live in one preallocated arena of maxTracks * trailLength
+// points and are found through an open-addressing (linear probing) table
+// keyed by target_id, so an update is O(1) per track and memory never
+// grows after construction. Tracks missing from too many consecutive
+// updates are evicted; new tracks are dropped while the arena is full.
+class TrackHistory
+{
+public:
+    struct Point {
+        float radius;
+        float azimuth;
+    };
+
+    // Read-only view of one trail, index 0 is the oldest point
+    class Trail
+    {
+    public:
+        Trail() : m_ring(nullptr), m_head(0), m_count(0), m_capacity(0) {}
+        Trail(const Point* ring, uint32_t head, uint32_t count, uint32_t capacity)
+            : m_ring(ring), m_head(head), m_count(count), m_capacity(capacity) {}
+
+        size_t size() const { return m_count; }
+        const Point& operator[](size_t i) const
+        {
+            size_t index = m_head + m_capacity - m_count + i;
+            if (index >= m_capacity) {
+                index -= m_capacity;
+            }
+            return m_ring[index];
+        }
+
+    private:
+        const Point* m_ring;
+        uint32_t m_head;  // next write position
+        uint32_t m_count;
+        uint32_t m_capacity;
+    };
+
+    static constexpr size_t DEFAULT_MAX_TRACKS = 16384;
+    static constexpr size_t DEFAULT_TRAIL_LENGTH = 32;
+    static constexpr uint32_t DEFAULT_MAX_MISSED_UPDATES = 8;
+
+    explicit TrackHistory(size_t maxTracks = DEFAULT_MAX_TRACKS,
+                          size_t trailLength = DEFAULT_TRAIL_LENGTH,
+                          uint32_t maxMissedUpdates = DEFAULT_MAX_MISSED_UPDATES);
+
+    // Appends the current position of every track and evicts stale ones
+    void update(const TargetTrackData& trackData);
+    void clear();
+
+    // Reallocates the arena; existing trails are discarded
+    void setTrailLength(size_t trailLength);
+    size_t trailLength() const { return m_trailLength; }
+    size_t maxTracks() const { return m_slots.size(); }
+    size_t trackCount() const { return m_active.size(); }
+    // Tracks not recorded because the arena was full
+    uint64_t droppedTracks() const { return m_droppedTracks; }
+
+    // False if the target has no history
+    bool findTrail(uint32_t targetId, Trail& trail) const;
+
+    // Calls fn(targetId, const Trail&) for every tracked target
+    template <typename Fn>
+    void forEachTrail(Fn&& fn) const
+    {
+        for (uint32_t slotIndex : m_active) {
+            const Slot& slot = m_slots[slotIndex];
+            fn(slot.targetId, trailOf(slotIndex));
+        }
+    }
+
+private:
+    static constexpr int32_t EMPTY = -1;
+
+    struct Slot {
+        uint32_t targetId;
+        uint32_t head;
+        uint32_t count;
+        uint32_t lastSeen;     // update counter when the track last appeared
+        uint32_t activeIndex;  // position in m_active
+    };
+
+    struct Bucket {
+        uint32_t targetId;
+        int32_t slot;  // EMPTY if unused
+    };
+
+    size_t bucketOf(uint32_t targetId) const;
+    int32_t find(uint32_t targetId) const;
+    int32_t insert(uint32_t targetId);
+    void erase(uint32_t targetId);
+    void release(uint32_t slotIndex);
+    Trail trailOf(uint32_t slotIndex) const;
+
+    std::vector<Point> m_arena;     // slot i owns [i * m_trailLength, (i + 1) * m_trailLength)
+    std::vector<Slot> m_slots;
+    std::vector<Bucket> m_buckets;  // power of two, at most half full
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<uint32_t> m_active; // slots in use, for iteration and eviction
+    size_t m_trailLength;
+    size_t m_bucketMask;
+    uint32_t m_maxMissedUpdates;
+    uint32_t m_updateCount;
+    uint64_t m_droppedTracks;
+};
@@ -0,0 +1,123 @@
+#include "TrackMerger.h"
+#include <algorithm>
+#include <limits>
+
+TrackMerger::TrackMerger(uint64_t staleUs)
+    : m_staleUs(staleUs)
+    , m_skewUs(0)
+    , m_lastViewTime(std::numeric_limits<int64_t>::min())
+{
+}
+
+void TrackMerger::setSourceCount(size_t count)
+{
+    m_sources.clear();
+    m_sources.resize(count);
+    m_skewUs = 0;
+    m_lastViewTime = std::numeric_limits<int64_t>::min();
+}
+
+void TrackMerger::add(size_t source, const TargetTrackData& frame, uint64_t arrivalUs)
+{
+    if (source >= m_sources.size()) {
+        return;
+    }
+    Source& s = m_sources[source];
+    TargetTrackData& slot = s.frames[s.next];
+    const size_t count = std::min<size_t>(frame.numTracks, frame.targets.size());
+    slot.targets.assign(frame.targets.begin(), frame.targets.begin() + count);
+    slot.numTracks = static_cast<uint32_t>(count);
+    slot.timestamp_us = frame.timestamp_us;
+    s.arrivalUs[s.next] = arrivalUs;
+    s.offset.update(static_cast<int64_t>(arrivalUs) - static_cast<int64_t>(frame.timestamp_us));
+    for (size_t i = 0; i < count; ++i) {
+        if (!idFits(frame.targets[i].target_id)) {
+            ++s.truncatedIds;
+        }
+    }
+    s.next = (s.next + 1) % FRAMES_PER_SOURCE;
+    s.count = std::min(s.count + 1, FRAMES_PER_SOURCE);
+}
+
+bool TrackMerger::merge(uint64_t nowUs, TargetTrackData& merged, bool aggregate)
+{
+    const uint64_t staleBefore = nowUs > m_staleUs ? nowUs - m_staleUs : 0;
+    const auto live = [staleBefore](const Source& s) {
+        return s.count > 0 && s.arrivalUs[s.newestSlot()] >= staleBefore;
+    };
+    int64_t viewTime = std::numeric_limits<int64_t>::max();
+    int64_t newestTime = std::numeric_limits<int64_t>::min();
+    bool anyLive = false;
+    for (const Source& s : m_sources) {
+        if (!live(s)) {
+            continue;
+        }
+        const int64_t newest = s.offset.localUs(s.newest().timestamp_us);
+        viewTime = std::min(viewTime, newest);
+        newestTime = std::max(newestTime, newest);
+        anyLive = true;
+    }
+    if (!anyLive) {
+        return false;
+    }
+    m_skewUs = static_cast<uint64_t>(newestTime - viewTime);
+
+    merged.targets.clear();
+    m_index.clear();
+    for (size_t index = 0; index < m_sources.size(); ++index) {
+        const Source& s = m_sources[index];
+        if (!live(s)) {
+            continue;
+        }
+        // Newest frame at or before the view time; the oldest kept frame
+        // if the ring only holds newer ones
+        size_t chosen = 0;
+        for (size_t age = 0; age < s.count; ++age) {
+            chosen = age;
+            if (s.offset.localUs(s.frame(age).timestamp_us) <= viewTime) {
+                break;
+            }
+        }
+        // Aggregating adds the older frames since the previous view time,
+        // oldest first so the latest state of each target wins
+        size_t oldest = chosen;
+        if (aggregate) {
+            while (oldest + 1 < s.count &&
+                   s.offset.localUs(s.frame(oldest + 1).timestamp_us) > m_lastViewTime) {
+                ++oldest;
+            }
+        }
+        for (size_t age = oldest + 1; age-- > chosen;) {
+            appendTracks(index, s.frame(age), merged);
+        }
+    }
+    merged.numTracks = static_cast<uint32_t>(merged.targets.size());
+    merged.timestamp_us = static_cast<uint64_t>(std::max<int64_t>(0, viewTime));
+    m_lastViewTime = viewTime;
+    return true;
+}
+
+void TrackMerger::appendTracks(size_t source, const TargetTrackData& frame, TargetTrackData& merged)
+{
+    for (uint32_t i = 0; i < frame.numTracks; ++i) {
+        TargetTrack track = frame.targets[i];
+        track.target_id = mergedId(source, track.target_id);
+        const auto inserted = m_index.emplace(track.target_id, merged.targets.size());
+        if (inserted.second) {
+            merged.targets.push_back(track);
+        } else {
+            merged.targets[inserted.first->second] = track;
+        }
+    }
+}
+
+uint64_t TrackMerger::truncatedIds(size_t source) const
+{
+    return source < m_sources.size() ? m_sources[source].truncatedIds : 0;
+}
+
+uint32_t TrackMerger::mergedId(size_t source, uint32_t targetId)
+{
+    const uint32_t idMask = (1u << SOURCE_ID_SHIFT) - 1;
+    return (static_cast<uint32_t>(source) << SOURCE_ID_SHIFT) | (targetId & idMask);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "DataStructures.h"
+#include "JitterBuffer.h"
+
+// Merges the track frames of several sources into one view at a common
+// time. Each source keeps its last few frames; the view time is the newest
+// frame time of the slowest live source, and every source contributes its
+// latest frame not newer than that, so a fast radar is shown at the same
+// instant as a slow one. Aggregating instead merges, per source, every kept
+// frame since the previous view time (latest state per target id), so
+// targets seen during the refresh interval stay on screen; a source with no
+// frame in that window keeps its last state. Frame times are compared in
+// local time, as the source timestamp plus that source's TransitOffset, so
+// a sender whose clock is skewed or counts from boot lines up with the
+// others; staleness is judged on arrival time alone.
+// Target ids are made unique across sources by placing the source index in
+// the top 8 bits. Ids of 2^24 and above do not fit: they keep only their
+// low 24 bits and may alias other targets of the same source, so they are
+// counted per source (truncatedIds). Source 0 keeps ids below 2^24.
+class TrackMerger
+{
+public:
+    static constexpr size_t FRAMES_PER_SOURCE = 8;
+    static constexpr unsigned SOURCE_ID_SHIFT = 24;
+    static constexpr uint64_t DEFAULT_STALE_US = 2000000;
+
+    explicit TrackMerger(uint64_t staleUs = DEFAULT_STALE_US);
+
+    // Discards all stored frames
+    void setSourceCount(size_t count);
+    size_t sourceCount() const { return m_sources.size(); }
+
+    // Frames must carry a timestamp (source or receive time); arrivalUs is
+    // local time (Instrumentation::wallClockUs())
+    void add(size_t source, const TargetTrackData& frame, uint64_t arrivalUs);
+
+    // Sources whose newest frame arrived before nowUs - staleUs are left
+    // out. False if no live source has data. The merged frame is stamped
+    // with the view time in local time. Aggregation covers at most the
+    // FRAMES_PER_SOURCE newest frames of a source.
+    bool merge(uint64_t nowUs, TargetTrackData& merged, bool aggregate = false);
+
+    // Newest-frame time spread across live sources at the last merge
+    uint64_t skewUs() const { return m_skewUs; }
+
+    // Targets added with an id too large for mergedId
+    uint64_t truncatedIds(size_t source) const;
+
+    static constexpr uint32_t MAX_TARGET_ID = (1u << SOURCE_ID_SHIFT) - 1;
+    static bool idFits(uint32_t targetId) { return targetId <= MAX_TARGET_ID; }
+    static uint32_t mergedId(size_t source, uint32_t targetId);
+
+private:
+    struct Source {
+        TargetTrackData frames[FRAMES_PER_SOURCE];  // ring, capacity reused
+        uint64_t arrivalUs[FRAMES_PER_SOURCE];
+        size_t next = 0;
+        size_t count = 0;
+        TransitOffset offset;
+        uint64_t truncatedIds = 0;
+
+        size_t newestSlot() const { return (next + FRAMES_PER_SOURCE - 1) % FRAMES_PER_SOURCE; }
+
+        const TargetTrackData& newest() const { return frames[newestSlot()]; }
+        const TargetTrackData& frame(size_t age) const
+        {
+            return frames[(next + FRAMES_PER_SOURCE - 1 - age) % FRAMES_PER_SOURCE];
+        }
+    };
+
+    void appendTracks(size_t source, const TargetTrackData& frame, TargetTrackData& merged);
+
+    std::vector<Source> m_sources;
+    uint64_t m_staleUs;
+    uint64_t m_skewUs;
+    int64_t m_lastViewTime;  // local time of the previous merge
+    std::unordered_map<uint32_t, size_t> m_index;  // merged id -> index in the aggregate
+};
@@ -0,0 +1,41 @@
+#include "TrackTableWidget.h"
+#include <QHeaderView>
+#include <QStringList>
+
+TrackTableWidget::TrackTableWidget(QWidget *parent)
+    : QTableWidget(parent)
+{
+    setColumnCount(4);
+    QStringList headers;
+    headers << "ID" << "Range (m)" << "Azimuth (°)"
+            << "Radial Speed (m/s)";
+    setHorizontalHeaderLabels(headers);
+    horizontalHeader()->setStretchLastSection(true);
+    setAlternatingRowColors(true);
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+}
+
+void TrackTableWidget::updateTracks(const TargetTrackData& trackData)
+{
+    if (rowCount() != static_cast<int>(trackData.numTracks)) {
+        setRowCount(trackData.numTracks);
+    }
+    for (uint32_t i = 0; i < trackData.numTracks; ++i) {
+        const TargetTrack& target = trackData.targets[i];
+        setCell(i, 0, QString::number(target.target_id));
+        setCell(i, 1, QString::number(target.radius, 'f', 0));
+        setCell(i, 2, QString::number(target.azimuth, 'f', 1));
+        setCell(i, 3, QString::number(target.radial_speed, 'f', 1));
+    }
+
+    resizeColumnsToContents();
+}
+
+void TrackTableWidget::setCell(int row, int column, const QString& text)
+{
+    if (QTableWidgetItem* cell = item(row, column)) {
+        cell->setText(text);
+    } else {
+        setItem(row, column, new QTableWidgetItem(text));
+    }
+}
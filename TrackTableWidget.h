@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QTableWidget>
+#include "DataStructures.h"
+
+// Target track table; items are created once per cell and reused, so a
+// refresh with an unchanged track count only rewrites cell text
+class TrackTableWidget : public QTableWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TrackTableWidget(QWidget *parent = nullptr);
+
+    void updateTracks(const TargetTrackData& trackData);
+
+private:
+    void setCell(int row, int column, const QString& text);
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.h"
+
+// Minimal benchmark harness: runs a callable in growing batches until the
+// measurement covers at least `minSeconds`, then reports the time per call.
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double bytesPerOp;   // 0 when throughput is not meaningful
+    double allocsPerOp;  // -1 when allocation counting is not compiled in
+};
+
+// Keeps a computed value alive so the optimizer cannot drop the work
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template <typename Fn>
+BenchResult runBenchmark(const std::string& name, Fn&& fn, double bytesPerOp = 0.0,
+                         double minSeconds = 0.3)
+{
+    using Clock = std::chrono::steady_clock;
+
+    fn();  // warm-up: caches, lazily sized buffers
+
+    // Allocations are counted in a separate steady-state pass so the
+    // counter does not perturb the timed loop
+    const uint64_t countedIterations = 8;
+    double allocsPerOp = -1.0;
+    if (AllocationCounter::enabled()) {
+        AllocationCounter::Scope allocations;
+        for (uint64_t i = 0; i < countedIterations; ++i) {
+            fn();
+        }
+        allocsPerOp = static_cast<double>(allocations.allocations()) / countedIterations;
+    }
+
+    uint64_t batch = 1;
+    uint64_t iterations = 0;
+    double elapsed = 0.0;
+    while (elapsed < minSeconds) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        elapsed += std::chrono::duration<double>(Clock::now() - start).count();
+        iterations += batch;
+        batch *= 2;
+    }
+
+    return BenchResult{name, iterations, elapsed * 1e9 / iterations, bytesPerOp, allocsPerOp};
+}
+
+inline void printResult(const BenchResult& result, std::FILE* out = stdout)
+{
+    std::fprintf(out, "%-48s %12.1f ns/op", result.name.c_str(), result.nsPerOp);
+    if (result.bytesPerOp > 0.0) {
+        std::fprintf(out, " %10.1f MB/s", result.bytesPerOp / result.nsPerOp * 1e3);
+    }
+    if (result.allocsPerOp >= 0.0) {
+        std::fprintf(out, " %8.1f allocs/op", result.allocsPerOp);
+    }
+    std::fprintf(out, "  (%llu iterations)\n", static_cast<unsigned long long>(result.iterations));
+}
+
+// Machine-readable summary for comparing runs across releases. Benchmark
+// names are plain identifiers, so no string escaping is needed.
+inline void writeJson(std::FILE* out, const std::vector<BenchResult>& results,
+                      const std::string& context)
+{
+    std::fprintf(out, "{\n  \"context\": {%s},\n  \"benchmarks\": [\n", context.c_str());
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f",
+                     r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.nsPerOp);
+        if (r.bytesPerOp > 0.0) {
+            std::fprintf(out, ", \"mb_per_s\": %.3f", r.bytesPerOp / r.nsPerOp * 1e3);
+        }
+        if (r.allocsPerOp >= 0.0) {
+            std::fprintf(out, ", \"allocs_per_op\": %.2f", r.allocsPerOp);
+        }
+        std::fprintf(out, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
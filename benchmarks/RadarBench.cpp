@@ -0,0 +1,576 @@
+// Hot-path benchmark suite: protocol decoding, FFT, PPI rendering, the
+// track table and the archive. Progress goes to stderr, the JSON summary to stdout (or the
+// file given with --json) for comparison between releases.
+//
+//   radar_bench [--filter SUBSTRING] [--min-time SECONDS] [--json FILE]
+#include <QApplication>
+#include <QByteArray>
+#include <QDir>
+#include <QImage>
+#include <QRegularExpression>
+#include <QResizeEvent>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchHarness.h"
+#include "ClutterFilter.h"
+#include "DataStructures.h"
+#include "FFTWidget.h"
+#include "FftKernels.h"
+#include "LabelPlacer.h"
+#include "PPIWidget.h"
+#include "RadarArchive.h"
+#include "RasterKernels.h"
+#include "TextProtocolParser.h"
+#include "TrackCodec.h"
+#include "TrackGridIndex.h"
+#include "ThreadPool.h"
+#include "TrackHistory.h"
+#include "TrackTableWidget.h"
+
+namespace {
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+const auto SkipEmpty = Qt::SkipEmptyParts;
+#else
+const auto SkipEmpty = QString::SkipEmptyParts;
+#endif
+
+// Previous MainWindow::parseTrackMessage, kept for comparison
+void legacyParseTrackMessage(const QString& message, TargetTrackData& out)
+{
+    QStringList tokens = message.split(QRegularExpression("\\s+"), SkipEmpty);
+    out.targets.clear();
+    out.numTracks = 0;
+
+    TargetTrack target;
+    int parsedTargets = 0;
+
+    for (int i = 0; i < tokens.size(); ++i) {
+        const QString& token = tokens[i];
+
+        if (token == "NumTargets:" && i + 1 < tokens.size()) {
+            tokens[++i].toInt();
+        } else if (token == "TgtId:" && i + 1 < tokens.size()) {
+            if (parsedTargets > 0) {
+                out.targets.push_back(target);
+                target = TargetTrack();
+            }
+            target.target_id = tokens[++i].toInt();
+            ++parsedTargets;
+        } else if (token == "Level:" && i + 1 < tokens.size()) {
+            target.level = tokens[++i].toFloat();
+        } else if (token == "Range:" && i + 1 < tokens.size()) {
+            target.radius = tokens[++i].toFloat();
+        } else if (token == "Azimuth:" && i + 1 < tokens.size()) {
+            target.azimuth = tokens[++i].toFloat();
+        } else if (token == "Elevation:" && i + 1 < tokens.size()) {
+            target.elevation = tokens[++i].toFloat();
+        } else if (token == "RadialSpeed:" && i + 1 < tokens.size()) {
+            target.radial_speed = tokens[++i].toFloat();
+        } else if (token == "AzimuthSpeed:" && i + 1 < tokens.size()) {
+            target.azimuth_speed = tokens[++i].toFloat();
+        } else if (token == "ElevationSpeed:" && i + 1 < tokens.size()) {
+            target.elevation_speed = tokens[++i].toFloat();
+        }
+    }
+
+    if (parsedTargets > 0) {
+        out.targets.push_back(target);
+    }
+    out.numTracks = out.targets.size();
+}
+
+// Previous MainWindow::parseADCMessage, kept for comparison
+void legacyParseADCMessage(const QString& message, RawADCFrameTest& out)
+{
+    QStringList tokens = message.split(QRegularExpression("\\s+"), SkipEmpty);
+    RawADCFrameTest frame;
+
+    for (int i = 0; i < tokens.size(); ++i) {
+        const QString& token = tokens[i];
+
+        if (token == "MsgId:" && i + 1 < tokens.size()) {
+            frame.msgId = tokens[++i].toUInt();
+        } else if (token == "NumSamples:" && i + 1 < tokens.size()) {
+            frame.num_samples_per_chirp = tokens[++i].toUInt();
+        } else if (token == "ADC:" && i + 1 < tokens.size()) {
+            frame.sample_data.push_back(tokens[++i].toFloat());
+        }
+    }
+    out = frame;
+}
+
+QByteArray makeTrackMessage(int numTargets)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> value(-90.0f, 500.0f);
+    QByteArray message = "NumTargets: " + QByteArray::number(numTargets);
+    for (int i = 0; i < numTargets; ++i) {
+        message += " TgtId: " + QByteArray::number(i + 1);
+        message += " Level: " + QByteArray::number(value(rng), 'f', 2);
+        message += " Range: " + QByteArray::number(value(rng), 'f', 2);
+        message += " Azimuth: " + QByteArray::number(value(rng) / 6.0f, 'f', 2);
+        message += " Elevation: " + QByteArray::number(value(rng) / 20.0f, 'f', 2);
+        message += " RadialSpeed: " + QByteArray::number(value(rng) / 10.0f, 'f', 2);
+        message += " AzimuthSpeed: " + QByteArray::number(value(rng) / 100.0f, 'f', 2);
+        message += " ElevationSpeed: " + QByteArray::number(value(rng) / 200.0f, 'f', 2);
+    }
+    return message;
+}
+
+QByteArray makeADCMessage(int numSamples)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    QByteArray message = "MsgId: 1 NumSamples: " + QByteArray::number(numSamples);
+    for (int i = 0; i < numSamples; ++i) {
+        message += " ADC: " + QByteArray::number(value(rng), 'f', 5);
+    }
+    return message;
+}
+
+TargetTrackData makeTrackData(int numTargets, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> range(10.0f, 500.0f);
+    std::uniform_real_distribution<float> azimuth(-90.0f, 90.0f);
+    std::uniform_real_distribution<float> speed(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> level(10.0f, 100.0f);
+
+    TargetTrackData data;
+    data.resize(numTargets);
+    for (int i = 0; i < numTargets; ++i) {
+        TargetTrack& target = data.targets[i];
+        target = TargetTrack();
+        target.target_id = i + 1;
+        target.level = level(rng);
+        target.radius = range(rng);
+        target.azimuth = azimuth(rng);
+        target.radial_speed = speed(rng);
+    }
+    return data;
+}
+
+RawADCFrameTest makeFloatFrame(size_t numSamples)
+{
+    RawADCFrameTest frame;
+    frame.msgId = 1;
+    frame.num_samples_per_chirp = static_cast<uint32_t>(numSamples);
+    frame.sample_data.resize(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        frame.sample_data[i] = 0.8f * std::sin(0.05f * i) + 0.3f * std::sin(0.31f * i);
+    }
+    return frame;
+}
+
+RawADCFrame makeInt16Frame(uint8_t numRx, uint32_t numChirps, uint32_t numSamples)
+{
+    RawADCFrame frame;
+    frame.num_chirps = numChirps;
+    frame.num_rx_antennas = numRx;
+    frame.num_samples_per_chirp = numSamples;
+    frame.rx_mask = static_cast<uint8_t>((1u << numRx) - 1);
+    frame.data_format = Rx_Data_Format_t::REAL_INT16;
+    frame.sample_data_i16.resize(size_t(numRx) * numChirps * numSamples);
+    for (size_t i = 0; i < frame.sample_data_i16.size(); ++i) {
+        frame.sample_data_i16[i] = static_cast<int16_t>(12000.0f * std::sin(0.07f * i));
+    }
+    return frame;
+}
+
+// Widgets are never shown, so deliver the resize event render() relies on
+void resizeWidget(QWidget& widget, int width, int height)
+{
+    QSize oldSize = widget.size();
+    widget.resize(width, height);
+    QResizeEvent event(QSize(width, height), oldSize);
+    QCoreApplication::sendEvent(&widget, &event);
+}
+
+class BenchSuite
+{
+public:
+    BenchSuite(const std::string& filter, double minSeconds)
+        : m_filter(filter), m_minSeconds(minSeconds) {}
+
+    template <typename Fn>
+    void run(const std::string& name, Fn&& fn, double bytesPerOp = 0.0)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos) {
+            return;
+        }
+        m_results.push_back(runBenchmark(name, fn, bytesPerOp, m_minSeconds));
+        printResult(m_results.back(), stderr);
+    }
+
+    const std::vector<BenchResult>& results() const { return m_results; }
+
+private:
+    std::string m_filter;
+    double m_minSeconds;
+    std::vector<BenchResult> m_results;
+};
+
+void benchParsers(BenchSuite& suite)
+{
+    const QByteArray trackMessage = makeTrackMessage(1000);
+    const QByteArray adcMessage = makeADCMessage(64 * 1024);
+
+    TargetTrackData tracks;
+    RawADCFrameTest adc;
+
+    suite.run("parse/legacy/track_1k_targets", [&] {
+        legacyParseTrackMessage(QString::fromUtf8(trackMessage), tracks);
+        doNotOptimize(tracks);
+    }, trackMessage.size());
+    suite.run("parse/bytes/track_1k_targets", [&] {
+        parseTextMessage(trackMessage.constData(), trackMessage.size(), tracks, adc);
+        doNotOptimize(tracks);
+    }, trackMessage.size());
+
+    suite.run("parse/legacy/adc_64k_samples", [&] {
+        legacyParseADCMessage(QString::fromUtf8(adcMessage), adc);
+        doNotOptimize(adc);
+    }, adcMessage.size());
+    suite.run("parse/bytes/adc_64k_samples", [&] {
+        parseTextMessage(adcMessage.constData(), adcMessage.size(), tracks, adc);
+        doNotOptimize(adc);
+    }, adcMessage.size());
+    
+    // Compact track stream: 1k targets moving a little between 16 frames,
+    // the first a keyframe
+    TargetTrackData moving = makeTrackData(1000, 29);
+    std::vector<std::vector<char>> compactFrames(16);
+    TrackEncoder encoder;
+    size_t compactBytes = 0;
+    for (std::vector<char>& frame : compactFrames) {
+        for (TargetTrack& target : moving.targets) {
+            target.radius += 0.05f * target.radial_speed;
+        }
+        encoder.encode(moving, frame);
+        compactBytes += frame.size();
+    }
+    std::vector<char> encoded;
+    suite.run("parse/compact/encode_1k_targets", [&] {
+        encoder.encode(moving, encoded);
+        doNotOptimize(encoded);
+    });
+    TrackDecoder decoder;
+    suite.run("parse/compact/decode_16x1k_targets", [&] {
+        decoder.reset();
+        for (const std::vector<char>& frame : compactFrames) {
+            decoder.decode(frame.data(), frame.size(), tracks);
+        }
+        doNotOptimize(tracks);
+    }, compactBytes);
+}
+
+void benchFFT(BenchSuite& suite)
+{
+    FFTWidget widget;
+    resizeWidget(widget, 800, 400);
+
+    for (size_t n : {256, 1024, 4096, 16384}) {
+        const RawADCFrameTest frame = makeFloatFrame(n);
+        suite.run("fft/float/" + std::to_string(n), [&] {
+            widget.updateData(frame);
+        }, n * sizeof(float));
+    }
+
+    // Specialised kernels against the generic loop, on identical input
+    size_t fixedCount = 0;
+    const size_t* fixedSizes = fixedFFTSizes(fixedCount);
+    for (size_t s = 0; s < fixedCount; ++s) {
+        const size_t n = fixedSizes[s];
+        std::vector<std::complex<float>> input(n), buffer(n);
+        for (size_t i = 0; i < n; ++i) {
+            input[i] = std::complex<float>(std::sin(0.1f * i), std::cos(0.37f * i));
+        }
+        suite.run("fft/kernel/runtime/" + std::to_string(n), [&] {
+            std::copy(input.begin(), input.end(), buffer.begin());
+            SpectrumProcessor::fftRuntime(buffer.data(), n);
+            doNotOptimize(buffer);
+        }, n * sizeof(std::complex<float>));
+        suite.run("fft/kernel/fixed/" + std::to_string(n), [&] {
+            std::copy(input.begin(), input.end(), buffer.begin());
+            SpectrumProcessor::fft(buffer.data(), n);
+            doNotOptimize(buffer);
+        }, n * sizeof(std::complex<float>));
+    }
+
+    const RawADCFrame multiChannel = makeInt16Frame(4, 32, 256);
+    widget.setChannelDisplay(FFTWidget::ChannelDisplay::Single);
+    suite.run("fft/int16_4rx_32chirps_256/single", [&] {
+        widget.updateData(multiChannel);
+    });
+    widget.setChannelDisplay(FFTWidget::ChannelDisplay::Coherence);
+    suite.run("fft/int16_4rx_32chirps_256/coherence", [&] {
+        widget.updateData(multiChannel);
+    }, multiChannel.sample_data_i16.size() * sizeof(int16_t));
+
+    // Clutter suppression: the kernels alone, then the same multi-channel
+    // frame with MTI and the clutter map on
+    std::vector<std::complex<float>> chirps(32 * 256);
+    for (size_t i = 0; i < chirps.size(); ++i) {
+        chirps[i] = std::complex<float>(std::sin(0.05f * i), std::cos(0.03f * i));
+    }
+    suite.run("clutter/mti3/32chirps_256", [&] {
+        clutter::cancelChirps(chirps.data(), 32, 256, clutter::MtiMode::ThreePulse);
+        doNotOptimize(chirps);
+    }, chirps.size() * sizeof(std::complex<float>));
+    std::vector<float> power(1024, 1.0f);
+    ClutterMap clutterMap;
+    suite.run("clutter/map/1024_bins", [&] {
+        clutterMap.apply(power.data(), power.size());
+        doNotOptimize(power);
+    }, power.size() * sizeof(float));
+    widget.setMtiMode(SpectrumProcessor::MtiMode::ThreePulse);
+    widget.setClutterMapEnabled(true);
+    suite.run("fft/int16_4rx_32chirps_256/coherence_mti3_clutter_map", [&] {
+        widget.updateData(multiChannel);
+    }, multiChannel.sample_data_i16.size() * sizeof(int16_t));
+    widget.setMtiMode(SpectrumProcessor::MtiMode::Off);
+    widget.setClutterMapEnabled(false);
+}
+
+void benchPPI(BenchSuite& suite)
+{
+    PPIWidget widget;
+    resizeWidget(widget, 800, 450);
+    QImage image(widget.size(), QImage::Format_ARGB32_Premultiplied);
+
+    for (int count : {0, 10, 100, 1000, 5000, 10000}) {
+        const TargetTrackData tracks = makeTrackData(count, 11);
+        suite.run("ppi/render/" + std::to_string(count) + "_targets", [&] {
+            widget.updateTargets(tracks);
+            widget.render(&image);
+            doNotOptimize(image);
+        });
+    }
+    
+    // 50k tracks: the grid index on its own, then paints of the full view
+    // and zoomed in towards the upper right, with the tracks loaded once
+    {
+        const TargetTrackData tracks = makeTrackData(50000, 13);
+        TrackGridIndex index;
+        suite.run("ppi/index/build_50000", [&] {
+            index.build(tracks.targets, 500.0f, -90.0f, 90.0f);
+            doNotOptimize(index);
+        });
+        std::vector<uint32_t> visible;
+        suite.run("ppi/index/query_50000_1_percent", [&] {
+            index.query(100.0f, 200.0f, 150.0f, 250.0f, visible);
+            doNotOptimize(visible);
+        });
+        widget.updateTargets(tracks);
+        for (int zoom : {1, 8, 64}) {
+            widget.resetView();
+            widget.setZoom(static_cast<float>(zoom), QPointF(500.0, 200.0));
+            suite.run("ppi/render/50000_targets_zoom" + std::to_string(zoom), [&] {
+                widget.render(&image);
+                doNotOptimize(image);
+            });
+        }
+        widget.resetView();
+    }
+    
+    // Placement pass alone: 10k ID labels scattered over a 1200x700 view
+    {
+        std::mt19937 rng(23);
+        std::uniform_real_distribution<float> x(0.0f, 1200.0f);
+        std::uniform_real_distribution<float> y(0.0f, 700.0f);
+        std::uniform_real_distribution<float> priority(0.0f, 100.0f);
+        std::vector<LabelPlacer::Label> labels(10000);
+        for (LabelPlacer::Label& label : labels) {
+            label = LabelPlacer::Label{x(rng), y(rng), 24.0f, 12.0f, priority(rng)};
+        }
+        LabelPlacer placer;
+        placer.setViewport(1200, 700);
+        std::vector<LabelPlacer::Placement> placements;
+        suite.run("ppi/labels/place_10000", [&] {
+            placer.place(labels, placements);
+            doNotOptimize(placements);
+        });
+    }
+
+    // Full trails: every target has TrackHistory::DEFAULT_TRAIL_LENGTH points
+    widget.setShowTrails(true);
+    for (int count : {100, 1000}) {
+        TargetTrackData tracks = makeTrackData(count, 13);
+        for (size_t i = 0; i < TrackHistory::DEFAULT_TRAIL_LENGTH; ++i) {
+            for (TargetTrack& target : tracks.targets) {
+                target.radius += 2.0f;
+                target.azimuth = std::min(target.azimuth + 0.5f, 90.0f);
+            }
+            widget.updateTargets(tracks);
+        }
+        suite.run("ppi/render_trails/" + std::to_string(count) + "_targets", [&] {
+            widget.render(&image);
+            doNotOptimize(image);
+        });
+    }
+
+    widget.setShowTrails(false);
+    widget.setPersistence(true);
+    for (int count : {100, 1000}) {
+        const TargetTrackData tracks = makeTrackData(count, 19);
+        suite.run("ppi/persistence/" + std::to_string(count) + "_targets", [&] {
+            widget.updateTargets(tracks);
+            widget.render(&image);
+            doNotOptimize(image);
+        });
+    }
+    widget.setPersistence(false);
+
+    // Heatmap: range-azimuth processing plus the LUT gather, and the LUT
+    // rebuild that only happens on resize
+    widget.setShowHeatmap(true);
+    const RawADCFrame rawFrame = makeInt16Frame(4, 32, 256);
+    widget.updateRawFrame(rawFrame);
+    suite.run("ppi/heatmap/update_4rx_32chirps_256", [&] {
+        widget.updateRawFrame(rawFrame);
+    });
+    suite.run("ppi/heatmap/render", [&] {
+        widget.render(&image);
+        doNotOptimize(image);
+    });
+    suite.run("ppi/heatmap/lut_rebuild", [&] {
+        resizeWidget(widget, 800, 450);
+    });
+    widget.setShowHeatmap(false);
+
+    std::vector<uint32_t> pixels(800 * 450, 0xFF808080u);
+    suite.run("ppi/decay/800x450", [&] {
+        decayPixels(pixels.data(), pixels.size(), 240);
+        doNotOptimize(pixels);
+    }, pixels.size() * sizeof(uint32_t));
+
+    TrackHistory history;
+    const TargetTrackData manyTracks = makeTrackData(10000, 17);
+    suite.run("ppi/history_update/10000_tracks", [&] {
+        history.update(manyTracks);
+        doNotOptimize(history);
+    });
+}
+
+void benchTrackTable(BenchSuite& suite)
+{
+    for (int count : {10, 100, 1000}) {
+        TrackTableWidget table;
+        // Alternate between two track sets so every refresh changes cell text
+        const TargetTrackData tracks[2] = {makeTrackData(count, 3), makeTrackData(count, 5)};
+        int next = 0;
+        suite.run("table/update/" + std::to_string(count) + "_tracks", [&] {
+            table.updateTracks(tracks[next]);
+            next ^= 1;
+        });
+    }
+}
+
+void benchArchive(BenchSuite& suite)
+{
+    const std::string basePath = (QDir::tempPath() + "/radar_bench_archive").toStdString();
+    ArchiveWriter writer;
+    if (!writer.open(basePath)) {
+        std::fprintf(stderr, "cannot create %s, skipping archive benchmarks\n", basePath.c_str());
+        return;
+    }
+    TargetTrackData tracks = makeTrackData(100, 23);
+    const std::vector<float> spectrum(512, -10.0f);
+    uint64_t timestamp = 1000000;
+    suite.run("archive/write/100_tracks", [&] {
+        tracks.timestamp_us = timestamp += 100000;
+        writer.writeTracks(0, tracks, timestamp);
+    }, tracks.numTracks * sizeof(TargetTrack));
+    suite.run("archive/write/spectrum_512", [&] {
+        timestamp += 100000;
+        writer.writeSpectrum(0, timestamp, timestamp, 0, spectrum, false);
+    }, spectrum.size() * sizeof(float));
+
+    ArchiveReader reader;
+    if (!reader.open(basePath)) {
+        writer.close();
+        return;
+    }
+    // Random seeks across everything written so far, as when scrubbing
+    std::mt19937_64 rng(29);
+    std::uniform_int_distribution<uint64_t> when(reader.firstTimestamp(), reader.lastTimestamp());
+    TargetTrackData found;
+    suite.run("archive/tracks_at/random", [&] {
+        reader.tracksAt(when(rng), 1000000, found);
+        doNotOptimize(found);
+    });
+    ArchiveStream::Frame frame;
+    suite.run("archive/spectrum_at/random", [&] {
+        reader.spectrumAt(when(rng), frame);
+        doNotOptimize(frame);
+    });
+    reader.close();
+    writer.close();
+    std::remove((basePath + ".tracks").c_str());
+    std::remove((basePath + ".spectra").c_str());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string filter;
+    std::string jsonPath;
+    double minSeconds = 0.3;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter SUBSTRING] [--min-time SECONDS] [--json FILE]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    // Widgets are rendered into images only; no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    BenchSuite suite(filter, minSeconds);
+    benchParsers(suite);
+    benchFFT(suite);
+    benchPPI(suite);
+    benchTrackTable(suite);
+    benchArchive(suite);
+
+    std::string context = std::string("\"qt_version\": \"") + qVersion() + "\"" +
+                          ", \"threads\": " + std::to_string(ThreadPool::instance().concurrency()) +
+                          ", \"allocation_counting\": " +
+                          (AllocationCounter::enabled() ? "true" : "false");
+
+    std::FILE* out = stdout;
+    if (!jsonPath.empty()) {
+        out = std::fopen(jsonPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    writeJson(out, suite.results(), context);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
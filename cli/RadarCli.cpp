@@ -0,0 +1,896 @@
+// Headless processing pipeline: decodes recorded datagrams, computes range
+// spectra and CFAR detections as fast as the machine allows, and reports
+// throughput and per-stage latency. Uses radar_core only (no Qt).
+//
+//   radar_cli [options] RECORDING
+//   radar_cli [options] --simulate FRAMES [--record FILE]
+//   radar_cli --subscribe NAME [--count N]
+//   radar_cli --check-allocations
+//   radar_cli --check-track-codec
+//
+// Recordings are either length-prefixed (a little-endian uint32 byte count
+// before each datagram) or line-based (one text-protocol datagram per line).
+// --compact-tracks simulates track frames as TRACK_DELTA_DATA datagrams
+// and checks that each one decodes back to the simulated tracks.
+// --publish writes decoded tracks and spectra to a shared-memory ring that
+// --subscribe (or any SharedFrameSubscriber) reads from another process.
+// --check-allocations decodes simulated binary ADC, text and compact track
+// datagrams the way the receivers do, runs the ADC frames through the range
+// FFT, clutter filters and CFAR, and fails if the steady state allocates.
+// --check-track-codec sends simulated track frames through the compact
+// codec over a lossy, reordering channel and checks that deltas after a gap
+// are refused, duplicate and late ones leave the decoder in sync, and
+// decoding is exact again from the next keyframe. Both are registered as
+// ctest tests.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "BinaryProtocol.h"
+#include "BufferPool.h"
+#include "CfarDetector.h"
+#include "DataStructures.h"
+#include "Instrumentation.h"
+#include "SharedFrameRing.h"
+#include "Simulator.h"
+#include "SpectrumProcessor.h"
+#include "TextProtocolParser.h"
+#include "TrackCodec.h"
+
+namespace {
+
+enum class RecordingFormat {
+    Auto,
+    LengthPrefixed,
+    Lines
+};
+
+struct Options {
+    std::string input;
+    RecordingFormat format = RecordingFormat::Auto;
+    uint64_t simulateFrames = 0;
+    std::string recordPath;
+    bool compactTracks = false;
+    unsigned repeat = 1;
+    bool channels = false;
+    bool printDetections = false;
+    std::string statsPath;
+    std::string publishName;
+    std::string subscribeName;
+    uint64_t subscribeCount = 0;  // 0: until the publisher closes
+    bool checkAllocations = false;
+    bool checkTrackCodec = false;
+    SpectrumProcessor::WindowFunction window = SpectrumProcessor::WindowFunction::Hann;
+    SpectrumProcessor::MtiMode mti = SpectrumProcessor::MtiMode::Off;
+    float clutterMapAlpha = 0.0f;  // 0: clutter map off
+    CfarDetector::Config cfar;
+};
+
+// Datagrams of a recording, stored back to back
+struct Recording {
+    std::vector<char> data;
+    std::vector<size_t> offsets;  // start of each datagram; one extra entry marks the end
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    const char* datagram(size_t i) const { return data.data() + offsets[i]; }
+    size_t datagramSize(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    void append(const char* bytes, size_t size)
+    {
+        if (offsets.empty()) {
+            offsets.push_back(0);
+        }
+        data.insert(data.end(), bytes, bytes + size);
+        offsets.push_back(data.size());
+    }
+};
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] RECORDING\n"
+        "       %s [options] --simulate FRAMES [--compact-tracks] [--record FILE]\n"
+        "       %s --subscribe NAME [--count N]\n"
+        "       %s --check-allocations | --check-track-codec\n"
+        "\n"
+        "  --format auto|lp|lines   recording framing (default: auto)\n"
+        "  --repeat N               process the input N times\n"
+        "  --channels               per-channel spectra averaged over chirps\n"
+        "  --window hann|rect       FFT window (default: hann)\n"
+        "  --mti 2|3                two- or three-pulse MTI canceller across chirps\n"
+        "  --clutter-map ALPHA      subtract a recursive per-bin background (e.g. 0.05)\n"
+        "  --cfar-guard N           guard cells per side (default: 2)\n"
+        "  --cfar-train N           training cells per side (default: 8)\n"
+        "  --cfar-threshold DB      detection threshold (default: 12)\n"
+        "  --detections             print every detection\n"
+        "  --stats FILE             write per-stage latency as CSV\n"
+        "  --record FILE            save simulated datagrams as a length-prefixed recording\n"
+        "  --compact-tracks         simulate tracks as delta-coded binary datagrams\n"
+        "  --publish NAME           publish decoded tracks and spectra to shared memory\n"
+        "  --subscribe NAME         read a shared-memory ring and report rate, loss and latency\n"
+        "  --count N                with --subscribe: stop after N frames\n"
+        "  --check-allocations      fail if steady-state datagram decoding allocates\n"
+        "  --check-track-codec      compact track round trip over a lossy, reordering channel\n",
+        program, program, program, program);
+}
+
+bool parseOptions(int argc, char *argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--format") == 0 && hasValue) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "auto") == 0) {
+                options.format = RecordingFormat::Auto;
+            } else if (std::strcmp(value, "lp") == 0) {
+                options.format = RecordingFormat::LengthPrefixed;
+            } else if (std::strcmp(value, "lines") == 0) {
+                options.format = RecordingFormat::Lines;
+            } else {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--simulate") == 0 && hasValue) {
+            options.simulateFrames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(arg, "--compact-tracks") == 0) {
+            options.compactTracks = true;
+        } else if (std::strcmp(arg, "--repeat") == 0 && hasValue) {
+            options.repeat = static_cast<unsigned>(std::max(1L, std::strtol(argv[++i], nullptr, 10)));
+        } else if (std::strcmp(arg, "--channels") == 0) {
+            options.channels = true;
+        } else if (std::strcmp(arg, "--window") == 0 && hasValue) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "hann") == 0) {
+                options.window = SpectrumProcessor::WindowFunction::Hann;
+            } else if (std::strcmp(value, "rect") == 0) {
+                options.window = SpectrumProcessor::WindowFunction::Rectangular;
+            } else {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--mti") == 0 && hasValue) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "2") == 0) {
+                options.mti = SpectrumProcessor::MtiMode::TwoPulse;
+            } else if (std::strcmp(value, "3") == 0) {
+                options.mti = SpectrumProcessor::MtiMode::ThreePulse;
+            } else {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--clutter-map") == 0 && hasValue) {
+            options.clutterMapAlpha = std::strtof(argv[++i], nullptr);
+            if (!(options.clutterMapAlpha > 0.0f && options.clutterMapAlpha <= 1.0f)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--cfar-guard") == 0 && hasValue) {
+            options.cfar.guardCells = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--cfar-train") == 0 && hasValue) {
+            options.cfar.trainingCells = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--cfar-threshold") == 0 && hasValue) {
+            options.cfar.thresholdDb = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--detections") == 0) {
+            options.printDetections = true;
+        } else if (std::strcmp(arg, "--stats") == 0 && hasValue) {
+            options.statsPath = argv[++i];
+        } else if (std::strcmp(arg, "--publish") == 0 && hasValue) {
+            options.publishName = argv[++i];
+        } else if (std::strcmp(arg, "--subscribe") == 0 && hasValue) {
+            options.subscribeName = argv[++i];
+        } else if (std::strcmp(arg, "--count") == 0 && hasValue) {
+            options.subscribeCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--check-allocations") == 0) {
+            options.checkAllocations = true;
+        } else if (std::strcmp(arg, "--check-track-codec") == 0) {
+            options.checkTrackCodec = true;
+        } else if (arg[0] != '-' && options.input.empty()) {
+            options.input = arg;
+        } else {
+            return false;
+        }
+    }
+    if (options.checkAllocations || options.checkTrackCodec) {
+        return !(options.checkAllocations && options.checkTrackCodec) && options.input.empty() &&
+               options.simulateFrames == 0 && options.subscribeName.empty();
+    }
+    if (!options.subscribeName.empty()) {
+        return options.input.empty() && options.simulateFrames == 0;
+    }
+    return options.simulateFrames > 0 ? options.input.empty() : !options.input.empty();
+}
+
+bool loadRecording(const std::string& path, RecordingFormat format, Recording& recording)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+
+    // Text datagrams start with a keyword; a length prefix has zero bytes
+    if (format == RecordingFormat::Auto) {
+        format = RecordingFormat::Lines;
+        for (size_t i = 0; i < 4 && i < bytes.size(); ++i) {
+            if (bytes[i] < 0x20 || bytes[i] > 0x7e) {
+                format = RecordingFormat::LengthPrefixed;
+                break;
+            }
+        }
+    }
+
+    recording.data.reserve(bytes.size());
+    size_t pos = 0;
+    if (format == RecordingFormat::LengthPrefixed) {
+        while (pos + sizeof(uint32_t) <= bytes.size()) {
+            uint32_t length;
+            std::memcpy(&length, bytes.data() + pos, sizeof(length));
+            pos += sizeof(length);
+            if (length > bytes.size() - pos) {
+                std::fprintf(stderr, "%s: truncated datagram at offset %zu\n", path.c_str(),
+                             pos - sizeof(length));
+                break;
+            }
+            recording.append(bytes.data() + pos, length);
+            pos += length;
+        }
+    } else {
+        while (pos < bytes.size()) {
+            const char* begin = bytes.data() + pos;
+            const void* newline = std::memchr(begin, '\n', bytes.size() - pos);
+            size_t length = newline ? static_cast<const char*>(newline) - begin : bytes.size() - pos;
+            pos += length + 1;
+            if (length > 0 && begin[length - 1] == '\r') {
+                --length;
+            }
+            if (length > 0) {
+                recording.append(begin, length);
+            }
+        }
+    }
+    return true;
+}
+
+// Writes `count` datagrams, cycling through the recording
+bool writeRecording(const std::string& path, const Recording& recording, uint64_t count)
+{
+    std::ofstream file(path, std::ios::binary);
+    for (uint64_t i = 0; i < count; ++i) {
+        const size_t index = i % recording.size();
+        const uint32_t length = static_cast<uint32_t>(recording.datagramSize(index));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(recording.datagram(index), length);
+    }
+    return static_cast<bool>(file);
+}
+
+std::string formatTrackMessage(const TargetTrackData& tracks)
+{
+    std::string message = "NumTargets: " + std::to_string(tracks.numTracks);
+    char field[256];
+    for (uint32_t i = 0; i < tracks.numTracks; ++i) {
+        const TargetTrack& t = tracks.targets[i];
+        std::snprintf(field, sizeof(field),
+                      " TgtId: %u Level: %.2f Range: %.2f Azimuth: %.2f Elevation: %.2f"
+                      " RadialSpeed: %.2f AzimuthSpeed: %.2f ElevationSpeed: %.2f",
+                      t.target_id, t.level, t.radius, t.azimuth, t.elevation,
+                      t.radial_speed, t.azimuth_speed, t.elevation_speed);
+        message += field;
+    }
+    return message;
+}
+
+std::string formatADCMessage(const RawADCFrameTest& frame)
+{
+    std::string message = "MsgId: " + std::to_string(frame.msgId) +
+                          " NumSamples: " + std::to_string(frame.sample_data.size());
+    char field[32];
+    for (float sample : frame.sample_data) {
+        std::snprintf(field, sizeof(field), " ADC: %.4f", sample);
+        message += field;
+    }
+    return message;
+}
+
+// Decoded tracks equal the originals up to the quantisation step
+bool matchesQuantized(const TargetTrackData& original, const TargetTrackData& decoded)
+{
+    if (decoded.numTracks != original.numTracks || decoded.timestamp_us != original.timestamp_us) {
+        return false;
+    }
+    for (uint32_t i = 0; i < original.numTracks; ++i) {
+        const TargetTrack& a = original.targets[i];
+        const TargetTrack& b = decoded.targets[i];
+        const float fa[] = {a.level, a.radius, a.azimuth, a.elevation,
+                            a.radial_speed, a.azimuth_speed, a.elevation_speed};
+        const float fb[] = {b.level, b.radius, b.azimuth, b.elevation,
+                            b.radial_speed, b.azimuth_speed, b.elevation_speed};
+        if (a.target_id != b.target_id) {
+            return false;
+        }
+        for (size_t f = 0; f < trackcodec::FIELDS; ++f) {
+            const float tolerance = 0.5f * trackcodec::STEPS[f] + 1e-6f * std::fabs(fa[f]);
+            if (!(std::fabs(fa[f] - fb[f]) <= tolerance)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Largest field error of a decoded frame with the same ids in the same order
+float maxFieldError(const TargetTrackData& original, const TargetTrackData& decoded)
+{
+    float error = 0.0f;
+    for (uint32_t i = 0; i < original.numTracks && i < decoded.numTracks; ++i) {
+        const TargetTrack& a = original.targets[i];
+        const TargetTrack& b = decoded.targets[i];
+        for (float d : {a.level - b.level, a.radius - b.radius, a.azimuth - b.azimuth,
+                        a.elevation - b.elevation, a.radial_speed - b.radial_speed,
+                        a.azimuth_speed - b.azimuth_speed, a.elevation_speed - b.elevation_speed}) {
+            error = std::max(error, std::fabs(d));
+        }
+    }
+    return error;
+}
+
+// Alternating track and binary ADC datagrams for up to 32 distinct frames;
+// longer runs cycle through them so memory stays flat. With compactTracks
+// the track frames are TRACK_DELTA_DATA datagrams, each round-tripped
+// through a decoder; false if any came back different.
+bool simulateRecording(uint64_t frames, bool compactTracks, Recording& recording)
+{
+    Simulator simulator(1234);
+    TargetTrackData tracks;
+    TargetTrackData decoded;
+    RawADCFrame frame;
+    std::vector<char> datagram;
+    TrackEncoder encoder;
+    TrackDecoder decoder;
+    uint64_t compactBytes = 0;
+    uint64_t textBytes = 0;
+    uint64_t mismatches = 0;
+
+    const uint64_t distinct = std::min<uint64_t>(frames, 32);
+    for (uint64_t i = 0; i < distinct; ++i) {
+        simulator.generateTargets(tracks);
+        tracks.timestamp_us = Instrumentation::wallClockUs();
+        const std::string text = formatTrackMessage(tracks);
+        if (compactTracks) {
+            encoder.encode(tracks, datagram);
+            recording.append(datagram.data(), datagram.size());
+            compactBytes += datagram.size();
+            textBytes += text.size();
+            if (decoder.decode(datagram.data(), datagram.size(), decoded) != TrackDecoder::Result::Decoded ||
+                !matchesQuantized(tracks, decoded)) {
+                ++mismatches;
+            }
+        } else {
+            recording.append(text.data(), text.size());
+        }
+
+        simulator.generateRawFrame(frame, tracks);
+        frame.timestamp_us = Instrumentation::wallClockUs();
+        encodeBinaryADCMessage(frame, datagram);
+        recording.append(datagram.data(), datagram.size());
+    }
+
+    if (compactTracks) {
+        std::printf("compact tracks %llu frames, %.1f bytes/frame vs %.1f as text (%.1fx), round trip %s\n\n",
+                    static_cast<unsigned long long>(distinct), double(compactBytes) / distinct,
+                    double(textBytes) / distinct, double(textBytes) / std::max<uint64_t>(1, compactBytes),
+                    mismatches == 0 ? "ok" : "FAILED");
+    }
+    return mismatches == 0;
+}
+
+class Pipeline
+{
+public:
+    explicit Pipeline(const Options& options)
+        : m_options(options)
+        , m_cfar(options.cfar)
+    {
+        m_spectrum.setWindowFunction(options.window);
+        m_spectrum.setMtiMode(options.mti);
+        if (options.clutterMapAlpha > 0.0f) {
+            m_spectrum.setClutterMapAlpha(options.clutterMapAlpha);
+            m_spectrum.setClutterMapEnabled(true);
+        }
+        if (!options.publishName.empty() && !m_publisher.open(options.publishName)) {
+            std::fprintf(stderr, "cannot create shared memory ring %s\n", options.publishName.c_str());
+        }
+    }
+
+    void process(const char* data, size_t size)
+    {
+        Instrumentation::instance().countDatagram(size);
+        ++m_datagrams;
+        m_bytes += size;
+
+        bool haveRawFrame = false;
+        TextMessageResult text = {false, false};
+        {
+            ScopedStageTimer timer(Stage::Parse);
+            haveRawFrame = parseBinaryADCMessage(data, size, m_rawFrame);
+            if (!haveRawFrame) {
+                const TrackDecoder::Result compact = m_trackDecoder.decode(data, size, m_tracks);
+                if (compact == TrackDecoder::Result::Decoded) {
+                    text.hasTracks = true;
+                } else if (compact == TrackDecoder::Result::NotTrackMessage) {
+                    text = parseTextMessage(data, size, m_tracks, m_textFrame);
+                }
+            }
+        }
+
+        if (text.hasTracks) {
+            ++m_trackMessages;
+            m_trackCount += m_tracks.numTracks;
+            Instrumentation::instance().countFrame();
+            m_publisher.publishTracks(0, m_tracks);
+        }
+        if (!haveRawFrame && !text.hasTracks && !text.hasADC) {
+            ++m_undecoded;
+            return;
+        }
+        if (!haveRawFrame && !text.hasADC) {
+            return;
+        }
+
+        uint32_t frameNumber;
+        {
+            ScopedStageTimer timer(Stage::FFT);
+            if (haveRawFrame) {
+                frameNumber = m_rawFrame.frame_number;
+                bool ok = m_options.channels ? m_spectrum.processChannels(m_rawFrame)
+                                             : m_spectrum.process(m_rawFrame);
+                if (!ok) {
+                    ++m_undecoded;
+                    return;
+                }
+            } else {
+                frameNumber = m_textFrame.msgId;
+                m_spectrum.process(m_textFrame.sample_data);
+            }
+        }
+        ++m_adcFrames;
+        Instrumentation::instance().countFrame();
+        m_publisher.publishSpectrum(0, haveRawFrame ? m_rawFrame.timestamp_us : m_textFrame.timestamp_us,
+                                    frameNumber, m_spectrum.magnitude(), m_spectrum.twoSided());
+
+        {
+            ScopedStageTimer timer(Stage::Detect);
+            m_cfar.detect(m_spectrum.magnitude(), m_detections);
+        }
+        m_detectionCount += m_detections.size();
+
+        if (m_options.printDetections) {
+            const std::vector<float>& axis = m_spectrum.frequencyAxis();
+            for (const CfarDetector::Detection& detection : m_detections) {
+                std::printf("frame %u bin %.0f power %.1f dB snr %.1f dB\n", frameNumber,
+                            axis[detection.bin], detection.powerDb, detection.snrDb);
+            }
+        }
+    }
+
+    void printSummary(double seconds) const
+    {
+        std::printf("datagrams    %llu (%.2f MB) in %.3f s: %.0f datagrams/s, %.1f MB/s\n",
+                    static_cast<unsigned long long>(m_datagrams), m_bytes / 1e6, seconds,
+                    m_datagrams / seconds, m_bytes / 1e6 / seconds);
+        std::printf("adc frames   %llu (%.0f frames/s)\n",
+                    static_cast<unsigned long long>(m_adcFrames), m_adcFrames / seconds);
+        std::printf("track msgs   %llu, %llu tracks\n",
+                    static_cast<unsigned long long>(m_trackMessages),
+                    static_cast<unsigned long long>(m_trackCount));
+        std::printf("detections   %llu\n", static_cast<unsigned long long>(m_detectionCount));
+        std::printf("undecoded    %llu\n", static_cast<unsigned long long>(m_undecoded));
+        if (m_publisher.isOpen()) {
+            std::printf("published    %llu frames\n", static_cast<unsigned long long>(m_publisher.published()));
+        }
+
+        std::printf("\n%-12s %10s %10s %10s %10s %10s\n", "stage", "count", "mean us", "p50 us",
+                    "p99 us", "max us");
+        for (Stage stage : {Stage::Parse, Stage::FFT, Stage::Detect}) {
+            const LatencyHistogram& h = Instrumentation::instance().histogram(stage);
+            std::printf("%-12s %10llu %10.2f %10.2f %10.2f %10.2f\n", stageName(stage),
+                        static_cast<unsigned long long>(h.count()), h.mean() / 1e3,
+                        h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3, h.max() / 1e3);
+        }
+    }
+
+private:
+    const Options& m_options;
+    RawADCFrame m_rawFrame;
+    TargetTrackData m_tracks;
+    RawADCFrameTest m_textFrame;
+    SpectrumProcessor m_spectrum;
+    CfarDetector m_cfar;
+    std::vector<CfarDetector::Detection> m_detections;
+    TrackDecoder m_trackDecoder;
+    SharedFramePublisher m_publisher;
+
+    uint64_t m_datagrams = 0;
+    uint64_t m_bytes = 0;
+    uint64_t m_adcFrames = 0;
+    uint64_t m_trackMessages = 0;
+    uint64_t m_trackCount = 0;
+    uint64_t m_detectionCount = 0;
+    uint64_t m_undecoded = 0;
+};
+
+// Follows a shared-memory ring until the publisher closes it (or `count`
+// frames were read), printing once per second
+int subscribe(const Options& options)
+{
+    SharedFrameSubscriber subscriber;
+    if (!subscriber.open(options.subscribeName)) {
+        std::fprintf(stderr, "no shared memory ring named %s\n", options.subscribeName.c_str());
+        return 1;
+    }
+    subscriber.skipToLatest();
+
+    LatencyHistogram latency;  // publish -> read
+    uint64_t frames = 0;
+    uint64_t tracks = 0;
+    uint64_t spectra = 0;
+    uint64_t framesAtLastReport = 0;
+    auto lastReport = std::chrono::steady_clock::now();
+    auto report = [&](double seconds) {
+        std::printf("%8.1f frames/s  tracks %llu  spectra %llu  lost %llu  latency p50 %.1f us p99 %.1f us\n",
+                    (frames - framesAtLastReport) / seconds, static_cast<unsigned long long>(tracks),
+                    static_cast<unsigned long long>(spectra),
+                    static_cast<unsigned long long>(subscriber.lost()),
+                    latency.percentile(0.50) / 1e3, latency.percentile(0.99) / 1e3);
+        std::fflush(stdout);
+        framesAtLastReport = frames;
+    };
+
+    while (options.subscribeCount == 0 || frames < options.subscribeCount) {
+        uint64_t publishUs = 0;
+        shm::FrameKind kind = shm::FrameKind::Tracks;
+        uint32_t count = 0;
+        const SharedFrameSubscriber::Result result = subscriber.poll([&](const shm::SharedFrame& frame) {
+            publishUs = frame.header->publishUs;
+            kind = frame.kind();
+            count = frame.header->count;
+        });
+        if (result == SharedFrameSubscriber::Result::Frame) {
+            const uint64_t now = Instrumentation::wallClockUs();
+            latency.record(now > publishUs ? (now - publishUs) * 1000 : 0);
+            ++frames;
+            if (kind == shm::FrameKind::Tracks) {
+                tracks += count;
+            } else {
+                ++spectra;
+            }
+        } else if (result == SharedFrameSubscriber::Result::Empty) {
+            if (subscriber.publisherClosed()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - lastReport).count();
+        if (seconds >= 1.0) {
+            report(seconds);
+            lastReport = now;
+        }
+    }
+    report(std::max(1e-9, std::chrono::duration<double>(std::chrono::steady_clock::now() - lastReport).count()));
+    return 0;
+}
+
+// Decodes simulated datagrams of every protocol a SourceReceiver accepts,
+// into pooled frames and reused decoders as it does, then runs the decoded
+// ADC frames through SpectrumProcessor (single and per-channel spectra, with
+// and without MTI and clutter maps) and CFAR. Fails if any step after the
+// first pass allocates. Counts only this thread's allocations.
+int checkAllocations()
+{
+    if (!AllocationCounter::enabled()) {
+        std::fprintf(stderr, "built without RADAR_COUNT_ALLOCATIONS\n");
+        return 1;
+    }
+
+    const size_t distinct = 32;
+    Simulator simulator(1234);
+    std::vector<TargetTrackData> trackFrames(distinct);
+    std::vector<RawADCFrame> rawFrames(distinct);
+    RawADCFrameTest textFrame;
+    std::vector<char> datagram;
+    TrackEncoder encoder;
+    Recording binary;
+    Recording text;
+    Recording compact;
+    for (size_t i = 0; i < distinct; ++i) {
+        simulator.generateTargets(trackFrames[i]);
+        trackFrames[i].timestamp_us = 1000000 + i * 50000;
+        simulator.generateRawFrame(rawFrames[i], trackFrames[i]);
+        encodeBinaryADCMessage(rawFrames[i], datagram);
+        binary.append(datagram.data(), datagram.size());
+
+        const std::string tracks = formatTrackMessage(trackFrames[i]);
+        text.append(tracks.data(), tracks.size());
+        simulator.generateADC(textFrame);
+        const std::string adc = formatADCMessage(textFrame);
+        text.append(adc.data(), adc.size());
+    }
+    // Delta frames only decode in sequence, so the compact stream is encoded
+    // twice over instead of being replayed
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const TargetTrackData& tracks : trackFrames) {
+            encoder.encode(tracks, datagram);
+            compact.append(datagram.data(), datagram.size());
+        }
+    }
+
+    FramePool<TargetTrackData> trackPool;
+    FramePool<RawADCFrameTest> adcPool;
+    FramePool<RawADCFrame> rawPool;
+    TrackDecoder decoder;
+
+    bool ok = true;
+    // Runs `step` for i = 0 .. count - 1; the first `warmup` calls only grow
+    // pools and buffers
+    const auto check = [&ok](const char* name, const char* unit, size_t count, size_t warmup,
+                             const auto& step) {
+        uint64_t allocations = 0;
+        uint64_t failed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            AllocationCounter::ThreadScope scope;
+            if (!step(i)) {
+                ++failed;
+            }
+            if (i >= warmup) {
+                allocations += scope.allocations();
+            }
+        }
+        const size_t measured = count - warmup;
+        const bool passed = failed == 0 && allocations == 0;
+        char label[32];
+        std::snprintf(label, sizeof(label), "%4zu %ss", measured, unit);
+        std::printf("%-14s %-14s  %.2f allocations/%s  %s\n", name, label, double(allocations) / measured, unit,
+                    failed ? "FAILED (errors)" : passed ? "ok" : "FAILED");
+        ok = ok && passed;
+    };
+    // Decodes datagram i, cycling through `recording`
+    const auto datagrams = [](const Recording& recording, const auto& decode) {
+        return [&recording, decode](size_t i) {
+            const size_t index = i % recording.size();
+            return decode(recording.datagram(index), recording.datagramSize(index));
+        };
+    };
+
+    check("binary adc", "datagram", 2 * binary.size(), binary.size(),
+          datagrams(binary, [&](const char* data, size_t size) {
+              FramePool<RawADCFrame>::Ref frame = rawPool.acquire();
+              return parseBinaryADCMessage(data, size, *frame);
+          }));
+    check("text", "datagram", 2 * text.size(), text.size(), datagrams(text, [&](const char* data, size_t size) {
+              FramePool<TargetTrackData>::Ref tracks = trackPool.acquire();
+              FramePool<RawADCFrameTest>::Ref frame = adcPool.acquire();
+              const TextMessageResult result = parseTextMessage(data, size, *tracks, *frame);
+              return result.hasTracks || result.hasADC;
+          }));
+    check("compact tracks", "datagram", compact.size(), distinct,
+          datagrams(compact, [&](const char* data, size_t size) {
+              FramePool<TargetTrackData>::Ref tracks = trackPool.acquire();
+              return decoder.decode(data, size, *tracks) == TrackDecoder::Result::Decoded;
+          }));
+
+    // The clutter maps and MTI rows size themselves on the first frame, so
+    // one pass over the frames is enough warm-up
+    CfarDetector cfar;
+    std::vector<CfarDetector::Detection> detections;
+    const auto spectra = [&](SpectrumProcessor& processor) {
+        return [&](size_t i) {
+            const RawADCFrame& frame = rawFrames[i % rawFrames.size()];
+            if (!processor.process(frame) || !processor.processChannels(frame)) {
+                return false;
+            }
+            cfar.detect(processor.magnitude(), detections);
+            return true;
+        };
+    };
+    SpectrumProcessor plain;
+    check("spectrum", "frame", 2 * distinct, distinct, spectra(plain));
+    SpectrumProcessor filtered;
+    filtered.setMtiMode(SpectrumProcessor::MtiMode::ThreePulse);
+    filtered.setClutterMapEnabled(true);
+    check("spectrum mti", "frame", 2 * distinct, distinct, spectra(filtered));
+    return ok ? 0 : 1;
+}
+
+// Encodes simulated track frames (one target replaced by a new id every
+// frame, on top of the simulator's varying count) and delivers the
+// datagrams over a channel that loses, swaps, duplicates and delays some of
+// them: a fixed schedule covering each case once, then random ones. A
+// reference model of the protocol says what every delivered datagram must
+// decode to: a keyframe, or the successor of the last decoded frame,
+// decodes; a delta not newer than the last decoded frame is stale and
+// leaves the decoder as it was; any other delta is refused, and so is every
+// delta up to the next keyframe. Decoded frames must match the originals up
+// to half a quantisation step.
+int checkTrackCodec()
+{
+    const uint32_t keyframeInterval = 8;
+    const size_t frames = 4000;
+    Simulator simulator(4321);
+    TrackEncoder encoder(keyframeInterval);
+    std::vector<TargetTrackData> originals(frames);
+    Recording stream;
+    std::vector<char> datagram;
+    for (size_t i = 0; i < frames; ++i) {
+        TargetTrackData& tracks = originals[i];
+        simulator.generateTargets(tracks);
+        if (tracks.numTracks > 0) {
+            tracks.targets[i % tracks.numTracks].target_id = static_cast<uint32_t>(100000 + i);
+        }
+        tracks.timestamp_us = 1000000 + i * 50000;
+        encoder.encode(tracks, datagram);
+        stream.append(datagram.data(), datagram.size());
+    }
+
+    // Delivery order: lose 10, swap 20/21, lose keyframe 32, duplicate 42,
+    // repeat 43 late after 45, then random
+    std::vector<size_t> delivered;
+    std::mt19937 random(99);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    for (size_t i = 0; i < frames; ++i) {
+        if (i == 10 || i == 32) {
+            continue;
+        }
+        if (i == 20 || (i >= 64 && i + 1 < frames && chance(random) < 0.03f)) {
+            delivered.push_back(i + 1);
+            delivered.push_back(i);
+            ++i;
+            continue;
+        }
+        if (i >= 64 && chance(random) < 0.05f) {
+            continue;
+        }
+        delivered.push_back(i);
+        if (i == 42 || (i >= 64 && chance(random) < 0.02f)) {
+            delivered.push_back(i);
+        }
+        if (i == 45 || (i >= 64 && chance(random) < 0.02f)) {
+            delivered.push_back(i - 2);
+        }
+    }
+
+    TrackDecoder decoder;
+    TargetTrackData decoded;
+    bool synced = false;
+    size_t last = 0;
+    uint64_t decodedFrames = 0;
+    uint64_t refused = 0;
+    uint64_t stale = 0;
+    uint64_t wrongResult = 0;
+    uint64_t mismatches = 0;
+    float maxError = 0.0f;
+    const auto resultName = [](TrackDecoder::Result result) {
+        switch (result) {
+        case TrackDecoder::Result::Decoded: return "decoded";
+        case TrackDecoder::Result::NeedKeyframe: return "refused";
+        case TrackDecoder::Result::Stale: return "stale";
+        default: return "malformed";
+        }
+    };
+    for (size_t index : delivered) {
+        const char* data = stream.datagram(index);
+        const bool keyframe = (data[sizeof(MessageHeader) + 1] & trackcodec::FLAG_KEYFRAME) != 0;
+        TrackDecoder::Result expected = TrackDecoder::Result::NeedKeyframe;
+        if (keyframe || (synced && index == last + 1)) {
+            expected = TrackDecoder::Result::Decoded;
+            synced = true;
+            last = index;
+        } else if (synced && index <= last) {
+            expected = TrackDecoder::Result::Stale;
+        } else {
+            synced = false;
+        }
+        const TrackDecoder::Result result = decoder.decode(data, stream.datagramSize(index), decoded);
+        if (result != expected) {
+            ++wrongResult;
+            std::printf("frame %zu: %s, expected %s\n", index, resultName(result), resultName(expected));
+        }
+        if (result == TrackDecoder::Result::Decoded) {
+            ++decodedFrames;
+            if (!matchesQuantized(originals[index], decoded)) {
+                ++mismatches;
+                std::printf("frame %zu: decoded tracks differ from the original\n", index);
+            } else {
+                maxError = std::max(maxError, maxFieldError(originals[index], decoded));
+            }
+        } else if (result == TrackDecoder::Result::Stale) {
+            ++stale;
+        } else {
+            ++refused;
+        }
+    }
+
+    const bool ok = wrongResult == 0 && mismatches == 0 && refused > 0 && stale > 0;
+    std::printf("track codec: %zu frames, %zu delivered, %llu decoded, %llu refused after gaps, "
+                "%llu stale, max error %.4f (step %.3f): %s\n",
+                frames, delivered.size(), static_cast<unsigned long long>(decodedFrames),
+                static_cast<unsigned long long>(refused), static_cast<unsigned long long>(stale), maxError,
+                trackcodec::STEPS[0], ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (options.checkAllocations) {
+        return checkAllocations();
+    }
+    if (options.checkTrackCodec) {
+        return checkTrackCodec();
+    }
+    if (!options.subscribeName.empty()) {
+        return subscribe(options);
+    }
+
+    Recording recording;
+    uint64_t datagramsPerPass;
+    if (options.simulateFrames > 0) {
+        if (!simulateRecording(options.simulateFrames, options.compactTracks, recording)) {
+            std::fprintf(stderr, "compact track round trip failed\n");
+            return 1;
+        }
+        datagramsPerPass = 2 * options.simulateFrames;
+        if (!options.recordPath.empty() &&
+            !writeRecording(options.recordPath, recording, datagramsPerPass)) {
+            std::fprintf(stderr, "cannot write %s\n", options.recordPath.c_str());
+            return 1;
+        }
+    } else if (!loadRecording(options.input, options.format, recording)) {
+        std::fprintf(stderr, "cannot read %s\n", options.input.c_str());
+        return 1;
+    } else {
+        datagramsPerPass = recording.size();
+    }
+    if (recording.size() == 0) {
+        std::fprintf(stderr, "no datagrams to process\n");
+        return 1;
+    }
+
+    Instrumentation::setEnabled(true);
+    Pipeline pipeline(options);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned pass = 0; pass < options.repeat; ++pass) {
+        for (uint64_t i = 0; i < datagramsPerPass; ++i) {
+            const size_t index = i % recording.size();
+            pipeline.process(recording.datagram(index), recording.datagramSize(index));
+        }
+    }
+    const double seconds = std::max(1e-9, std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count());
+
+    pipeline.printSummary(seconds);
+
+    if (!options.statsPath.empty() && !Instrumentation::instance().writeCsv(options.statsPath)) {
+        std::fprintf(stderr, "cannot write %s\n", options.statsPath.c_str());
+        return 1;
+    }
+    return 0;
+}